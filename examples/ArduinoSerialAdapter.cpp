@@ -4,7 +4,7 @@
  * @brief Construct an ArduinoSerialAdapter using the default Serial.
  */
 ArduinoSerialAdapter::ArduinoSerialAdapter()
-    : _serial(&Serial) {
+    : _serial(&Serial), _tx(&Serial) {
 }
 
 /**
@@ -12,7 +12,7 @@ ArduinoSerialAdapter::ArduinoSerialAdapter()
  * @param serial Pointer to the HardwareSerial instance to use.
  */
 ArduinoSerialAdapter::ArduinoSerialAdapter(HardwareSerial* serial)
-    : _serial(serial) {
+    : _serial(serial), _tx(serial) {
 }
 
 /**
@@ -21,71 +21,269 @@ ArduinoSerialAdapter::ArduinoSerialAdapter(HardwareSerial* serial)
  * @return true (Arduino Serial.begin() doesn't return a status).
  */
 bool ArduinoSerialAdapter::begin(unsigned long baudRate) {
+    _tx.clear();
     _serial->begin(baudRate);
     return true;
 }
 
-/* Print methods (no newline) */
+/* Print methods (no newline): formatted into the ring, then drained as far as the UART has room */
 
 void ArduinoSerialAdapter::print(const __FlashStringHelper* str) {
-    _serial->print(str);
+    (void)_tx.print(str);
+    _tx.drain();
 }
 
 void ArduinoSerialAdapter::print(const char* str) {
-    _serial->print(str);
+    (void)_tx.print(str);
+    _tx.drain();
 }
 
 void ArduinoSerialAdapter::print(char c) {
-    _serial->print(c);
+    (void)_tx.print(c);
+    _tx.drain();
 }
 
 void ArduinoSerialAdapter::print(uint8_t value, int base) {
-    _serial->print(value, base);
+    (void)_tx.print(value, base);
+    _tx.drain();
 }
 
 void ArduinoSerialAdapter::print(uint16_t value, int base) {
-    _serial->print(value, base);
+    (void)_tx.print(value, base);
+    _tx.drain();
 }
 
 void ArduinoSerialAdapter::print(uint32_t value, int base) {
-    _serial->print(value, base);
+    (void)_tx.print(value, base);
+    _tx.drain();
 }
 
 void ArduinoSerialAdapter::print(int value, int base) {
-    _serial->print(value, base);
+    (void)_tx.print(value, base);
+    _tx.drain();
 }
 
 /* Println methods (with newline) */
 
 void ArduinoSerialAdapter::println() {
-    _serial->println();
+    (void)_tx.println();
+    _tx.drain();
 }
 
 void ArduinoSerialAdapter::println(const __FlashStringHelper* str) {
-    _serial->println(str);
+    (void)_tx.println(str);
+    _tx.drain();
 }
 
 void ArduinoSerialAdapter::println(const char* str) {
-    _serial->println(str);
+    (void)_tx.println(str);
+    _tx.drain();
 }
 
 void ArduinoSerialAdapter::println(char c) {
-    _serial->println(c);
+    (void)_tx.println(c);
+    _tx.drain();
 }
 
 void ArduinoSerialAdapter::println(uint8_t value, int base) {
-    _serial->println(value, base);
+    (void)_tx.println(value, base);
+    _tx.drain();
 }
 
 void ArduinoSerialAdapter::println(uint16_t value, int base) {
-    _serial->println(value, base);
+    (void)_tx.println(value, base);
+    _tx.drain();
 }
 
 void ArduinoSerialAdapter::println(uint32_t value, int base) {
-    _serial->println(value, base);
+    (void)_tx.println(value, base);
+    _tx.drain();
 }
 
 void ArduinoSerialAdapter::println(int value, int base) {
-    _serial->println(value, base);
+    (void)_tx.println(value, base);
+    _tx.drain();
 }
 
+
+/* Block output and buffering */
+
+/**
+ * @brief Write a block of raw bytes through the transmit ring.
+ * @param buffer Bytes to write.
+ * @param length Number of bytes.
+ * @return Number of bytes written.
+ */
+size_t ArduinoSerialAdapter::write(const uint8_t* buffer, size_t length) {
+    size_t ret = _tx.write(buffer, length);
+    _tx.drain();
+    return ret;
+}
+
+/**
+ * @brief Hand buffered bytes to the UART as far as it has room, without waiting.
+ */
+void ArduinoSerialAdapter::poll() {
+    _tx.drain();
+}
+
+/**
+ * @brief Send all buffered output, waiting for the UART.
+ */
+void ArduinoSerialAdapter::flush() {
+    _tx.drainAll();
+    _serial->flush();
+}
+
+/**
+ * @brief Number of bytes waiting in the transmit ring.
+ * @return Buffered byte count.
+ */
+size_t ArduinoSerialAdapter::pending() const {
+    return _tx.count();
+}
+
+/* Transmit ring */
+
+ArduinoSerialAdapter::TxBuffer::TxBuffer(HardwareSerial* serial)
+    : _serial(serial)
+#if ARDUINOSERIALADAPTER_TX_BUFFER_SIZE > 0
+    , _tail(0U), _count(0U), _roomReported(false)
+#endif
+{
+}
+
+/**
+ * @brief Append one byte to the ring.
+ * @param c Byte to append.
+ * @return 1.
+ */
+size_t ArduinoSerialAdapter::TxBuffer::write(uint8_t c) {
+    return write(&c, 1U);
+}
+
+/**
+ * @brief Append bytes to the ring.
+ *
+ * When the ring is full, the oldest bytes are sent to the UART first, waiting
+ * for it if needed, so that nothing is lost and the output order is kept.
+ *
+ * @param buffer Bytes to append.
+ * @param size Number of bytes.
+ * @return Number of bytes appended.
+ */
+size_t ArduinoSerialAdapter::TxBuffer::write(const uint8_t* buffer, size_t size) {
+#if ARDUINOSERIALADAPTER_TX_BUFFER_SIZE > 0
+    for (size_t i = 0U; i < size; i++) {
+        if (_count == ARDUINOSERIALADAPTER_TX_BUFFER_SIZE) {
+            drain();
+            if (_count == ARDUINOSERIALADAPTER_TX_BUFFER_SIZE) {
+                sendOldest();
+            }
+        }
+
+        uint16_t head = _tail + _count;
+        if (head >= ARDUINOSERIALADAPTER_TX_BUFFER_SIZE) {
+            head -= ARDUINOSERIALADAPTER_TX_BUFFER_SIZE;
+        }
+        _ring[head] = buffer[i];
+        _count++;
+    }
+
+    return size;
+#else
+    return _serial->write(buffer, size);
+#endif
+}
+
+/**
+ * @brief Drop all buffered bytes.
+ */
+void ArduinoSerialAdapter::TxBuffer::clear() {
+#if ARDUINOSERIALADAPTER_TX_BUFFER_SIZE > 0
+    _tail = 0U;
+    _count = 0U;
+#endif
+}
+
+/**
+ * @brief Hand buffered bytes to the UART as far as its own buffer has room.
+ *
+ * Does not wait: at most availableForWrite() bytes are written, in at most two
+ * contiguous blocks. A core whose serial class keeps the Print default of
+ * availableForWrite(), which always returns 0, would never be drained that
+ * way: as long as availableForWrite() has not reported room once, a 0 with
+ * bytes buffered falls back to a direct, blocking write of the ring.
+ */
+void ArduinoSerialAdapter::TxBuffer::drain() {
+#if ARDUINOSERIALADAPTER_TX_BUFFER_SIZE > 0
+    int room = _serial->availableForWrite();
+
+    if (room > 0) {
+        _roomReported = true;
+    }
+    else if ((_count > 0U) && (_roomReported == false)) {
+        drainAll();
+    }
+    else {
+        /* UART buffer full for now: its interrupt makes room */
+    }
+
+    while ((room > 0) && (_count > 0U)) {
+        size_t chunk = ARDUINOSERIALADAPTER_TX_BUFFER_SIZE - _tail;
+        if (chunk > _count) {
+            chunk = _count;
+        }
+        if (chunk > static_cast<size_t>(room)) {
+            chunk = static_cast<size_t>(room);
+        }
+
+        (void)_serial->write(&_ring[_tail], chunk);
+
+        _tail += static_cast<uint16_t>(chunk);
+        if (_tail >= ARDUINOSERIALADAPTER_TX_BUFFER_SIZE) {
+            _tail = 0U;
+        }
+        _count -= static_cast<uint16_t>(chunk);
+        room -= static_cast<int>(chunk);
+    }
+#endif
+}
+
+/**
+ * @brief Send all buffered bytes, waiting for the UART.
+ */
+void ArduinoSerialAdapter::TxBuffer::drainAll() {
+#if ARDUINOSERIALADAPTER_TX_BUFFER_SIZE > 0
+    while (_count > 0U) {
+        sendOldest();
+    }
+#endif
+}
+
+/**
+ * @brief Number of buffered bytes.
+ * @return Byte count.
+ */
+size_t ArduinoSerialAdapter::TxBuffer::count() const {
+#if ARDUINOSERIALADAPTER_TX_BUFFER_SIZE > 0
+    return _count;
+#else
+    return 0U;
+#endif
+}
+
+#if ARDUINOSERIALADAPTER_TX_BUFFER_SIZE > 0
+/**
+ * @brief Send the oldest buffered byte, waiting for the UART if its buffer is full.
+ */
+void ArduinoSerialAdapter::TxBuffer::sendOldest() {
+    (void)_serial->write(_ring[_tail]);
+
+    _tail++;
+    if (_tail >= ARDUINOSERIALADAPTER_TX_BUFFER_SIZE) {
+        _tail = 0U;
+    }
+    _count--;
+}
+#endif
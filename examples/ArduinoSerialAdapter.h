@@ -4,6 +4,14 @@
 #include <Arduino.h>
 #include "SerialDriver.h"
 
+/**
+ * Size of the transmit ring in bytes. 0 disables buffering: every call then
+ * goes straight to the HardwareSerial.
+ */
+#ifndef ARDUINOSERIALADAPTER_TX_BUFFER_SIZE
+#define ARDUINOSERIALADAPTER_TX_BUFFER_SIZE (128U)
+#endif
+
 /**
  * @class ArduinoSerialAdapter
  * @brief Concrete implementation of SerialDriver wrapping Arduino's HardwareSerial.
@@ -13,6 +21,14 @@
  * it wraps the primary Serial object, but can be configured to use any
  * HardwareSerial instance (Serial1, Serial2, etc.).
  *
+ * Output is formatted into a transmit ring and handed to the HardwareSerial
+ * only as far as its own buffer has room, so printing does not wait for the
+ * UART. poll() moves the rest along and should be called from idle points;
+ * the UART interrupt then sends it in the background. Only when the ring is
+ * full does a call wait for the UART, to free room for the new bytes. On cores
+ * whose availableForWrite() always reports 0, output is written directly and
+ * blocks as before. Call flush() before halting so buffered output is not lost.
+ *
  * @example
  * @code
  * ArduinoSerialAdapter serialAdapter;           // Uses Serial
@@ -69,10 +85,56 @@ public:
     void println(uint32_t value, int base = DEC) override;
     void println(int value, int base = DEC) override;
 
+    size_t write(const uint8_t* buffer, size_t length) override;
+    void poll() override;
+
     ///@}
 
+    /**
+     * @brief Send all buffered output, waiting for the UART.
+     */
+    void flush();
+
+    /**
+     * @brief Number of bytes waiting in the transmit ring.
+     * @return Buffered byte count.
+     */
+    size_t pending() const;
+
 private:
+    /**
+     * @brief Transmit ring in front of the HardwareSerial.
+     *
+     * Derives from Print so that numbers are formatted by the Arduino core
+     * straight into the ring.
+     */
+    class TxBuffer : public Print {
+    public:
+        explicit TxBuffer(HardwareSerial* serial);
+
+        using Print::write;
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t* buffer, size_t size) override;
+
+        void clear();
+        void drain();
+        void drainAll();
+        size_t count() const;
+
+    private:
+        HardwareSerial* _serial; ///< UART the ring drains into.
+#if ARDUINOSERIALADAPTER_TX_BUFFER_SIZE > 0
+        uint8_t _ring[ARDUINOSERIALADAPTER_TX_BUFFER_SIZE]; ///< Buffered bytes.
+        uint16_t _tail;  ///< Index of the oldest buffered byte.
+        uint16_t _count; ///< Number of buffered bytes.
+        bool _roomReported; ///< availableForWrite() has reported room at least once.
+
+        void sendOldest();
+#endif
+    };
+
     HardwareSerial* _serial; ///< Pointer to the underlying HardwareSerial instance.
+    TxBuffer _tx;            ///< Transmit ring in front of _serial.
 };
 
 #endif // ARDUINOSERIALADAPTER_H
@@ -2,7 +2,6 @@
 #include <SHA512.h>
 #include <AES.h>
 #include "CryptnoxWallet.h"
-#include "AESLib.h"
 
 #define RESPONSE_GETCARDCERTIFICATE_IN_BYTES    148U
 #define RESPONSE_SELECT_IN_BYTES                 26U
@@ -18,13 +17,219 @@
 #define COMMON_PAIRING_DATA                        "Cryptnox Basic CommonPairingData"
 #define CLIENT_PRIVATE_KEY_SIZE                  32U
 #define CLIENT_PUBLIC_KEY_SIZE                   64U
+#define REQUEST_OPENSECURECHANNEL_IN_BYTES         (6U + CLIENT_PUBLIC_KEY_SIZE)
 #define CARDEPHEMERALPUBKEY_SIZE                 64U
 #define AES_BLOCK_SIZE                           16U
 #define AES_TEST_DATA_SIZE                       32U
-#define INPUT_BUFFER_LIMIT                         (128U + 1U)
-#define MAX_MAC_DATA_LEN                           (AES_BLOCK_SIZE + 2U * INPUT_BUFFER_LIMIT)
+#define SECURE_HEADER_IN_BYTES                    5U   /* CLA INS P1 P2 Lc */
+#define SECURE_CIPHERTEXT_OFFSET                   (SECURE_HEADER_IN_BYTES + AES_BLOCK_SIZE)
+#define SECURE_MAX_CIPHERTEXT_IN_BYTES             (CW_SECURE_MAX_DATA_SIZE + 1U)  /* at least one padding byte */
+
+/* SELECT command activating the Cryptnox application */
+static const uint8_t cw_selectCommand[] = {
+    0x00, /* CLA  : ISO interindustry */
+    0xA4, /* INS  : SELECT */
+    0x04, /* P1   : Select by name */
+    0x00, /* P2   : First or only occurrence */
+    0x07, /* Lc   : Length of AID */
+    0xA0, 0x00, 0x00, 0x10, 0x00, 0x01, 0x12  /* AID */
+};
+
+/* GET CARD CERTIFICATE header, followed by an 8-byte random nonce */
+static const uint8_t cw_getCardCertificateHeader[] = {
+    0x80,  /* CLA */
+    0xF8,  /* INS : GET CARD CERTIFICATE */
+    0x00,  /* P1 */
+    0x00,  /* P2 */
+    0x08,  /* Lc : 8 bytes nonce */
+};
+
+/* PIN code 1234 */
+static const uint8_t cw_defaultPin[] = { 0x31, 0x32, 0x33, 0x34 };
 
-AESLib aesLib;
+/**
+ * @brief AES-CBC decrypts a buffer in place and strips ISO/IEC 9797-1 Method 2 padding.
+ *
+ * @param[in]     cipher     Pre-expanded AES key schedule (see CW_SecureSession::setKeys()).
+ * @param[in,out] buffer     Ciphertext on input, plaintext on output.
+ * @param[in]     length     Ciphertext length in bytes (multiple of AES_BLOCK_SIZE).
+ * @param[in,out] iv         CBC IV, updated to the last ciphertext block.
+ * @return Plaintext length in bytes without padding.
+ */
+static uint16_t cw_decryptPadded(AES& cipher, uint8_t* buffer, uint16_t length, uint8_t* iv) {
+    uint16_t plainLength = length;
+
+    (void)cipher.cbc_decrypt(buffer, buffer, length / AES_BLOCK_SIZE, iv);
+
+    while ((plainLength > 0U) && (buffer[plainLength - 1U] == 0x00U)) {
+        plainLength--;
+    }
+    if ((plainLength > 0U) && (buffer[plainLength - 1U] == 0x80U)) {
+        plainLength--;
+    }
+
+    return plainLength;
+}
+
+/* Incremental AES CBC-MAC (zero IV, zero padding): only the chaining block is kept */
+struct CW_CbcMacContext {
+    AES* cipher;                    /* Pre-expanded Kmac schedule */
+    uint8_t state[AES_BLOCK_SIZE];  /* Chaining value with the pending partial block XORed in */
+    uint8_t fill;                   /* Bytes absorbed into the pending block */
+};
+
+/**
+ * @brief Starts an AES CBC-MAC computation.
+ *
+ * @param[out] ctx    MAC context.
+ * @param[in]  cipher Pre-expanded AES key schedule (see CW_SecureSession::setKeys()).
+ */
+static void cw_cbcMacInit(CW_CbcMacContext& ctx, AES& cipher) {
+    ctx.cipher = &cipher;
+    memset(ctx.state, 0U, sizeof(ctx.state));
+    ctx.fill = 0U;
+}
+
+/**
+ * @brief Absorbs data into an AES CBC-MAC, straight from the caller's buffer.
+ *
+ * @param[in,out] ctx    MAC context.
+ * @param[in]     data   Data to authenticate.
+ * @param[in]     length Data length in bytes.
+ */
+static void cw_cbcMacUpdate(CW_CbcMacContext& ctx, const uint8_t* data, uint16_t length) {
+    for (uint16_t i = 0U; i < length; i++) {
+        ctx.state[ctx.fill] ^= data[i];
+        ctx.fill++;
+        if (ctx.fill == AES_BLOCK_SIZE) {
+            (void)ctx.cipher->encrypt(ctx.state, ctx.state);
+            ctx.fill = 0U;
+        }
+    }
+}
+
+/**
+ * @brief Zero pads the pending block of an AES CBC-MAC up to the block boundary.
+ *
+ * XORing zeros leaves the state unchanged, so only the block encryption is left.
+ * Nothing happens when the absorbed data is already block aligned.
+ *
+ * @param[in,out] ctx MAC context.
+ */
+static void cw_cbcMacPad(CW_CbcMacContext& ctx) {
+    if (ctx.fill > 0U) {
+        (void)ctx.cipher->encrypt(ctx.state, ctx.state);
+        ctx.fill = 0U;
+    }
+}
+
+/**
+ * @brief Completes an AES CBC-MAC and wipes the context.
+ *
+ * @param[in,out] ctx MAC context.
+ * @param[out]    mac 16-byte MAC (last CBC block).
+ */
+static void cw_cbcMacFinal(CW_CbcMacContext& ctx, uint8_t* mac) {
+    cw_cbcMacPad(ctx);
+    memcpy(mac, ctx.state, AES_BLOCK_SIZE);
+    memset(ctx.state, 0U, sizeof(ctx.state));
+}
+
+/**
+ * @brief AES-CBC encrypts with ISO/IEC 9797-1 Method 2 padding and CBC-MACs the ciphertext in one pass.
+ *
+ * Each ciphertext block is fed to @p mac as soon as it is produced and written
+ * once to @p out, so the ciphertext is never read back and no intermediate
+ * buffer is needed. The key schedules are taken as-is, so no key expansion
+ * happens here.
+ *
+ * @param[in]     cipher     Pre-expanded Kenc schedule (see CW_SecureSession::setKeys()).
+ * @param[in,out] iv         CBC IV, updated to the last ciphertext block.
+ * @param[in,out] mac        MAC context, block aligned (see cw_cbcMacPad()).
+ * @param[in]     data       Plaintext (may be NULL if dataLength is 0).
+ * @param[in]     dataLength Plaintext length in bytes.
+ * @param[out]    out        Ciphertext, dataLength rounded up to the next full block
+ *                           (always at least one padding byte). May be @p data.
+ * @return Ciphertext length in bytes.
+ */
+static uint16_t cw_encryptThenMac(AES& cipher, uint8_t* iv, CW_CbcMacContext& mac,
+                                  const uint8_t* data, uint16_t dataLength, uint8_t* out) {
+    uint16_t offset = 0U;
+    bool lastBlock = false;
+
+    while (lastBlock == false) {
+        uint16_t remaining = (uint16_t)(dataLength - offset);
+
+        if (remaining >= AES_BLOCK_SIZE) {
+            for (uint8_t i = 0U; i < AES_BLOCK_SIZE; i++) {
+                iv[i] ^= data[offset + i];
+            }
+        }
+        else {
+            /* Last block: remaining plaintext, 0x80, zeros (XORing zeros is a no-op) */
+            for (uint8_t i = 0U; i < remaining; i++) {
+                iv[i] ^= data[offset + i];
+            }
+            iv[remaining] ^= 0x80U;
+            lastBlock = true;
+        }
+
+        (void)cipher.encrypt(iv, iv);
+        memcpy(out + offset, iv, AES_BLOCK_SIZE);
+        cw_cbcMacUpdate(mac, iv, AES_BLOCK_SIZE);
+        offset += AES_BLOCK_SIZE;
+    }
+
+    return offset;
+}
+
+/**
+ * @brief Builds the OPEN SECURE CHANNEL command APDU.
+ *
+ * @param[out] apdu      REQUEST_OPENSECURECHANNEL_IN_BYTES buffer receiving the APDU.
+ * @param[in]  publicKey 64-byte client ephemeral public key (X || Y).
+ */
+static void cw_buildOpenSecureChannelApdu(uint8_t* apdu, const uint8_t* publicKey) {
+    /* APDU header for OPEN SECURE CHANNEL */
+    const uint8_t opcApduHeader[] = {
+        0x80,  /* CLA */
+        0x10,  /* INS : OPEN SECURE CHANNEL */
+        0x00,  /* P1 : pairing slot index */
+        0x00,  /* P2 */
+        0x41,  /* Lc : 1 format byte + 64 public key bytes */
+        0x04   /* ECC uncompressed public key format */
+    };
+
+    memcpy(apdu, opcApduHeader, sizeof(opcApduHeader));
+    memcpy(apdu + sizeof(opcApduHeader), publicKey, CLIENT_PUBLIC_KEY_SIZE);
+}
+
+/**
+ * @brief Derives Kenc/Kmac from the ECDH shared secret and installs them in the session.
+ *
+ * SHA-512(sharedSecret || COMMON_PAIRING_DATA || salt) is split into Kenc
+ * (first 32 bytes) and Kmac (last 32 bytes). Callers run the ECDH first, so
+ * the SHA-512 context and the ECDH are never on the stack together.
+ *
+ * @param[in,out] session      Session receiving the keys.
+ * @param[in]     sharedSecret 32-byte ECDH shared secret.
+ * @param[in]     salt         32-byte salt returned by OPEN SECURE CHANNEL.
+ */
+static void cw_deriveSessionKeys(CW_SecureSession& session, const uint8_t* sharedSecret, const uint8_t* salt) {
+    SHA512 kdf;
+    uint8_t sha512Output[64U] = { 0U };
+
+    kdf.update(sharedSecret, CW_SHAREDSECRET_SIZE);
+    kdf.update(COMMON_PAIRING_DATA, sizeof(COMMON_PAIRING_DATA) - 1U); /* exclude null terminator */
+    kdf.update(salt, OPENSECURECHANNEL_SALT_IN_BYTES);
+    kdf.finalize(sha512Output, sizeof(sha512Output));
+    kdf.clear();
+
+    /* Expanded once for the whole session */
+    session.setKeys(sha512Output, sha512Output + CW_AESKEY_SIZE);
+
+    memset(sha512Output, 0U, sizeof(sha512Output));
+}
 
 /**
  * @brief Processes a detected NFC card.
@@ -40,31 +245,35 @@ AESLib aesLib;
 bool CryptnoxWallet::processCard() {
     bool ret = false;
 
-    /* Check for ISO-DEP capable target (APDU-capable card) */
-    if (driver.inListPassiveTarget()) {
+    /* Check for ISO-DEP capable target (APDU-capable card), reusing the held one if any */
+    if (reselectHeldTarget() || (driver.finishResetReader() && driver.inListPassiveTarget())) {
         /* Try selecting Cryptnox app */
         if (selectApdu()) {
-            /* Local response buffer */
-            uint8_t cardCertificate[GETCARDCERTIFICATE_IN_BYTES];
+            /* The certificate is only needed until the card key is extracted */
+            uint8_t* cardCertificate = scratch.work;
             uint8_t cardCertificateLength = 0U;
             uint8_t openSecureChannelSalt[OPENSECURECHANNEL_SALT_IN_BYTES];
-            uint8_t clientPrivateKey[32];
-            uint8_t clientPublicKey[64];
+            uint8_t sharedSecret[CW_SHAREDSECRET_SIZE] = { 0U };
             uint8_t cardEphemeralPubKey[CARDEPHEMERALPUBKEY_SIZE];
             const uECC_Curve_t * sessionCurve = uECC_secp256r1();
+            bool channelOpen = false;
 
-            /* Create secure session context (stack-local for reentrancy) */
-            CW_SecureSession session;
-
-            /* Get certificate and establish secure channel */
+            /* Get certificate and open the secure channel; the session only
+               exists once the ECDH is over (see authenticateAndVerifyPin()) */
             getCardCertificate(cardCertificate, cardCertificateLength);
             extractCardEphemeralKey(cardCertificate, cardEphemeralPubKey);
-            openSecureChannel(openSecureChannelSalt, clientPublicKey, clientPrivateKey, sessionCurve);
-            mutuallyAuthenticate(session, openSecureChannelSalt, clientPublicKey, clientPrivateKey, sessionCurve, cardEphemeralPubKey);
-            verifyPin(session);
-            
-            /* Securely clear session keys before leaving scope */
-            session.clear();
+            if (pipelinedHandshake) {
+                channelOpen = openSecureChannelPipelined(sharedSecret, openSecureChannelSalt, cardEphemeralPubKey, sessionCurve);
+            } else {
+                channelOpen = openSecureChannelSequential(sharedSecret, openSecureChannelSalt, cardEphemeralPubKey, sessionCurve);
+            }
+            if (channelOpen) {
+                authenticateAndVerifyPin(sharedSecret, openSecureChannelSalt);
+            }
+
+            /* Securely clear the shared secret and the buffers before leaving scope */
+            memset(sharedSecret, 0U, sizeof(sharedSecret));
+            scratch.clear();
 
             /* Wait to see result */
             delay(5000U);
@@ -87,12 +296,277 @@ bool CryptnoxWallet::processCard() {
         }
     }
 
-    /* Reset reader in for the card to be detected by inListPassiveTarget again */
-    driver.resetReader();
+    /* Hold the card for the next operation, or reset reader for the card
+       to be detected by inListPassiveTarget again */
+    targetHeld = ret && keepTarget && driver.holdTarget();
+    if (targetHeld == false) {
+        driver.resetReader();
+    }
     
     return ret;
 }
 
+/**
+ * @brief Starts a non-blocking tap.
+ *
+ * The card dialogue is the one of processCard() with the pipelined handshake,
+ * split into steps advanced by poll().
+ *
+ * @param[out] tap Tap context, reset and set BUSY.
+ */
+// cppcheck-suppress unusedFunction
+void CryptnoxWallet::beginTap(CW_TapContext& tap) {
+    tap.clear();
+    tap.status = CW_TapStatus::BUSY;
+}
+
+/**
+ * @brief Advances a tap by one bounded slice of work.
+ *
+ * A slice is one of: sending the command of the current step, running the ECDH
+ * of OPEN SECURE CHANNEL while the card computes its answer, checking whether
+ * the reader has an answer, or reading and checking that answer. The card
+ * itself is never waited for. Only the first OPEN SECURE CHANNEL slice can be
+ * long, when the keypair pool is empty and a keypair has to be generated.
+ *
+ * @param[in,out] tap Tap context started with beginTap().
+ * @return Tap status after this slice.
+ */
+// cppcheck-suppress unusedFunction
+CW_TapStatus CryptnoxWallet::poll(CW_TapContext& tap) {
+    /* Let buffered debug output drain between slices */
+    serial.poll();
+
+    if (tap.status == CW_TapStatus::BUSY) {
+        if (tap.awaitingResponse == false) {
+            if (startTapStep(tap) == false) {
+                endTap(tap, CW_TapStatus::FAILED);
+            }
+        }
+        else if ((tap.step == CW_TapStep::OPEN_SECURE_CHANNEL) && (tap.sharedSecretReady == false)) {
+            /* ECDH runs while the card computes its answer */
+            tap.sharedSecretReady = (uECC_shared_secret(tap.cardEphemeralPubKey, tap.clientPrivateKey, tap.sharedSecret, uECC_secp256r1()) != 0);
+            memset(tap.clientPrivateKey, 0U, sizeof(tap.clientPrivateKey));
+
+            if (tap.sharedSecretReady == false) {
+                serial.println(F("ECDH shared secret generation failed!"));
+                endTap(tap, CW_TapStatus::FAILED);
+            }
+        }
+        else if (driver.isResponseReady()) {
+            tap.awaitingResponse = false;
+
+            if (finishTapStep(tap) == false) {
+                endTap(tap, CW_TapStatus::FAILED);
+            }
+        }
+        else if ((tap.step != CW_TapStep::DETECT) && ((millis() - tap.startedAt) > CW_TAP_RESPONSE_TIMEOUT_MS)) {
+            serial.println(F("Card response timeout."));
+            endTap(tap, CW_TapStatus::FAILED);
+        }
+        else {
+            /* Card still working */
+        }
+    }
+
+    return tap.status;
+}
+
+/**
+ * @brief Sends the command of the current tap step without waiting for the answer.
+ *
+ * @param[in,out] tap Tap context.
+ * @return true if the command was handed to the reader, false otherwise.
+ */
+bool CryptnoxWallet::startTapStep(CW_TapContext& tap) {
+    bool ret = false;
+    uint16_t apduLength = 0U;
+
+    switch (tap.step) {
+        case CW_TapStep::DETECT:
+            if (reselectHeldTarget()) {
+                /* Card kept from the previous tap: the next slice sends SELECT */
+                tap.step = CW_TapStep::SELECT;
+                ret = true;
+            } else {
+                /* The reset started by the previous endTap() has long finished */
+                ret = driver.finishResetReader() && driver.startListPassiveTarget();
+            }
+            break;
+
+        case CW_TapStep::SELECT:
+            memcpy(scratch.frame.apdu(), cw_selectCommand, sizeof(cw_selectCommand));
+            apduLength = sizeof(cw_selectCommand);
+            serial.println(F("Sending Select APDU..."));
+            break;
+
+        case CW_TapStep::CARD_CERTIFICATE:
+            memcpy(scratch.frame.apdu(), cw_getCardCertificateHeader, sizeof(cw_getCardCertificateHeader));
+            if (uECC_RNG(scratch.frame.apdu() + sizeof(cw_getCardCertificateHeader), RANDOM_BYTES) == 1) {
+                apduLength = sizeof(cw_getCardCertificateHeader) + RANDOM_BYTES;
+                serial.println(F("Sending getCardCertificate APDU..."));
+            }
+            break;
+
+        case CW_TapStep::OPEN_SECURE_CHANNEL: {
+            uint8_t clientPublicKey[CLIENT_PUBLIC_KEY_SIZE];
+
+            if (acquireSessionKeyPair(clientPublicKey, tap.clientPrivateKey, uECC_secp256r1())) {
+                cw_buildOpenSecureChannelApdu(scratch.frame.apdu(), clientPublicKey);
+                apduLength = REQUEST_OPENSECURECHANNEL_IN_BYTES;
+                tap.sharedSecretReady = false;
+                serial.println(F("Sending OpenSecureChannel APDU..."));
+            }
+            break;
+        }
+
+        case CW_TapStep::MUTUALLY_AUTHENTICATE:
+            apduLength = buildMutualAuthenticationApdu(tap.session, scratch.frame.apdu());
+            break;
+
+        case CW_TapStep::VERIFY_PIN:
+            apduLength = buildSecureApdu(tap.session, 0x80U, 0x20U, 0x00U, 0x00U,
+                                         cw_defaultPin, sizeof(cw_defaultPin), scratch.frame.apdu(), tap.macValue);
+            break;
+
+        default:
+            /* Unknown step */
+            break;
+    }
+
+    if (apduLength > 0U) {
+        printApdu(scratch.frame.apdu(), apduLength);
+        ret = driver.startAPDUFrame(scratch.frame.apdu(), apduLength);
+    }
+
+    if (ret && ((apduLength > 0U) || (tap.step == CW_TapStep::DETECT))) {
+        tap.startedAt = millis();
+        tap.awaitingResponse = true;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Reads and checks the answer of the current tap step, then moves to the next step.
+ *
+ * @param[in,out] tap Tap context.
+ * @return true if the step succeeded, false otherwise.
+ */
+bool CryptnoxWallet::finishTapStep(CW_TapContext& tap) {
+    bool ret = false;
+    uint16_t responseLength = sizeof(scratch.response);
+
+    if (tap.step == CW_TapStep::DETECT) {
+        ret = driver.finishListPassiveTarget();
+        tap.step = CW_TapStep::SELECT;
+    }
+    else if (driver.finishAPDU(scratch.response, responseLength) == false) {
+        serial.println(F("APDU exchange failed."));
+    }
+    else {
+        switch (tap.step) {
+            case CW_TapStep::SELECT:
+                ret = checkStatusWord(scratch.response, responseLength, 0x90, 0x00);
+                tap.step = CW_TapStep::CARD_CERTIFICATE;
+                break;
+
+            case CW_TapStep::CARD_CERTIFICATE:
+                if (checkStatusWord(scratch.response, responseLength, 0x90, 0x00) &&
+                    (responseLength == RESPONSE_GETCARDCERTIFICATE_IN_BYTES)) {
+                    ret = extractCardEphemeralKey(scratch.response, tap.cardEphemeralPubKey);
+                }
+                tap.step = CW_TapStep::OPEN_SECURE_CHANNEL;
+                break;
+
+            case CW_TapStep::OPEN_SECURE_CHANNEL: {
+                uint8_t salt[OPENSECURECHANNEL_SALT_IN_BYTES];
+
+                if (readOpenSecureChannelSalt(scratch.response, responseLength, salt)) {
+                    cw_deriveSessionKeys(tap.session, tap.sharedSecret, salt);
+                    memset(tap.sharedSecret, 0U, sizeof(tap.sharedSecret));
+                    serial.println(F("aesKey and macKey derived."));
+                    ret = true;
+                }
+                tap.step = CW_TapStep::MUTUALLY_AUTHENTICATE;
+                break;
+            }
+
+            case CW_TapStep::MUTUALLY_AUTHENTICATE:
+                ret = readMutualAuthenticationResponse(tap.session, scratch.response, responseLength);
+                tap.step = CW_TapStep::VERIFY_PIN;
+                break;
+
+            case CW_TapStep::VERIFY_PIN:
+                if (checkStatusWord(scratch.response, responseLength, 0x90, 0x00) &&
+                    aes_cbc_decrypt(tap.session, scratch.response, responseLength, tap.macValue)) {
+                    serial.println(F("PIN verified."));
+                    endTap(tap, CW_TapStatus::DONE);
+                    ret = true;
+                } else {
+                    serial.println(F("PIN verification failed."));
+                }
+                break;
+
+            default:
+                /* Unknown step */
+                break;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Closes a tap: wipes its secrets, holds the card or starts the reader reset, and records the result.
+ *
+ * A command whose answer never came (timeout) or is no longer wanted is
+ * aborted first, so that the reset is not sent to a reader still busy with
+ * it. The reset completes while the application is idle; the next tap
+ * collects it before detecting a card. With setKeepTarget(), a successful tap
+ * holds the card instead.
+ *
+ * @param[in,out] tap Tap context.
+ * @param[in] status Final status (DONE or FAILED).
+ */
+void CryptnoxWallet::endTap(CW_TapContext& tap, CW_TapStatus status) {
+    if (tap.awaitingResponse) {
+        driver.abortAPDU();
+    }
+
+    tap.clear();
+    scratch.clear();
+    tap.status = status;
+
+    /* Hold the card for the next tap, or reset reader for the card to be detected again */
+    targetHeld = (status == CW_TapStatus::DONE) && keepTarget && driver.holdTarget();
+    if (targetHeld == false) {
+        (void)driver.startResetReader();
+    }
+}
+
+/**
+ * @brief Wakes the card held after the previous operation, resetting the reader if it is gone.
+ *
+ * @return true if the held card answered, false if a detection is needed.
+ */
+bool CryptnoxWallet::reselectHeldTarget() {
+    bool ret = false;
+
+    if (targetHeld) {
+        targetHeld = false;
+        ret = driver.reselectTarget();
+
+        if (ret) {
+            serial.println(F("Held card reselected."));
+        } else {
+            (void)driver.startResetReader();
+        }
+    }
+
+    return ret;
+}
+
 /* Simple forward to PN532 driver for UID read */
 bool CryptnoxWallet::readUID(uint8_t* uidBuffer, uint8_t &uidLength) {
     return driver.readUID(uidBuffer, uidLength);
@@ -110,28 +584,19 @@ bool CryptnoxWallet::printPN532FirmwareVersion() {
 bool CryptnoxWallet::selectApdu() {
     bool ret = false;
 
-    /* Application AID selection command */
-    uint8_t selectApdu[] = {
-        0x00, /* CLA  : ISO interindustry */
-        0xA4, /* INS  : SELECT */
-        0x04, /* P1   : Select by name */
-        0x00, /* P2   : First or only occurrence */
-        0x07, /* Lc   : Length of AID */
-        0xA0, 0x00, 0x00, 0x10, 0x00, 0x01, 0x12  /* AID */
-    };
+    /* Stage the command in the frame so the driver can build its transport frame around it */
+    memcpy(scratch.frame.apdu(), cw_selectCommand, sizeof(cw_selectCommand));
 
     /* Print APDU */
-    printApdu(selectApdu, sizeof(selectApdu));
+    printApdu(scratch.frame.apdu(), sizeof(cw_selectCommand));
 
-    /* Response buffer on stack */
-    uint8_t response[RESPONSE_SELECT_IN_BYTES];
-    uint8_t responseLength = sizeof(response);
+    uint16_t responseLength = sizeof(scratch.response);
 
     serial.println(F("Sending Select APDU..."));
 
     /* Send SELECT command */
-    if (driver.sendAPDU(selectApdu, sizeof(selectApdu), response, responseLength)) {
-        if (checkStatusWord(response,responseLength, 0x90, 0x00)) {
+    if (driver.sendAPDUFrame(scratch.frame.apdu(), sizeof(cw_selectCommand), scratch.response, responseLength)) {
+        if (checkStatusWord(scratch.response, responseLength, 0x90, 0x00)) {
             serial.println(F("APDU exchange successful!"));
             ret = true;
         } else {
@@ -163,37 +628,28 @@ bool CryptnoxWallet::selectApdu() {
  */
 bool CryptnoxWallet::getCardCertificate(uint8_t* cardCertificate, uint8_t &cardCertificateLength) {
     bool ret = false;
-    uint8_t getCardCertificateResponse[RESPONSE_GETCARDCERTIFICATE_IN_BYTES];
-    uint8_t getCardCertificateResponseLength = sizeof(getCardCertificateResponse);
+    uint8_t* getCardCertificateResponse = scratch.response;
+    uint16_t getCardCertificateResponseLength = sizeof(scratch.response);
    
     if (cardCertificate != NULL) {
-        uint8_t randomBytes[RANDOM_BYTES];
-
-        /* APDU template (last 8 bytes replaced by random nonce) */
-        uint8_t getCardCertificateApdu[] = {
-            0x80,  /* CLA */
-            0xF8,  /* INS : GET CARD CERTIFICATE */
-            0x00,  /* P1 */
-            0x00,  /* P2 */
-            0x08,  /* Lc : 8 bytes nonce */
-        };
-
-        /* Generate 8 random bytes */
-        uECC_RNG(randomBytes, RANDOM_BYTES);
-
         /* Final APDU = header + 8 random bytes */
-        uint8_t fullApdu[sizeof(getCardCertificateApdu) + RANDOM_BYTES];
-        memcpy(fullApdu, getCardCertificateApdu, sizeof(getCardCertificateApdu));
-        memcpy(fullApdu + sizeof(getCardCertificateApdu), randomBytes, RANDOM_BYTES);
+        const uint8_t fullApduLength = sizeof(cw_getCardCertificateHeader) + RANDOM_BYTES;
+        memcpy(scratch.frame.apdu(), cw_getCardCertificateHeader, sizeof(cw_getCardCertificateHeader));
+        (void)uECC_RNG(scratch.frame.apdu() + sizeof(cw_getCardCertificateHeader), RANDOM_BYTES);
 
         /* Print APDU */
-        printApdu(fullApdu, sizeof(fullApdu));
+        printApdu(scratch.frame.apdu(), fullApduLength);
 
         serial.println(F("Sending getCardCertificate APDU..."));
 
         /* Send APDU */
-        if (driver.sendAPDU(fullApdu, sizeof(fullApdu), getCardCertificateResponse, getCardCertificateResponseLength)) {
-            if (checkStatusWord(getCardCertificateResponse, getCardCertificateResponseLength, 0x90, 0x00)) {
+        if (driver.sendAPDUFrame(scratch.frame.apdu(), fullApduLength, getCardCertificateResponse, getCardCertificateResponseLength)) {
+            if (checkStatusWord(getCardCertificateResponse, getCardCertificateResponseLength, 0x90, 0x00) == false) {
+                serial.println(F("APDU SW1/SW2 not expected. Error."));
+            } else if (getCardCertificateResponseLength != RESPONSE_GETCARDCERTIFICATE_IN_BYTES) {
+                /* The certificate buffer is sized for exactly one certificate */
+                serial.println(F("Unexpected response size."));
+            } else {
                 /* Remove status word from answer */
                 cardCertificateLength = getCardCertificateResponseLength - RESPONSE_STATUS_WORDS_IN_BYTES;
 
@@ -202,8 +658,6 @@ bool CryptnoxWallet::getCardCertificate(uint8_t* cardCertificate, uint8_t &cardC
 
                 serial.println(F("APDU exchange successful!"));    
                 ret = true;
-            } else {
-                serial.println(F("APDU SW1/SW2 not expected. Error."));
             }
         } else {
             serial.println(F("APDU getCardCertificate failed."));
@@ -218,6 +672,8 @@ bool CryptnoxWallet::getCardCertificate(uint8_t* cardCertificate, uint8_t &cardC
  *
  * This function sends the APDU command to the card to get the session salt, which is
  * required for the subsequent key derivation in the secure channel setup.
+ * The client keypair comes from the pool filled by refillKeyPool() when possible;
+ * an empty pool falls back to generating the keypair synchronously.
  *
  * @param[inout] salt Pointer to a 32-byte buffer where the card-provided salt will be stored.
  * @param[inout] clientPublicKey Buffer to store the client's generated 64-byte public key.
@@ -228,65 +684,223 @@ bool CryptnoxWallet::getCardCertificate(uint8_t* cardCertificate, uint8_t &cardC
 bool CryptnoxWallet::openSecureChannel(uint8_t* salt, uint8_t* sessionPublicKey, uint8_t* sessionPrivateKey, const uECC_Curve_t* sessionCurve) {
     bool ret = false;
 
-    /* ECC setup and random generation */
-    uECC_set_rng(&uECC_RNG);
+    if (acquireSessionKeyPair(sessionPublicKey, sessionPrivateKey, sessionCurve)) {
+        /* Construct final APDU */
+        cw_buildOpenSecureChannelApdu(scratch.frame.apdu(), sessionPublicKey);
 
-    /* Generate keypair */
-    bool eccSuccess = uECC_make_key(sessionPublicKey, sessionPrivateKey, sessionCurve);
+        uint16_t responseLength = sizeof(scratch.response);
 
-    /* Abort if ECC fails */
-    if (eccSuccess == false) {
-        serial.println(F("ECC key generation failed."));
+        /* Print APDU */
+        printApdu(scratch.frame.apdu(), REQUEST_OPENSECURECHANNEL_IN_BYTES);
+
+        serial.println(F("Sending OpenSecureChannel APDU..."));
+
+        /* Send OPC request */
+        if (driver.sendAPDUFrame(scratch.frame.apdu(), REQUEST_OPENSECURECHANNEL_IN_BYTES, scratch.response, responseLength)) {
+            ret = readOpenSecureChannelSalt(scratch.response, responseLength, salt);
+        } else {
+            serial.println(F("APDU exchange failed."));
+        }
     }
-    else {
-        /* APDU header for OPEN SECURE CHANNEL */
-        uint8_t opcApduHeader[] = {
-            0x80,  /* CLA */
-            0x10,  /* INS : OPEN SECURE CHANNEL */
-            0x00,  /* P1 : pairing slot index */
-            0x00,  /* P2 */
-            0x41,  /* Lc : 1 format byte + 64 public key bytes */
-            0x04   /* ECC uncompressed public key format */
-        };
 
-        /* Construct final APDU */
-        uint8_t fullApdu[sizeof(opcApduHeader) + CLIENT_PUBLIC_KEY_SIZE];
-        memcpy(fullApdu, opcApduHeader, sizeof(opcApduHeader));
-        memcpy(fullApdu + sizeof(opcApduHeader), sessionPublicKey, CLIENT_PUBLIC_KEY_SIZE);
+    return ret;
+}
 
-        /* Response buffer */
-        uint8_t response[RESPONSE_OPENSECURECHANNEL_IN_BYTES];
-        uint8_t responseLength = sizeof(response);
+/**
+ * @brief Opens the secure channel and mutually authenticates in one pipelined step.
+ *
+ * The APDUs exchanged are identical to openSecureChannel() followed by
+ * mutuallyAuthenticate(). The client keypair never leaves
+ * openSecureChannelPipelined().
+ *
+ * @param[in,out] session             Session receiving Kenc, Kmac and the initial IV.
+ * @param[in]     cardEphemeralPubKey 64-byte card ephemeral public key (X || Y).
+ * @param[in]     sessionCurve        ECC curve (e.g., uECC_secp256r1()).
+ * @return true if the secure channel is open and authenticated, false otherwise.
+ */
+bool CryptnoxWallet::establishSecureChannel(CW_SecureSession& session, const uint8_t* cardEphemeralPubKey, const uECC_Curve_t* sessionCurve) {
+    bool ret = false;
+    uint8_t sharedSecret[CW_SHAREDSECRET_SIZE] = { 0U };
+    uint8_t salt[OPENSECURECHANNEL_SALT_IN_BYTES];
 
-        /* Print APDU */
-        printApdu(fullApdu, sizeof(fullApdu));
+    if (openSecureChannelPipelined(sharedSecret, salt, cardEphemeralPubKey, sessionCurve)) {
+        cw_deriveSessionKeys(session, sharedSecret, salt);
+        serial.println(F("aesKey and macKey derived."));
+
+        ret = sendMutualAuthentication(session);
+    }
+
+    memset(sharedSecret, 0U, sizeof(sharedSecret));
+
+    return ret;
+}
+
+/**
+ * @brief Sends OPEN SECURE CHANNEL and computes the ECDH shared secret while
+ *        the card computes its answer.
+ *
+ * The card ephemeral key is known from the certificate, so the ECDH shared
+ * secret does not depend on the card's answer. The command is started with
+ * NFCDriver::startAPDUFrame(), the ECDH runs while the PN532 talks to the
+ * card, and the salt is only collected afterwards.
+ *
+ * @param[out] sharedSecret        32-byte buffer receiving the ECDH shared secret.
+ * @param[out] salt                32-byte buffer receiving the card salt.
+ * @param[in]  cardEphemeralPubKey 64-byte card ephemeral public key (X || Y).
+ * @param[in]  sessionCurve        ECC curve (e.g., uECC_secp256r1()).
+ * @return true if both the shared secret and the salt are available, false otherwise.
+ */
+bool CryptnoxWallet::openSecureChannelPipelined(uint8_t* sharedSecret, uint8_t* salt, const uint8_t* cardEphemeralPubKey, const uECC_Curve_t* sessionCurve) {
+    bool ret = false;
+    uint8_t clientPrivateKey[CLIENT_PRIVATE_KEY_SIZE] = { 0U };
+    uint8_t clientPublicKey[CLIENT_PUBLIC_KEY_SIZE] = { 0U };
+
+    if (acquireSessionKeyPair(clientPublicKey, clientPrivateKey, sessionCurve)) {
+        cw_buildOpenSecureChannelApdu(scratch.frame.apdu(), clientPublicKey);
+
+        printApdu(scratch.frame.apdu(), REQUEST_OPENSECURECHANNEL_IN_BYTES);
 
         serial.println(F("Sending OpenSecureChannel APDU..."));
 
-        /* Send OPC request */
-        if (driver.sendAPDU(fullApdu, sizeof(fullApdu), response, responseLength)) {
-            if (checkStatusWord(response, responseLength, 0x90, 0x00)) {
-                if (responseLength == RESPONSE_OPENSECURECHANNEL_IN_BYTES) {
-                    /* Remove status word from answer */
-                    size_t dataLength = OPENSECURECHANNEL_SALT_IN_BYTES;
+        if (driver.startAPDUFrame(scratch.frame.apdu(), REQUEST_OPENSECURECHANNEL_IN_BYTES)) {
+            /* ECDH runs while the card computes its answer */
+            bool ecdhSuccess = (uECC_shared_secret(cardEphemeralPubKey, clientPrivateKey, sharedSecret, sessionCurve) != 0);
 
-                    /* Copy only the useful data (the salt) into the buffer */
-                    memcpy(salt, response, dataLength);
+            /* Always collect the answer to leave the reader idle */
+            uint16_t responseLength = sizeof(scratch.response);
+            bool exchangeSuccess = driver.finishAPDU(scratch.response, responseLength);
 
-                    serial.println(F("APDU exchange successful!"));    
-                    ret = true;
-                } 
-                else {
-                    serial.println(F("Unexpected response size."));
-                }
+            if (ecdhSuccess == false) {
+                serial.println(F("ECDH shared secret generation failed!"));
+            } else if (exchangeSuccess == false) {
+                serial.println(F("APDU exchange failed."));
             } else {
-                serial.println(F("APDU SW1/SW2 not expected. Error."));
+                ret = readOpenSecureChannelSalt(scratch.response, responseLength, salt);
             }
         } else {
             serial.println(F("APDU exchange failed."));
         }
     }
 
+    /* The keypair is single use */
+    memset(clientPrivateKey, 0U, sizeof(clientPrivateKey));
+
+    return ret;
+}
+
+/**
+ * @brief Sends OPEN SECURE CHANNEL, then computes the ECDH shared secret.
+ *
+ * @param[out] sharedSecret        32-byte buffer receiving the ECDH shared secret.
+ * @param[out] salt                32-byte buffer receiving the card salt.
+ * @param[in]  cardEphemeralPubKey 64-byte card ephemeral public key (X || Y).
+ * @param[in]  sessionCurve        ECC curve (e.g., uECC_secp256r1()).
+ * @return true if both the salt and the shared secret are available, false otherwise.
+ */
+bool CryptnoxWallet::openSecureChannelSequential(uint8_t* sharedSecret, uint8_t* salt, const uint8_t* cardEphemeralPubKey, const uECC_Curve_t* sessionCurve) {
+    bool ret = false;
+    uint8_t clientPrivateKey[CLIENT_PRIVATE_KEY_SIZE] = { 0U };
+    uint8_t clientPublicKey[CLIENT_PUBLIC_KEY_SIZE] = { 0U };
+
+    if (openSecureChannel(salt, clientPublicKey, clientPrivateKey, sessionCurve)) {
+        if (uECC_shared_secret(cardEphemeralPubKey, clientPrivateKey, sharedSecret, sessionCurve) != 0) {
+            serial.println(F("ECDH shared secret generated."));
+            ret = true;
+        } else {
+            serial.println(F("ECDH shared secret generation failed!"));
+        }
+    }
+
+    /* The keypair is single use */
+    memset(clientPrivateKey, 0U, sizeof(clientPrivateKey));
+
+    return ret;
+}
+
+/**
+ * @brief Derives the session keys, mutually authenticates and verifies the PIN.
+ *
+ * Owns the secure session of processCard(). Called once the ECDH is over, so
+ * the session and the ECDH are never on the stack at the same time.
+ *
+ * @param[in] sharedSecret 32-byte ECDH shared secret.
+ * @param[in] salt         32-byte salt returned by OPEN SECURE CHANNEL.
+ * @return true if the card accepted the authentication and the PIN, false otherwise.
+ */
+bool CryptnoxWallet::authenticateAndVerifyPin(const uint8_t* sharedSecret, const uint8_t* salt) {
+    bool ret = false;
+
+    /* Create secure session context (stack-local for reentrancy) */
+    CW_SecureSession session;
+
+    /* SHA-512(sharedSecret || pairingKey || salt), split into Kenc and Kmac */
+    cw_deriveSessionKeys(session, sharedSecret, salt);
+    serial.println(F("aesKey and macKey derived."));
+
+    if (sendMutualAuthentication(session)) {
+        ret = verifyPin(session);
+    }
+
+    /* Securely clear session keys before leaving scope */
+    session.clear();
+
+    return ret;
+}
+
+/**
+ * @brief Takes a client ephemeral keypair from the pool, or generates one.
+ *
+ * @param[out] publicKey  64-byte buffer receiving the public key.
+ * @param[out] privateKey 32-byte buffer receiving the private key.
+ * @param[in]  curve      ECC curve of the keypair.
+ * @return true if a keypair is available, false if key generation failed.
+ */
+bool CryptnoxWallet::acquireSessionKeyPair(uint8_t* publicKey, uint8_t* privateKey, const uECC_Curve_t* curve) {
+    /* Use a pre-generated keypair if one is ready, otherwise generate it now */
+    bool eccSuccess = takePooledKey(publicKey, privateKey, curve);
+
+    if (eccSuccess == false) {
+        /* ECC setup and random generation */
+        uECC_set_rng(&uECC_RNG);
+
+        /* Generate keypair */
+        eccSuccess = (uECC_make_key(publicKey, privateKey, curve) != 0);
+    }
+
+    /* Abort if ECC fails */
+    if (eccSuccess == false) {
+        serial.println(F("ECC key generation failed."));
+    }
+
+    return eccSuccess;
+}
+
+/**
+ * @brief Validates an OPEN SECURE CHANNEL response and extracts the salt.
+ *
+ * @param[in]  response       Raw response, status word included.
+ * @param[in]  responseLength Response length in bytes.
+ * @param[out] salt           32-byte buffer receiving the salt.
+ * @return true if the card answered 0x90 0x00 with a salt, false otherwise.
+ */
+bool CryptnoxWallet::readOpenSecureChannelSalt(const uint8_t* response, uint16_t responseLength, uint8_t* salt) {
+    bool ret = false;
+
+    if (checkStatusWord(response, responseLength, 0x90, 0x00)) {
+        if (responseLength == RESPONSE_OPENSECURECHANNEL_IN_BYTES) {
+            /* Copy only the useful data (the salt) into the buffer, status word removed */
+            memcpy(salt, response, OPENSECURECHANNEL_SALT_IN_BYTES);
+
+            serial.println(F("APDU exchange successful!"));
+            ret = true;
+        }
+        else {
+            serial.println(F("Unexpected response size."));
+        }
+    } else {
+        serial.println(F("APDU SW1/SW2 not expected. Error."));
+    }
+
     return ret;
 }
 
@@ -294,7 +908,8 @@ bool CryptnoxWallet::openSecureChannel(uint8_t* salt, uint8_t* sessionPublicKey,
  * @brief Performs the ECDH-based mutual authentication step of the secure channel.
  *
  * This function computes the shared secret between the client's private key
- * and the card's ephemeral public key using the specified ECC curve.
+ * and the card's ephemeral public key using the specified ECC curve, derives
+ * the session keys and sends MUTUALLY AUTHENTICATE.
  *
  * @param[in] salt Pointer to the 32-byte salt received from the card.
  * @param[in] clientPublicKey Pointer to the 64-byte client public key.
@@ -305,7 +920,7 @@ bool CryptnoxWallet::openSecureChannel(uint8_t* salt, uint8_t* sessionPublicKey,
  */
 bool CryptnoxWallet::mutuallyAuthenticate(CW_SecureSession& session, const uint8_t* salt, uint8_t* clientPublicKey, uint8_t* clientPrivateKey, const uECC_Curve_t* sessionCurve, uint8_t* cardEphemeralPubKey) {
     bool ret = false;
-    uint8_t sharedSecret[32U] = { 0U };
+    uint8_t sharedSecret[CW_SHAREDSECRET_SIZE] = { 0U };
 
     /* Generate ECDH shared secret with card ephemeral public key and client private key */
     if (uECC_shared_secret(cardEphemeralPubKey, clientPrivateKey, sharedSecret, sessionCurve) == 0) {
@@ -313,115 +928,203 @@ bool CryptnoxWallet::mutuallyAuthenticate(CW_SecureSession& session, const uint8
         ret = false;
     }
     else {
-        uint8_t concat[32U + sizeof(COMMON_PAIRING_DATA) - 1U + 32U] = { 0U }; /* sharedSecret || pairingKey (- null character) || salt */
-        uint8_t sha512Output[64U] = { 0U };
-        size_t pairingKeyLen;
-        size_t concatLen;
-
         serial.println(F("ECDH shared secret generated."));
 
-        /* Concatenate sharedSecret, pairingKey, and salt */
-        pairingKeyLen = sizeof(COMMON_PAIRING_DATA) - 1U; /* exclude null terminator */
-        concatLen = 32U + pairingKeyLen + 32U;
-
-        memcpy(concat, sharedSecret, 32U); /* copy sharedSecret */
-        memcpy(concat + 32U, COMMON_PAIRING_DATA, pairingKeyLen); /* copy pairingKey */
-        memcpy(concat + 32U + pairingKeyLen, salt, 32U); /* copy salt */
-
-        /* Calculate SHA-512 over concatenated buffer */
-        SHA512 sha;
-        sha.update(concat, concatLen);
-        sha.finalize(sha512Output, sizeof(sha512Output));
+        /* SHA-512(sharedSecret || pairingKey || salt), split into Kenc and Kmac */
+        cw_deriveSessionKeys(session, sharedSecret, salt);
         serial.println(F("SHA-512 computed."));
+        serial.println(F("aesKey and macKey derived."));
 
-        /* Split SHA-512 output into Kenc and Kmac */
-        memcpy(session.aesKey, sha512Output, CW_AESKEY_SIZE);       /* first 32 bytes for encryption key */
-        memcpy(session.macKey, sha512Output + CW_AESKEY_SIZE, CW_MACKEY_SIZE); /* last 32 bytes for MAC key */
+        ret = sendMutualAuthentication(session);
+    }
 
-        serial.println(F("aesKey and macKey derived."));
+    memset(sharedSecret, 0U, sizeof(sharedSecret));
 
-        /* Set shared iv and mac_iv by client and smartcard */
-        uint8_t iv_opc[AES_BLOCK_SIZE] = { 0U };
-        uint8_t mac_iv[AES_BLOCK_SIZE] = { 0U };
-        memset(iv_opc, 0x01, AES_BLOCK_SIZE);
-
-        /* Generate 256-bit random number */
-        uint8_t RNG_data[32U] = { 0U };
-        if (uECC_RNG(RNG_data, 32U) != 1) {
-            serial.println(F("Unable to generate 256-bit random number."));
-            return false;
-        }
-
-        /* Cipher the random number with aesKey */
-        uint8_t ciphertextOPC[2U * INPUT_BUFFER_LIMIT] = { 0U };
-        /* Set padding ISO/IEC 9797-1 Method 2 algorithm */
-        aesLib.set_paddingmode(paddingMode::Bit);
-        uint16_t cipherLength = aesLib.encrypt(reinterpret_cast<byte*>(RNG_data), sizeof(RNG_data), ciphertextOPC, session.aesKey, sizeof(session.aesKey), iv_opc);
-
-        /* Compute MAC */
-        uint8_t opcApduHeader[5U] = { 0x80, 0x11, 0x00, 0x00, cipherLength + AES_BLOCK_SIZE };
-        /* MAC_apduHeader: zero padded opcApduHeader */
-        uint8_t MAC_apduHeader[AES_BLOCK_SIZE] = { 0U };
-        memcpy(MAC_apduHeader, opcApduHeader, sizeof(opcApduHeader));
-
-        size_t  MAC_data_length = sizeof(MAC_apduHeader) + cipherLength;
-        uint8_t MAC_data[MAX_MAC_DATA_LEN] = { 0U }; /* sizeof(MAC_apduHeader) + cipherLength = 16 + 48 */
-        uint8_t ciphertextMACLong[2 * INPUT_BUFFER_LIMIT] = { 0U };
-        if (MAC_data_length > sizeof(MAC_data)) {
-            return false;
-        } 
-
-        /* Data to cipher: MAC_data = MAC_apduHeader (zero padded opcApduHeader to equal AES_BLOCK_SIZE) || ciphertextOPC */
-        memcpy(MAC_data, MAC_apduHeader, sizeof(MAC_apduHeader));
-        memcpy(MAC_data + sizeof(MAC_apduHeader), ciphertextOPC, cipherLength);
-        /* Set no padding */
-        aesLib.set_paddingmode(paddingMode::Null);
-        uint16_t encryptedLengthMAC = aesLib.encrypt(reinterpret_cast<byte*>(MAC_data), MAC_data_length, ciphertextMACLong, session.macKey, sizeof(session.macKey), mac_iv);
-
-        uint8_t MAC_value[AES_BLOCK_SIZE] = { 0U };
-        /* In AES CBC-MAC last block is MAC */
-        uint8_t macOffset = encryptedLengthMAC - AES_BLOCK_SIZE;
-        memcpy(MAC_value, ciphertextMACLong + macOffset, AES_BLOCK_SIZE);
-
-        /* Forge APDU: OPC HEADER || MAC_value || ciphertextOPC
-           REQUEST_MUTUALLYAUTHENTICATE_IN_BYTES : apduOpcLength = sizeof(opcApduHeader) + sizeof(MAC_value) + cipherLength */
-        uint8_t sendApduOpc[REQUEST_MUTUALLYAUTHENTICATE_IN_BYTES] = { 0U };
-        uint16_t offset = 0U;
-        memcpy(sendApduOpc + offset, opcApduHeader, sizeof(opcApduHeader));
-        offset += sizeof(opcApduHeader);
-        memcpy(sendApduOpc + offset, MAC_value, sizeof(MAC_value));
-        offset += sizeof(MAC_value);
-        memcpy(sendApduOpc + offset, ciphertextOPC, cipherLength);
+    return ret;
+}
+
+/**
+ * @brief Sends MUTUALLY AUTHENTICATE once the session keys are installed.
+ *
+ * @param[in,out] session Session holding Kenc/Kmac; its IV is set on success.
+ * @return true if the card accepted the authentication, false otherwise.
+ */
+bool CryptnoxWallet::sendMutualAuthentication(CW_SecureSession& session) {
+    bool ret = false;
 
+    if (buildMutualAuthenticationApdu(session, scratch.frame.apdu()) == REQUEST_MUTUALLYAUTHENTICATE_IN_BYTES) {
         /* Send APDU */
-        uint8_t response[255U] = { 0U };
-        uint8_t responseLength = sizeof(response);
-        if (driver.sendAPDU(sendApduOpc, sizeof(sendApduOpc), response, responseLength)) {
-            if (checkStatusWord(response, responseLength, 0x90, 0x00)) {
-                if (responseLength == RESPONSE_MUTUALLYAUTHENTICATE_IN_BYTES) {
-                    serial.println(F("OpenSecureChannel success."));
-
-                    /* Rolling IVs: It is the last MAC, ie the first AES_BLOCK_SIZE bytes from the last answer */
-                    memcpy(session.iv, response, CW_IV_SIZE);
-                    ret = true; 
-                } 
-                else {
-                    serial.println(F("Unexpected response size."));
-                }
-            } else {
-                serial.println(F("APDU SW1/SW2 not expected. Error."));
-            }
+        uint16_t responseLength = sizeof(scratch.response);
+        if (driver.sendAPDUFrame(scratch.frame.apdu(), REQUEST_MUTUALLYAUTHENTICATE_IN_BYTES, scratch.response, responseLength)) {
+            ret = readMutualAuthenticationResponse(session, scratch.response, responseLength);
         } else {
             serial.println(F("APDU exchange failed."));
         }
+    }
 
-        /* Secure cleanup */
-        memset(sharedSecret, 0U, sizeof(sharedSecret));
-        memset(sha512Output, 0U, sizeof(sha512Output));
-        memset(concat, 0U, sizeof(concat));
-        memset(RNG_data, 0U, sizeof(RNG_data));
-        memset(ciphertextOPC, 0U, sizeof(ciphertextOPC));
-        memset(MAC_data, 0U, sizeof(MAC_data));
+    memset(scratch.frame.apdu(), 0U, REQUEST_MUTUALLYAUTHENTICATE_IN_BYTES);
+
+    return ret;
+}
+
+/**
+ * @brief Builds the MUTUALLY AUTHENTICATE command APDU.
+ *
+ * Encrypts a fresh 256-bit random with Kenc (IV 0x01...01) and MACs the
+ * command with Kmac.
+ *
+ * @param[in]  session Session holding Kenc/Kmac.
+ * @param[out] apdu    REQUEST_MUTUALLYAUTHENTICATE_IN_BYTES buffer receiving the APDU.
+ * @return APDU length in bytes, 0 on failure.
+ */
+uint8_t CryptnoxWallet::buildMutualAuthenticationApdu(CW_SecureSession& session, uint8_t* apdu) {
+    uint8_t ret = 0U;
+    uint8_t* ciphertextOPC = apdu + SECURE_CIPHERTEXT_OFFSET;
+    const uint16_t cipherLength = 32U + AES_BLOCK_SIZE; /* 256-bit random and one full padding block */
+
+    /* Set shared iv and mac_iv by client and smartcard */
+    uint8_t iv_opc[AES_BLOCK_SIZE] = { 0U };
+    memset(iv_opc, 0x01, AES_BLOCK_SIZE);
+
+    /* Generate the 256-bit random number directly where its ciphertext goes */
+    if (uECC_RNG(ciphertextOPC, 32U) != 1) {
+        serial.println(F("Unable to generate 256-bit random number."));
+    }
+    else {
+        /* OPC header */
+        apdu[0] = 0x80U;
+        apdu[1] = 0x11U;
+        apdu[2] = 0x00U;
+        apdu[3] = 0x00U;
+        apdu[4] = (uint8_t)(cipherLength + AES_BLOCK_SIZE);
+
+        /* MAC over opcApduHeader zero padded to AES_BLOCK_SIZE || ciphertextOPC,
+           APDU = OPC HEADER || MAC_value || ciphertextOPC */
+        CW_CbcMacContext mac;
+        cw_cbcMacInit(mac, session.macCipher);
+        cw_cbcMacUpdate(mac, apdu, SECURE_HEADER_IN_BYTES);
+        cw_cbcMacPad(mac);
+
+        /* Cipher the random number with aesKey in place, padding ISO/IEC 9797-1 Method 2 algorithm */
+        (void)cw_encryptThenMac(session.aesCipher, iv_opc, mac, ciphertextOPC, 32U, ciphertextOPC);
+        cw_cbcMacFinal(mac, apdu + SECURE_HEADER_IN_BYTES);
+        ret = (uint8_t)(SECURE_CIPHERTEXT_OFFSET + cipherLength);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Validates the MUTUALLY AUTHENTICATE response and sets the initial IV.
+ *
+ * @param[in,out] session        Session whose IV is set on success.
+ * @param[in]     response       Raw response, status word included.
+ * @param[in]     responseLength Response length in bytes.
+ * @return true if the card accepted the authentication, false otherwise.
+ */
+bool CryptnoxWallet::readMutualAuthenticationResponse(CW_SecureSession& session, const uint8_t* response, uint16_t responseLength) {
+    bool ret = false;
+
+    if (checkStatusWord(response, responseLength, 0x90, 0x00)) {
+        if (responseLength == RESPONSE_MUTUALLYAUTHENTICATE_IN_BYTES) {
+            serial.println(F("OpenSecureChannel success."));
+
+            /* Rolling IVs: It is the last MAC, ie the first AES_BLOCK_SIZE bytes from the last answer */
+            memcpy(session.iv, response, CW_IV_SIZE);
+            ret = true;
+        }
+        else {
+            serial.println(F("Unexpected response size."));
+        }
+    } else {
+        serial.println(F("APDU SW1/SW2 not expected. Error."));
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Pre-generate one ephemeral secp256r1 keypair into the first free pool slot.
+ *
+ * Generating a P-256 keypair is the most expensive step of the secure channel
+ * setup on small MCUs. Calling this from idle time moves that cost out of the
+ * card tap. Only one keypair is generated per call to bound the time spent.
+ *
+ * @return true if a keypair was generated, false if the pool is full or generation failed.
+ */
+bool CryptnoxWallet::refillKeyPool() {
+    bool ret = false;
+    CW_EphemeralKeyPair* slot = NULL;
+
+    for (uint8_t i = 0U; (i < CW_KEYPOOL_SIZE) && (slot == NULL); i++) {
+        if (keyPool[i].ready == false) {
+            slot = &keyPool[i];
+        }
+    }
+
+    if (slot != NULL) {
+        uECC_set_rng(&uECC_RNG);
+
+        if (uECC_make_key(slot->publicKey, slot->privateKey, uECC_secp256r1()) != 0) {
+            slot->ready = true;
+            ret = true;
+        }
+        else {
+            memset(slot->publicKey, 0U, sizeof(slot->publicKey));
+            memset(slot->privateKey, 0U, sizeof(slot->privateKey));
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Count the unused keypairs in the pool.
+ *
+ * @return Number of ready keypairs.
+ */
+uint8_t CryptnoxWallet::keyPoolCount() const {
+    uint8_t count = 0U;
+
+    for (uint8_t i = 0U; i < CW_KEYPOOL_SIZE; i++) {
+        if (keyPool[i].ready) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Take a pre-generated keypair out of the pool.
+ *
+ * The slot is wiped before returning so the keypair cannot be handed out again.
+ *
+ * @param[out] publicKey 64-byte buffer receiving the public key.
+ * @param[out] privateKey 32-byte buffer receiving the private key.
+ * @param[in] curve Curve requested by the caller; only secp256r1 keys are pooled.
+ * @return true if a pooled keypair was copied out, false otherwise.
+ */
+bool CryptnoxWallet::takePooledKey(uint8_t* publicKey, uint8_t* privateKey, const uECC_Curve_t* curve) {
+    bool ret = false;
+
+    if ((publicKey != NULL) && (privateKey != NULL) && (curve == uECC_secp256r1())) {
+        for (uint8_t i = 0U; (i < CW_KEYPOOL_SIZE) && (ret == false); i++) {
+            CW_EphemeralKeyPair& slot = keyPool[i];
+
+            if (slot.ready) {
+                memcpy(publicKey, slot.publicKey, CW_PUBLICKEY_SIZE);
+                memcpy(privateKey, slot.privateKey, CW_PRIVATEKEY_SIZE);
+
+                /* Zeroize the slot: a keypair is used for one session only */
+                memset(slot.publicKey, 0U, sizeof(slot.publicKey));
+                memset(slot.privateKey, 0U, sizeof(slot.privateKey));
+                slot.ready = false;
+
+                serial.println(F("Using pre-generated keypair."));
+                ret = true;
+            }
+        }
     }
 
     return ret;
@@ -459,26 +1162,17 @@ int CryptnoxWallet::uECC_RNG(uint8_t *dest, unsigned size) {
 /**
  * @brief Print an APDU in hexadecimal format to Serial for debugging.
  * 
- * Each byte is printed as 0xXX. Lines wrap every 16 bytes for readability.
+ * Each byte is printed as 0xXX. Lines wrap every 16 bytes for readability,
+ * and each line is handed to the serial driver in one write().
  * @param apdu Pointer to the APDU byte array.
  * @param length Number of bytes in the APDU.
  * @param label Optional label to prepend (default: "APDU to send").
  */
-void CryptnoxWallet::printApdu(const uint8_t* apdu, uint8_t length, const char* label) {
+void CryptnoxWallet::printApdu(const uint8_t* apdu, uint16_t length, const char* label) {
     serial.print(label);
     serial.print(F(": "));
     serial.println();
-    for (uint8_t i = 0U; i < length; i++) {
-        serial.print("0x");
-        if (apdu[i] < 16U) serial.print("0");
-        serial.print(apdu[i], HEX);
-        serial.print(" ");
-        
-        /* Wrap line every 16 bytes */
-        if ((i + 1U) % 16 == 0 && (i + 1U) != length) serial.println();
-    }
-    
-    serial.println();
+    serial.printHexDump(apdu, length);
 }
 
 /**
@@ -490,7 +1184,7 @@ void CryptnoxWallet::printApdu(const uint8_t* apdu, uint8_t length, const char*
  * @param sw2Expected     Expected value for SW2 (e.g., 0x00).
  * @return true if the last two bytes match SW1/SW2, false otherwise.
  */
-bool CryptnoxWallet::checkStatusWord(const uint8_t* response, uint8_t responseLength, uint8_t sw1Expected, uint8_t sw2Expected) {
+bool CryptnoxWallet::checkStatusWord(const uint8_t* response, uint16_t responseLength, uint8_t sw1Expected, uint8_t sw2Expected) {
     bool ret = false;
 
     if ((response == NULL) || (responseLength < 2U)) {
@@ -563,20 +1257,11 @@ bool CryptnoxWallet::extractCardEphemeralKey(const uint8_t* cardCertificate, uin
             if (i > 0U) {
                 cardEphemeralPubKey[i - 1U] = b;
             }
-
-            /* Print hex to Serial for debugging */
-            serial.print("0x");
-            if (b < 0x10U) {
-                serial.print('0');
-            }
-            serial.print(b, HEX);
-            serial.print(' ');
-
-            /* Wrap line every 16 bytes */
-            if ((i + 1U) % 16 == 0 && (i + 1U) != fullKeyLength) serial.println();
         }
 
-        serial.println();
+        /* Print hex to Serial for debugging */
+        serial.printHexDump(&cardCertificate[keyStart], fullKeyLength);
+        ret = true;
     }
 
     return ret;
@@ -585,172 +1270,242 @@ bool CryptnoxWallet::extractCardEphemeralKey(const uint8_t* cardCertificate, uin
 /**
  * @brief Verifies the PIN code on the smartcard.
  *
- * This function constructs the APDU for the "Verify PIN" command and encrypts it
- * using `aes_cbc_encrypt`.
+ * This function sends the "Verify PIN" command through the secure channel
+ * using `transmitSecure`.
  *
  * @param[in,out] session Reference to the secure session containing keys and IV.
+ * @return true if the card accepted the PIN, false otherwise.
  */
-void CryptnoxWallet::verifyPin(CW_SecureSession& session) {
-    uint8_t data[] = { 0x31, 0x32, 0x33, 0x34 }; /* PIN code 1234 */
-    uint8_t apdu[] = {0x80, 0x20, 0x00, 0x00};
-    aes_cbc_encrypt(session, apdu, sizeof(apdu), data, sizeof(data));
+bool CryptnoxWallet::verifyPin(CW_SecureSession& session) {
+    /* transmitSecure() only uses the frame and response areas, the work area takes the plaintext */
+    uint16_t responseLength = CW_SECURE_MAX_DATA_SIZE;
+    bool ret = transmitSecure(session, 0x80U, 0x20U, 0x00U, 0x00U, cw_defaultPin, sizeof(cw_defaultPin), scratch.work, responseLength);
+
+    if (ret) {
+        serial.println(F("PIN verified."));
+    } else {
+        serial.println(F("PIN verification failed."));
+    }
+    memset(scratch.work, 0U, responseLength);
+
+    return ret;
 }
 
 /**
- * @brief Encrypts data using AES-CBC, computes a MAC, and sends the APDU to the smartcard.
+ * @brief Sends one command through the secure channel and returns the decrypted answer.
  *
- * This function performs AES-CBC encryption of the given data with padding (ISO/IEC 9797-1 Method 2),
- * computes a MAC over the APDU header and encrypted payload, and constructs the final APDU to send.
- * The response IV is updated from the last APDU response.
+ * The payload is AES-CBC encrypted with Kenc and the rolling IV (ISO/IEC 9797-1 Method 2
+ * padding), then authenticated with an AES CBC-MAC under Kmac over:
  *
- * @param[in,out] session Reference to the secure session containing keys and IV.
- * @param[in] apdu Pointer to the APDU header bytes.
- * @param[in] apduLength Length of the APDU header.
- * @param[in] data Pointer to the plaintext data to encrypt.
- * @param[in] dataLength Length of the plaintext data.
+ * | Field                         | Size     |
+ * |-------------------------------|----------|
+ * | CLA INS P1 P2 Lc              | 5 bytes  |
+ * | Zero padding                  | 11 bytes |
+ * | Ciphertext                    | n bytes  |
  *
- * @note
- * - AES CBC encryption is performed with `session.aesKey` and current `session.iv`.
- * - MAC is computed with `session.macKey` using AES-CBC with no padding.
- * - `session.iv` is updated after successful APDU response for rolling IV.
+ * The APDU sent is CLA INS P1 P2 Lc || MAC || ciphertext, with Lc = n + 16.
+ * The response MAC is verified, the response payload is decrypted into @p response
+ * and `session.iv` is rolled to the response MAC, so any number of commands can be
+ * chained on a single secure channel.
+ *
+ * @param[in,out] session        Reference to the secure session containing keys and IV.
+ * @param[in]     cla            Class byte.
+ * @param[in]     ins            Instruction byte.
+ * @param[in]     p1             Parameter 1.
+ * @param[in]     p2             Parameter 2.
+ * @param[in]     data           Plaintext command data (may be NULL if dataLength is 0).
+ * @param[in]     dataLength     Plaintext length, at most CW_SECURE_MAX_DATA_SIZE bytes.
+ * @param[out]    response       Buffer receiving the decrypted response data (without status word).
+ * @param[in,out] responseLength Input: size of @p response; Output: decrypted data length.
+ * @return true if the card answered 0x90 0x00 with a valid MAC, false otherwise.
  */
-void CryptnoxWallet::aes_cbc_encrypt(CW_SecureSession& session, const uint8_t apdu[], uint16_t apduLength, const uint8_t data[], uint16_t dataLength) {
-    uint8_t encryptedData[2 * INPUT_BUFFER_LIMIT] = { 0U };
+bool CryptnoxWallet::transmitSecure(CW_SecureSession& session, uint8_t cla, uint8_t ins, uint8_t p1, uint8_t p2,
+                                    const uint8_t* data, uint16_t dataLength,
+                                    uint8_t* response, uint16_t& responseLength) {
+    bool ret = false;
 
-    /* Set padding ISO/IEC 9797-1 Method 2 algorithm */
-    aesLib.set_paddingmode(paddingMode::Bit);
-    uint16_t encryptedLength = aesLib.encrypt(reinterpret_cast<const byte*>(data), dataLength, encryptedData, session.aesKey, sizeof(session.aesKey), session.iv);
+    if ((response == NULL) || ((data == NULL) && (dataLength > 0U)) || (dataLength > CW_SECURE_MAX_DATA_SIZE)) {
+        serial.println(F("transmitSecure: invalid parameters."));
+    }
+    else {
+        uint8_t macValue[AES_BLOCK_SIZE] = { 0U };
+        uint16_t sendApduLength = buildSecureApdu(session, cla, ins, p1, p2, data, dataLength, scratch.frame.apdu(), macValue);
 
-    uint8_t macApdu[] = { encryptedLength + 16U, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
-    uint16_t macDataLength = apduLength + sizeof(macApdu) + encryptedLength;
-    uint8_t macData[macDataLength];
-    uint16_t offset = 0U;
-    memcpy(macData, apdu, apduLength);
-    offset += apduLength;
-    memcpy(macData + offset, macApdu, sizeof(macApdu));
-    offset += sizeof(macApdu);
-    memcpy(macData + offset, encryptedData, encryptedLength);
-
-    uint8_t macEncryptedData[2 * INPUT_BUFFER_LIMIT] = { 0U };
-    uint8_t macIv[AES_BLOCK_SIZE] = { 0U };
-    /* Set no padding */
-    aesLib.set_paddingmode(paddingMode::Null);
-    uint16_t macEncryptedLength = aesLib.encrypt(reinterpret_cast<byte*>(macData), macDataLength, macEncryptedData, session.macKey, sizeof(session.macKey), macIv);
-
-    uint8_t macValue[AES_BLOCK_SIZE] = { 0U };
-    /* In AES CBC-MAC last block is MAC */
-    uint8_t macOffset = macEncryptedLength - AES_BLOCK_SIZE;
-    memcpy(macValue, macEncryptedData + macOffset, AES_BLOCK_SIZE);
-
-    uint8_t lengthValue[] = { encryptedLength + 16U };
-    uint16_t sendApduLength = apduLength + sizeof(lengthValue) + sizeof(macValue) + encryptedLength;
-
-    uint8_t sendApdu[sendApduLength];
-    offset = 0U;
-    memcpy(sendApdu, apdu, apduLength);
-    offset += apduLength;
-    memcpy(sendApdu + offset, lengthValue, sizeof(lengthValue));
-    offset += sizeof(lengthValue);
-    memcpy(sendApdu + offset, macValue, sizeof(macValue));
-    offset += sizeof(macValue);
-    memcpy(sendApdu + offset, encryptedData, encryptedLength);
-
-    serial.println("Apdu: ");
-    for (uint8_t i = 0; i < sizeof(sendApdu); i++) {
-        serial.print(sendApdu[i], HEX);
-        serial.print(" ");
+        printApdu(scratch.frame.apdu(), sendApduLength);
+
+        /* Send APDU */
+        uint8_t* cardResponse = scratch.response;
+        uint16_t cardResponseLength = sizeof(scratch.response);
+        if (driver.sendAPDUFrame(scratch.frame.apdu(), sendApduLength, cardResponse, cardResponseLength)) {
+            if (checkStatusWord(cardResponse, cardResponseLength, 0x90, 0x00)) {
+                uint16_t plainLength = 0U;
+
+                if (aes_cbc_decrypt(session, cardResponse, cardResponseLength, macValue, &plainLength)) {
+                    if (plainLength <= responseLength) {
+                        memcpy(response, cardResponse, plainLength);
+                        responseLength = plainLength;
+                        ret = true;
+                    } else {
+                        serial.println(F("Response buffer too small."));
+                    }
+                }
+            } else {
+                serial.println(F("APDU SW1/SW2 not expected. Error."));
+            }
+        } else {
+            serial.println(F("APDU exchange failed."));
+        }
+
+        /* Secure cleanup */
+        memset(scratch.frame.apdu(), 0U, sendApduLength);
+        memset(scratch.response, 0U, sizeof(scratch.response));
     }
-    serial.println();
 
-    /* Send APDU */
-    uint8_t response[255U] = { 0U };
-    uint8_t responseLength = sizeof(response);
-    if (driver.sendAPDU(sendApdu, sizeof(sendApdu), response, responseLength)) {
-        if (checkStatusWord(response, responseLength, 0x90, 0x00)) {
-            serial.println(F("getCardInfo success."));
+    return ret;
+}
 
-            /* Rolling IVs: It is the last MAC, ie the first AES_BLOCK_SIZE bytes from the last answer */
-            memcpy(session.iv, response, CW_IV_SIZE);
+/**
+ * @brief Builds a secure-messaging command APDU: CLA INS P1 P2 Lc || MAC || ciphertext.
+ *
+ * Encrypts @p data with Kenc and the rolling IV straight into the APDU frame and
+ * MACs the command with Kmac in the same pass (see cw_encryptThenMac()).
+ * Parameters are not validated; see transmitSecure().
+ *
+ * @param[in,out] session    Session holding the keys; its IV advances with the encryption.
+ * @param[in]     cla        Class byte.
+ * @param[in]     ins        Instruction byte.
+ * @param[in]     p1         Parameter 1.
+ * @param[in]     p2         Parameter 2.
+ * @param[in]     data       Plaintext command data.
+ * @param[in]     dataLength Plaintext length, at most CW_SECURE_MAX_DATA_SIZE bytes.
+ * @param[out]    apdu       CW_SECURE_MAX_APDU_SIZE buffer receiving the APDU.
+ * @param[out]    macValue   16-byte command MAC, needed to decrypt the response.
+ * @return APDU length in bytes.
+ */
+uint16_t CryptnoxWallet::buildSecureApdu(CW_SecureSession& session, uint8_t cla, uint8_t ins, uint8_t p1, uint8_t p2,
+                                         const uint8_t* data, uint16_t dataLength,
+                                         uint8_t* apdu, uint8_t* macValue) {
+    /* ISO/IEC 9797-1 Method 2 padding always adds at least one byte */
+    uint16_t encryptedLength = (uint16_t)((dataLength + AES_BLOCK_SIZE) & ~(AES_BLOCK_SIZE - 1U));
+
+    apdu[0] = cla;
+    apdu[1] = ins;
+    apdu[2] = p1;
+    apdu[3] = p2;
+    apdu[4] = (uint8_t)(encryptedLength + AES_BLOCK_SIZE);
+
+    /* MAC over CLA INS P1 P2 Lc zero padded to one block || ciphertext, APDU = HEADER || MAC || ciphertext */
+    CW_CbcMacContext mac;
+    cw_cbcMacInit(mac, session.macCipher);
+    cw_cbcMacUpdate(mac, apdu, SECURE_HEADER_IN_BYTES);
+    cw_cbcMacPad(mac);
+
+    /* Encrypt straight into the APDU frame, MACing each block as it is produced */
+    (void)cw_encryptThenMac(session.aesCipher, session.iv, mac, data, dataLength, apdu + SECURE_CIPHERTEXT_OFFSET);
+    cw_cbcMacFinal(mac, macValue);
+    memcpy(apdu + SECURE_HEADER_IN_BYTES, macValue, AES_BLOCK_SIZE);
+
+    return (uint16_t)(SECURE_CIPHERTEXT_OFFSET + encryptedLength);
+}
 
-            serial.println("macValue: ");
-            for (uint8_t i = 0U; i < AES_BLOCK_SIZE; i++) {
-                serial.print(macValue[i], HEX);
-                serial.print(" ");
-            }
-            serial.println();
+/**
+ * @brief Encrypts data using AES-CBC, computes a MAC, and sends the APDU to the smartcard.
+ *
+ * Thin wrapper around `transmitSecure` that prints the decrypted response.
+ *
+ * @param[in,out] session Reference to the secure session containing keys and IV.
+ * @param[in] apdu Pointer to the APDU header bytes (CLA, INS, P1, P2).
+ * @param[in] apduLength Length of the APDU header.
+ * @param[in] data Pointer to the plaintext data to encrypt.
+ * @param[in] dataLength Length of the plaintext data.
+ */
+void CryptnoxWallet::aes_cbc_encrypt(CW_SecureSession& session, const uint8_t apdu[], uint16_t apduLength, const uint8_t data[], uint16_t dataLength) {
+    /* transmitSecure() only uses the frame and response areas, the work area takes the plaintext */
+    uint8_t* response = scratch.work;
+    uint16_t responseLength = CW_SECURE_MAX_DATA_SIZE;
 
-            /* Decode response */
-            aes_cbc_decrypt(session, response, responseLength, macValue);
-        } else {
-            serial.println(F("getCardInfo APDU SW1/SW2 not expected. Error."));
+    if ((apdu == NULL) || (apduLength < 4U)) {
+        serial.println(F("aes_cbc_encrypt: APDU header too short."));
+    }
+    else if (transmitSecure(session, apdu[0], apdu[1], apdu[2], apdu[3], data, dataLength, response, responseLength)) {
+        serial.println("Decoded data: ");
+        for (uint16_t i = 0U; i < responseLength; i++) {
+            serial.print(response[i], HEX);
+            serial.print(" ");
         }
-    } else {
-        serial.println(F("APDU exchange failed."));
+        serial.println();
+        memset(response, 0U, responseLength);
+    }
+    else {
+        /* Error already reported by transmitSecure */
     }
 }
 
 /**
  * @brief Verifies the MAC and decrypts an AES-CBC encrypted APDU response.
  *
- * This function recomputes the MAC, compares it with the received MAC 
- * to ensure integrity and decrypts the response data with last MAC
- * sent as as mac_iv.
+ * Response layout is MAC || ciphertext || SW1 SW2. The MAC is recomputed over
+ * the response length (MAC and ciphertext) zero padded to one block followed by
+ * the ciphertext, and compared with the received one. The ciphertext is then
+ * decrypted with the last MAC sent as IV.
  *
- * @param[in,out] session      Reference to the secure session containing keys and IV.
- * @param[in,out] response     Encrypted APDU response buffer.
- * @param[in]     response_len Length of the response buffer.
- * @param[out]    mac_value    MAC from last sent message.
+ * @param[in,out] session      Reference to the secure session; `session.iv` is rolled
+ *                             to the received MAC when verification succeeds.
+ * @param[in,out] response     Encrypted APDU response buffer. On success the plaintext
+ *                             is moved to the start of the buffer.
+ * @param[in]     response_len Length of the response buffer, status word included.
+ * @param[in]     mac_value    MAC from last sent message.
+ * @param[out]    plainLength  Optional plaintext length (may be nullptr).
  * @return true if MAC verification succeeds, false otherwise.
  */
-bool CryptnoxWallet::aes_cbc_decrypt(CW_SecureSession& session, uint8_t *response, size_t response_len, uint8_t * mac_value) {
+bool CryptnoxWallet::aes_cbc_decrypt(CW_SecureSession& session, uint8_t *response, size_t response_len, uint8_t * mac_value, uint16_t* plainLength) {
+    bool ret = false;
 
     /* Response = MAC || cipherText || SW1/2 */
-    uint8_t rep_mac[AES_BLOCK_SIZE];
-    memcpy(rep_mac, response, AES_BLOCK_SIZE);
-    uint8_t *rep_data = response + 16U;
-    size_t cipherTextLen = response_len - 2U; /* Remove SW1/SW2 */
-    if (mac_value == NULL) {
-        return false;
-    }
-
-    /* Compute the MAC and compare it against received one */
-    /* sizeof packet (cipherTextLen) || zero padding 15 * 0 || rep_data */
-    uint8_t mac_datar[32U] = { 0U };
-    mac_datar[0] = (cipherTextLen & 0xFF);
-    memcpy(mac_datar + 16U, rep_data, AES_BLOCK_SIZE);
-
-    uint8_t macEncryptedData[2 * INPUT_BUFFER_LIMIT] = { 0U };
-    uint8_t mac_iv[AES_BLOCK_SIZE] = { 0U }; /* Default MAC IVs */
-    /* Set no padding */
-    aesLib.set_paddingmode(paddingMode::Null);
-    uint16_t macEncryptedLength = aesLib.encrypt(reinterpret_cast<byte*>(mac_datar), cipherTextLen, macEncryptedData, session.macKey, sizeof(session.macKey), mac_iv);
-
-    uint8_t recomputedMacValue[AES_BLOCK_SIZE] = { 0U };
-    /* In AES CBC-MAC last block is MAC */
-    uint8_t macOffset = macEncryptedLength - AES_BLOCK_SIZE;
-    memcpy(recomputedMacValue, macEncryptedData + macOffset, AES_BLOCK_SIZE);
-
-    /* Compare received MAC with computed MAC */
-    if (memcmp(rep_mac, recomputedMacValue, AES_BLOCK_SIZE) == 0U) {
-        serial.println(F("MACs match"));
-    } else {
-        serial.println(F("MAC mismatch"));
-        return false;
+    if ((response == NULL) || (mac_value == NULL) ||
+        (response_len < (RESPONSE_STATUS_WORDS_IN_BYTES + AES_BLOCK_SIZE)) ||
+        (response_len > (RESPONSE_STATUS_WORDS_IN_BYTES + AES_BLOCK_SIZE + SECURE_MAX_CIPHERTEXT_IN_BYTES)) ||
+        (((response_len - RESPONSE_STATUS_WORDS_IN_BYTES) % AES_BLOCK_SIZE) != 0U)) {
+        serial.println(F("Unexpected secure response size."));
     }
+    else {
+        uint8_t rep_mac[AES_BLOCK_SIZE];
+        uint8_t *rep_data = response + AES_BLOCK_SIZE;
+        uint16_t macAndCipherLen = (uint16_t)(response_len - RESPONSE_STATUS_WORDS_IN_BYTES); /* Remove SW1/SW2 */
+        uint16_t cipherTextLen = macAndCipherLen - AES_BLOCK_SIZE;
+        memcpy(rep_mac, response, AES_BLOCK_SIZE);
+
+        /* Compute the MAC and compare it against received one */
+        /* sizeof packet (MAC || cipherText) || zero padding 15 * 0 || rep_data */
+        uint8_t lengthBlock = (uint8_t)(macAndCipherLen & 0xFFU);
+        uint8_t recomputedMacValue[AES_BLOCK_SIZE] = { 0U };
+        CW_CbcMacContext mac;
+        cw_cbcMacInit(mac, session.macCipher);
+        cw_cbcMacUpdate(mac, &lengthBlock, 1U);
+        cw_cbcMacPad(mac);
+        cw_cbcMacUpdate(mac, rep_data, cipherTextLen);
+        cw_cbcMacFinal(mac, recomputedMacValue);
+
+        /* Compare received MAC with computed MAC */
+        if (memcmp(rep_mac, recomputedMacValue, AES_BLOCK_SIZE) == 0) {
+            serial.println(F("MACs match"));
+
+            /* Decode the payload using the AES key and IVs corresponding to the last MAC received by the smartcard */
+            uint8_t decryptIv[AES_BLOCK_SIZE];
+            memcpy(decryptIv, mac_value, AES_BLOCK_SIZE);
+            uint16_t decryptedDataLength = cw_decryptPadded(session.aesCipher, rep_data, cipherTextLen, decryptIv);
+            memmove(response, rep_data, decryptedDataLength);
+            if (plainLength != NULL) {
+                *plainLength = decryptedDataLength;
+            }
 
-    /* Decrypt */
-    uint8_t decryptedData[2 * INPUT_BUFFER_LIMIT] = { 0U };
-    /* Set padding ISO/IEC 9797-1 Method 2 algorithm */
-    aesLib.set_paddingmode(paddingMode::Bit);
-    /* Decode the payload using the AES key and IVs corresponding to the last MAC received by the smartcard */
-    uint16_t decryptedDataLength = aesLib.decrypt(rep_data, AES_BLOCK_SIZE, decryptedData, session.aesKey, sizeof(session.aesKey), mac_value);
-
-    serial.println("Decoded data: ");
-    for (uint8_t i = 0; i < decryptedDataLength; i++) {
-        serial.print(decryptedData[i], HEX);
-        serial.print(" ");
+            /* Rolling IVs: It is the last MAC, ie the first AES_BLOCK_SIZE bytes from the last answer */
+            memcpy(session.iv, rep_mac, CW_IV_SIZE);
+            ret = true;
+        } else {
+            serial.println(F("MAC mismatch"));
+        }
     }
-    serial.println();
 
-    return true;
-}
\ No newline at end of file
+    return ret;
+}
@@ -9,6 +9,8 @@
 #include "NFCDriver.h"
 #include "SerialDriver.h"
 #include "uECC.h"
+#include "AESLib.h"
+#include <SHA512.h>
 
 /******************************************************************
  * 2. Constants / define declarations
@@ -17,6 +19,21 @@
 #define CW_AESKEY_SIZE    (32U)  /**< AES-256 session encryption key size in bytes */
 #define CW_MACKEY_SIZE    (32U)  /**< AES-256 session MAC key size in bytes */
 #define CW_IV_SIZE        (16U)  /**< AES-CBC IV size in bytes */
+#define CW_SECURE_MAX_DATA_SIZE (223U)  /**< Largest secure-messaging payload: header, MAC and padded ciphertext fit one PN532 data exchange */
+#define CW_SECURE_MAX_APDU_SIZE (5U + CW_IV_SIZE + CW_SECURE_MAX_DATA_SIZE + 1U)  /**< Largest secure-messaging command APDU: header, MAC and padded ciphertext */
+#define CW_SCRATCH_WORK_SIZE (CW_SECURE_MAX_DATA_SIZE) /**< Work area: largest decrypted secure response or the card certificate */
+#define CW_TAP_RESPONSE_TIMEOUT_MS (1000U) /**< Card response timeout of a poll-driven tap, in milliseconds */
+#define CW_PRIVATEKEY_SIZE (32U)  /**< secp256r1 private key size in bytes */
+#define CW_PUBLICKEY_SIZE  (64U)  /**< secp256r1 uncompressed public key size in bytes (without 0x04 prefix) */
+#define CW_SHAREDSECRET_SIZE (32U) /**< secp256r1 ECDH shared secret size in bytes */
+
+#ifndef CW_RESPONSE_BUFFER_SIZE
+#define CW_RESPONSE_BUFFER_SIZE (255U) /**< Largest card response accepted, status word included; raise it for chained responses longer than one PN532 frame */
+#endif
+
+#ifndef CW_KEYPOOL_SIZE
+#define CW_KEYPOOL_SIZE    (2U)   /**< Number of pre-generated ephemeral keypairs kept ready for the secure channel */
+#endif
 
 /******************************************************************
  * 3. Typedefs / enum / structs
@@ -29,24 +46,163 @@
  * This struct encapsulates all session-specific cryptographic material,
  * allowing functions to be reentrant by passing session state as a parameter
  * rather than storing it as class member variables.
+ *
+ * The AES-256 key schedules for Kenc and Kmac are expanded once by setKeys()
+ * and reused by every secure-messaging call of the session.
  */
 struct CW_SecureSession {
     uint8_t aesKey[CW_AESKEY_SIZE];  /**< AES-256 session encryption key (Kenc) */
     uint8_t macKey[CW_MACKEY_SIZE];  /**< AES-256 session MAC key (Kmac) */
     uint8_t iv[CW_IV_SIZE];          /**< Current AES-CBC IV (rolling IV for secure messaging) */
+    AES aesCipher;                   /**< Expanded key schedule of aesKey */
+    AES macCipher;                   /**< Expanded key schedule of macKey */
 
     /** @brief Initialize all session keys and IV to zero. */
     CW_SecureSession() {
-        memset(aesKey, 0U, sizeof(aesKey));
-        memset(macKey, 0U, sizeof(macKey));
-        memset(iv, 0U, sizeof(iv));
+        clear();
     }
 
-    /** @brief Securely clear all session keys and IV. */
+    /**
+     * @brief Install the session keys and expand their AES-256 key schedules.
+     * @param[in] encKey 32-byte session encryption key (Kenc).
+     * @param[in] authKey 32-byte session MAC key (Kmac).
+     */
+    void setKeys(const uint8_t* encKey, const uint8_t* authKey) {
+        memcpy(aesKey, encKey, sizeof(aesKey));
+        memcpy(macKey, authKey, sizeof(macKey));
+        (void)aesCipher.set_key(aesKey, sizeof(aesKey));
+        (void)macCipher.set_key(macKey, sizeof(macKey));
+    }
+
+    /** @brief Securely clear all session keys, key schedules and IV. */
     void clear() {
         memset(aesKey, 0U, sizeof(aesKey));
         memset(macKey, 0U, sizeof(macKey));
         memset(iv, 0U, sizeof(iv));
+        aesCipher.clean();
+        macCipher.clean();
+    }
+};
+
+/**
+ * @struct CW_EphemeralKeyPair
+ * @brief Pre-generated secp256r1 keypair waiting to be used by one secure channel.
+ *
+ * A slot is filled by CryptnoxWallet::refillKeyPool() and wiped as soon as
+ * openSecureChannel() takes its keys, so a keypair is never used twice.
+ */
+struct CW_EphemeralKeyPair {
+    uint8_t publicKey[CW_PUBLICKEY_SIZE];   /**< Uncompressed public key (X || Y) */
+    uint8_t privateKey[CW_PRIVATEKEY_SIZE]; /**< Private scalar */
+    bool ready;                             /**< true if the slot holds an unused keypair */
+};
+
+/**
+ * @struct CW_ScratchArena
+ * @brief Working buffers shared by every card exchange of one CryptnoxWallet.
+ *
+ * Each handshake phase and each secure command borrows the arena for one
+ * exchange, from building the command to consuming the response, and the
+ * phases never overlap on the same wallet. This replaces the per-function
+ * command, response and crypto buffers that used to sit on the stack at the
+ * same time.
+ *
+ * Lifetimes:
+ * - @ref frame: command being built and sent, with transport room around it
+ *   so the reader driver frames it in place; free once the response is read.
+ * - @ref response: raw card response; free once its data is consumed.
+ * - @ref work: decrypted secure response until it is consumed; also holds
+ *   the certificate between GET CARD CERTIFICATE and key extraction.
+ *
+ * MACs are computed incrementally straight from @ref frame and @ref response,
+ * so no MAC input buffer is needed.
+ *
+ * The arena is static RAM held by every wallet, card present or not, while
+ * the buffers it replaced were only on the stack during a handshake: it
+ * adds about 740 bytes to CryptnoxWallet. Static RAM plus peak stack is
+ * lower than before for processCard(), where the secure session is only
+ * created once the ECDH is over, and slightly higher for a poll-driven tap.
+ * tests/host/bench_stack and the AVR SRAM report in CI
+ * (tests/avr/stack_report) print both together for each way to run the
+ * handshake.
+ */
+struct CW_ScratchArena {
+    NFCApduFrame<CW_SECURE_MAX_APDU_SIZE> frame; /**< Outgoing command */
+    uint8_t response[CW_RESPONSE_BUFFER_SIZE];  /**< Incoming response */
+    uint8_t work[CW_SCRATCH_WORK_SIZE];         /**< Plaintext and certificate */
+
+    /** @brief Securely clear the whole arena. */
+    void clear() {
+        memset(frame.bytes, 0U, sizeof(frame.bytes));
+        memset(response, 0U, sizeof(response));
+        memset(work, 0U, sizeof(work));
+    }
+};
+
+/**
+ * @brief Overall state of a poll-driven tap (see CryptnoxWallet::poll()).
+ */
+enum class CW_TapStatus : uint8_t {
+    IDLE,    /* No tap started. */
+    BUSY,    /* Tap in progress, keep calling poll(). */
+    DONE,    /* Secure channel opened and PIN verified. */
+    FAILED   /* Tap aborted; see the debug output for the reason. */
+};
+
+/**
+ * @brief Step of a poll-driven tap, one per card command.
+ */
+enum class CW_TapStep : uint8_t {
+    DETECT,                /* Waiting for an ISO-DEP card in the field. */
+    SELECT,                /* SELECT the Cryptnox application. */
+    CARD_CERTIFICATE,      /* GET CARD CERTIFICATE (card ephemeral key). */
+    OPEN_SECURE_CHANNEL,   /* OPEN SECURE CHANNEL, ECDH computed while waiting. */
+    MUTUALLY_AUTHENTICATE, /* MUTUALLY AUTHENTICATE (initial IV). */
+    VERIFY_PIN             /* VERIFY PIN through secure messaging. */
+};
+
+/**
+ * @struct CW_TapContext
+ * @brief State of one poll-driven tap, kept between CryptnoxWallet::poll() calls.
+ *
+ * Owned by the caller, like CW_SecureSession, so several readers can be
+ * driven from the same loop(). It must outlive the tap. The command and
+ * response in flight live in the wallet's CW_ScratchArena.
+ */
+struct CW_TapContext {
+    CW_TapStatus status;                        /**< Overall tap state */
+    CW_TapStep step;                            /**< Command in progress */
+    bool awaitingResponse;                      /**< true once the command of @ref step is sent */
+    bool sharedSecretReady;                     /**< true once ECDH ran for OPEN SECURE CHANNEL */
+    uint32_t startedAt;                         /**< millis() when the current command was sent */
+    CW_SecureSession session;                   /**< Secure channel of this tap */
+    uint8_t cardEphemeralPubKey[CW_PUBLICKEY_SIZE]; /**< Card ephemeral key from the certificate */
+    uint8_t clientPrivateKey[CW_PRIVATEKEY_SIZE];   /**< Client ephemeral private key, wiped after ECDH */
+    uint8_t sharedSecret[CW_SHAREDSECRET_SIZE];     /**< ECDH shared secret until the salt arrives */
+    uint8_t macValue[CW_IV_SIZE];               /**< MAC of the last secure command (response IV) */
+
+    /** @brief Start in the IDLE state with all secrets cleared. */
+    CW_TapContext() {
+        clear();
+    }
+
+    /** @brief Result of the tap, valid once poll() stopped returning BUSY. */
+    CW_TapStatus result() const {
+        return status;
+    }
+
+    /** @brief Securely clear all secrets and return to IDLE. */
+    void clear() {
+        status = CW_TapStatus::IDLE;
+        step = CW_TapStep::DETECT;
+        awaitingResponse = false;
+        sharedSecretReady = false;
+        startedAt = 0U;
+        session.clear();
+        memset(cardEphemeralPubKey, 0U, sizeof(cardEphemeralPubKey));
+        memset(clientPrivateKey, 0U, sizeof(clientPrivateKey));
+        memset(sharedSecret, 0U, sizeof(sharedSecret));
+        memset(macValue, 0U, sizeof(macValue));
     }
 };
 
@@ -74,7 +230,7 @@ public:
      * @param driver Reference to an NFCDriver implementation for NFC communication.
      * @param serial Reference to a SerialDriver implementation for debug output.
      */
-    CryptnoxWallet(NFCDriver& driver, SerialDriver& serial) : driver(driver), serial(serial) {}
+    CryptnoxWallet(NFCDriver& driver, SerialDriver& serial) : driver(driver), serial(serial), keyPool(), scratch() {}
 
     /**
      * @brief Initialize the PN532 module via the underlying driver.
@@ -97,6 +253,45 @@ public:
      */
     bool processCard();
 
+    /**
+     * @brief Start a non-blocking tap: detect a card, open the secure channel and verify the PIN.
+     *
+     * Same card dialogue as processCard(), driven by poll() instead of blocking.
+     *
+     * @param[out] tap Tap context, reset and set BUSY.
+     */
+    void beginTap(CW_TapContext& tap);
+
+    /**
+     * @brief Advance a tap started with beginTap() by one bounded slice of work.
+     *
+     * Each call either sends one command, computes one crypto step, or checks
+     * whether the reader has an answer, and returns without waiting for the card.
+     * Call it from loop() until it stops returning CW_TapStatus::BUSY.
+     *
+     * @param[in,out] tap Tap context.
+     * @return Tap status after this slice.
+     */
+    CW_TapStatus poll(CW_TapContext& tap);
+
+    /**
+     * @brief Pre-generate one ephemeral secp256r1 keypair for a future secure channel.
+     *
+     * Meant to be called from idle time (e.g. in loop() between two card polls)
+     * so that openSecureChannel() does not pay for key generation while the card
+     * is in the field. At most one keypair is generated per call.
+     *
+     * @return true if a keypair was generated, false if the pool is already full or generation failed.
+     */
+    bool refillKeyPool();
+
+    /**
+     * @brief Number of unused keypairs currently available in the pool.
+     *
+     * @return Count of ready keypairs, between 0 and CW_KEYPOOL_SIZE.
+     */
+    uint8_t keyPoolCount() const;
+
     /**
      * @brief Send the SELECT APDU to select the wallet application.
      *
@@ -140,6 +335,8 @@ public:
     *
     * This function sends the APDU command to the card to get the session salt, which is
     * required for the subsequent key derivation in the secure channel setup.
+    * The client keypair is taken from the pre-generated pool when one is available,
+    * otherwise it is generated on the spot.
     *
     * @param[out] salt Pointer to a 32-byte buffer where the card-provided salt will be stored.
     * @return true if the APDU exchange succeeded and the salt was retrieved, false otherwise.
@@ -148,6 +345,45 @@ public:
 
     bool mutuallyAuthenticate(CW_SecureSession& session, const uint8_t* salt, uint8_t* clientPublicKey, uint8_t* clientPrivateKey, const uECC_Curve_t* sessionCurve, uint8_t* cardEphemeralPubKey);
 
+    /**
+    * @brief Opens the secure channel and mutually authenticates in one pipelined step.
+    *
+    * Same APDUs as openSecureChannel() followed by mutuallyAuthenticate(), but the
+    * ECDH shared secret is computed while the reader waits for the card's
+    * OPEN SECURE CHANNEL answer (see NFCDriver::startAPDU()).
+    *
+    * @param[in,out] session             Session receiving the keys and initial IV.
+    * @param[in]     cardEphemeralPubKey 64-byte card ephemeral public key (X || Y).
+    * @param[in]     sessionCurve        ECC curve (e.g., uECC_secp256r1()).
+    * @return true if the secure channel is open and authenticated, false otherwise.
+    */
+    bool establishSecureChannel(CW_SecureSession& session, const uint8_t* cardEphemeralPubKey, const uECC_Curve_t* sessionCurve);
+
+    /**
+    * @brief Select the handshake used by processCard().
+    *
+    * @param[in] enable true to use establishSecureChannel(), false for the sequential
+    *                   openSecureChannel() / mutuallyAuthenticate() pair (default).
+    */
+    void setPipelinedHandshake(bool enable) {
+        pipelinedHandshake = enable;
+    }
+
+    /**
+    * @brief Keep the card activated between operations instead of resetting the reader.
+    *
+    * When enabled, a successful operation ends by putting the card to sleep
+    * with the reader still knowing it (NFCDriver::holdTarget()). The next
+    * processCard() or tap wakes that card directly (NFCDriver::reselectTarget()),
+    * skipping target detection. If the card is gone, the reader is reset and a
+    * normal detection follows.
+    *
+    * @param[in] enable true to keep the target, false to reset the reader after every operation (default).
+    */
+    void setKeepTarget(bool enable) {
+        keepTarget = enable;
+    }
+
     /**
     * @brief Extracts the card's ephemeral EC P-256 public key from the certificate.
     *
@@ -165,7 +401,7 @@ public:
     * @param length Number of bytes in the APDU.
     * @param label Optional label for printing (default: "APDU to send").
     */
-    void printApdu(const uint8_t* apdu, uint8_t length, const char* label = "APDU to send");
+    void printApdu(const uint8_t* apdu, uint16_t length, const char* label = "APDU to send");
 
     /**
     * @brief Checks the status word (SW1/SW2) at the end of an APDU response.
@@ -176,7 +412,7 @@ public:
     * @param sw2Expected     Expected value for SW2 (e.g., 0x00).
     * @return true if the last two bytes match SW1/SW2, false otherwise.
     */
-    bool checkStatusWord(const uint8_t* response, uint8_t responseLength, uint8_t sw1Expected, uint8_t sw2Expected);
+    bool checkStatusWord(const uint8_t* response, uint16_t responseLength, uint8_t sw1Expected, uint8_t sw2Expected);
 
     /**
     * @brief Sends a secured GET CARD INFO APDU.
@@ -187,12 +423,37 @@ public:
     /**
     * @brief Verifies the PIN code.
     * @param[in,out] session Reference to the secure session containing keys and IV.
+    * @return true if the card accepted the PIN, false otherwise.
     */
-    void verifyPin(CW_SecureSession& session);
+    bool verifyPin(CW_SecureSession& session);
+
+    /**
+    * @brief Sends one command through the secure channel and returns the decrypted answer.
+    *
+    * Encrypts and MACs the command data, sends the APDU, verifies the response MAC,
+    * decrypts the response into @p response and rolls `session.iv`. Any number of
+    * commands can be sent after a single mutuallyAuthenticate().
+    *
+    * @param[in,out] session        Reference to the secure session containing keys and IV.
+    * @param[in]     cla            Class byte.
+    * @param[in]     ins            Instruction byte.
+    * @param[in]     p1             Parameter 1.
+    * @param[in]     p2             Parameter 2.
+    * @param[in]     data           Plaintext command data (may be NULL if dataLength is 0).
+    * @param[in]     dataLength     Plaintext length, at most CW_SECURE_MAX_DATA_SIZE bytes.
+    * @param[out]    response       Buffer receiving the decrypted response data (without status word).
+    * @param[in,out] responseLength Input: size of @p response; Output: decrypted data length.
+    * @return true if the card answered 0x90 0x00 with a valid MAC, false otherwise.
+    */
+    bool transmitSecure(CW_SecureSession& session, uint8_t cla, uint8_t ins, uint8_t p1, uint8_t p2,
+                        const uint8_t* data, uint16_t dataLength,
+                        uint8_t* response, uint16_t& responseLength);
 
     /**
     * @brief Encrypts data and sends a secured APDU using AES-CBC and MAC.
     *
+    * Wrapper around transmitSecure() that prints the decrypted response.
+    *
     * @param[in,out] session    Reference to the secure session containing keys and IV.
     * @param[in] apdu           APDU header (CLA, INS, P1, P2).
     * @param[in] apduLength     Length of the APDU header.
@@ -204,17 +465,154 @@ public:
     /**
     * @brief Decrypts data from a secured APDU using AES-CBC and verifies the MAC.
     *
-    * @param[in,out] session      Reference to the secure session containing keys and IV.
-    * @param[in,out] response     Encrypted APDU response buffer (decrypted in place).
-    * @param[in]     response_len Length of the response buffer.
-    * @param[out]    mac_value    Computed MAC value.
+    * @param[in,out] session      Reference to the secure session; IV is rolled on success.
+    * @param[in,out] response     Encrypted APDU response buffer (decrypted in place, plaintext moved to the start).
+    * @param[in]     response_len Length of the response buffer, status word included.
+    * @param[in]     mac_value    MAC of the last command sent (decryption IV).
+    * @param[out]    plainLength  Optional decrypted data length (may be nullptr).
     * @return true if MAC verification succeeds, false otherwise.
     */
-    bool aes_cbc_decrypt(CW_SecureSession& session, uint8_t *response, size_t response_len, uint8_t * mac_value);
+    bool aes_cbc_decrypt(CW_SecureSession& session, uint8_t *response, size_t response_len, uint8_t * mac_value, uint16_t* plainLength = nullptr);
 
 private:
     NFCDriver& driver; /**< PN532 driver for low-level NFC operations */
     SerialDriver& serial; /**< Serial driver for debug output */
+    CW_EphemeralKeyPair keyPool[CW_KEYPOOL_SIZE]; /**< Pre-generated secure channel keypairs */
+    bool pipelinedHandshake = false; /**< processCard() overlaps ECDH with OPEN SECURE CHANNEL */
+    bool keepTarget = false; /**< Hold the card between operations, see setKeepTarget() */
+    bool targetHeld = false; /**< The driver holds the card of the last operation */
+    CW_ScratchArena scratch; /**< Buffers shared by all card exchanges, see CW_ScratchArena */
+
+    /**
+     * @brief Take an unused keypair out of the pool and wipe its slot.
+     * @param[out] publicKey 64-byte buffer receiving the public key.
+     * @param[out] privateKey 32-byte buffer receiving the private key.
+     * @param[in] curve Curve requested by the caller; only secp256r1 keys are pooled.
+     * @return true if a pooled keypair was returned, false if the caller must generate one.
+     */
+    bool takePooledKey(uint8_t* publicKey, uint8_t* privateKey, const uECC_Curve_t* curve);
+
+    /**
+     * @brief Take a keypair from the pool, or generate one if the pool is empty.
+     * @param[out] publicKey 64-byte buffer receiving the public key.
+     * @param[out] privateKey 32-byte buffer receiving the private key.
+     * @param[in] curve ECC curve of the keypair.
+     * @return true if a keypair is available, false if key generation failed.
+     */
+    bool acquireSessionKeyPair(uint8_t* publicKey, uint8_t* privateKey, const uECC_Curve_t* curve);
+
+    /**
+     * @brief Send OPEN SECURE CHANNEL and compute the ECDH shared secret while the card answers.
+     * @param[out] sharedSecret 32-byte buffer receiving the ECDH shared secret.
+     * @param[out] salt 32-byte buffer receiving the card salt.
+     * @param[in] cardEphemeralPubKey 64-byte card ephemeral public key (X || Y).
+     * @param[in] sessionCurve ECC curve of both keys.
+     * @return true if both the shared secret and the salt are available.
+     */
+    bool openSecureChannelPipelined(uint8_t* sharedSecret, uint8_t* salt, const uint8_t* cardEphemeralPubKey, const uECC_Curve_t* sessionCurve);
+
+    /**
+     * @brief Send OPEN SECURE CHANNEL, then compute the ECDH shared secret.
+     * @param[out] sharedSecret 32-byte buffer receiving the ECDH shared secret.
+     * @param[out] salt 32-byte buffer receiving the card salt.
+     * @param[in] cardEphemeralPubKey 64-byte card ephemeral public key (X || Y).
+     * @param[in] sessionCurve ECC curve of both keys.
+     * @return true if both the salt and the shared secret are available.
+     */
+    bool openSecureChannelSequential(uint8_t* sharedSecret, uint8_t* salt, const uint8_t* cardEphemeralPubKey, const uECC_Curve_t* sessionCurve);
+
+    /**
+     * @brief Derive the session keys, mutually authenticate and verify the PIN.
+     *
+     * Holds the secure session of processCard() on its own stack frame, so the
+     * session only exists once the ECDH is over.
+     *
+     * @param[in] sharedSecret 32-byte ECDH shared secret.
+     * @param[in] salt 32-byte salt returned by OPEN SECURE CHANNEL.
+     * @return true if the card accepted the authentication and the PIN.
+     */
+    bool authenticateAndVerifyPin(const uint8_t* sharedSecret, const uint8_t* salt);
+
+    /**
+     * @brief Validate an OPEN SECURE CHANNEL response and copy out the salt.
+     * @param[in] response Raw response, status word included.
+     * @param[in] responseLength Response length in bytes.
+     * @param[out] salt 32-byte buffer receiving the salt.
+     * @return true if the response is valid, false otherwise.
+     */
+    bool readOpenSecureChannelSalt(const uint8_t* response, uint16_t responseLength, uint8_t* salt);
+
+    /**
+     * @brief Send MUTUALLY AUTHENTICATE with the keys already installed in @p session.
+     * @param[in,out] session Session holding Kenc/Kmac; its IV is set on success.
+     * @return true if the card accepted the authentication, false otherwise.
+     */
+    bool sendMutualAuthentication(CW_SecureSession& session);
+
+    /**
+     * @brief Build the MUTUALLY AUTHENTICATE APDU with the keys installed in @p session.
+     * @param[in] session Session holding Kenc/Kmac.
+     * @param[out] apdu Buffer receiving the APDU (69 bytes).
+     * @return APDU length in bytes, 0 on failure.
+     */
+    uint8_t buildMutualAuthenticationApdu(CW_SecureSession& session, uint8_t* apdu);
+
+    /**
+     * @brief Validate the MUTUALLY AUTHENTICATE response and set the initial IV.
+     * @param[in,out] session Session whose IV is set on success.
+     * @param[in] response Raw response, status word included.
+     * @param[in] responseLength Response length in bytes.
+     * @return true if the card accepted the authentication, false otherwise.
+     */
+    bool readMutualAuthenticationResponse(CW_SecureSession& session, const uint8_t* response, uint16_t responseLength);
+
+    /**
+     * @brief Build a secure-messaging command APDU (header, MAC and ciphertext).
+     * @param[in,out] session Session holding the keys; its IV advances.
+     * @param[in] cla Class byte.
+     * @param[in] ins Instruction byte.
+     * @param[in] p1 Parameter 1.
+     * @param[in] p2 Parameter 2.
+     * @param[in] data Plaintext command data.
+     * @param[in] dataLength Plaintext length, at most CW_SECURE_MAX_DATA_SIZE bytes.
+     * @param[out] apdu CW_SECURE_MAX_APDU_SIZE buffer receiving the APDU.
+     * @param[out] macValue 16-byte command MAC.
+     * @return APDU length in bytes.
+     */
+    uint16_t buildSecureApdu(CW_SecureSession& session, uint8_t cla, uint8_t ins, uint8_t p1, uint8_t p2,
+                             const uint8_t* data, uint16_t dataLength,
+                             uint8_t* apdu, uint8_t* macValue);
+
+    /**
+     * @brief Send the command of the current tap step.
+     * @param[in,out] tap Tap context.
+     * @return true if the command was handed to the reader, false otherwise.
+     */
+    bool startTapStep(CW_TapContext& tap);
+
+    /**
+     * @brief Collect and check the answer of the current tap step, then move to the next one.
+     * @param[in,out] tap Tap context.
+     * @return true if the step succeeded, false otherwise.
+     */
+    bool finishTapStep(CW_TapContext& tap);
+
+    /**
+     * @brief Close a tap: wipe its secrets, reset the reader and record the result.
+     * @param[in,out] tap Tap context.
+     * @param[in] status Final status (DONE or FAILED).
+     */
+    void endTap(CW_TapContext& tap, CW_TapStatus status);
+
+    /**
+     * @brief Wake the card held after the previous operation, if any.
+     *
+     * If no card is held the call does nothing. If the held card is gone the
+     * reader is reset, ready for a new detection.
+     *
+     * @return true if the held card answered, false if a detection is needed.
+     */
+    bool reselectHeldTarget();
 
     /**
      * @brief RNG callback for micro-ecc library.
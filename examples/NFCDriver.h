@@ -2,17 +2,238 @@
 #define NFCDRIVER_H
 #include <Arduino.h>
 
+/* Transport space reserved around an APDU held in an NFCApduFrame. Large
+   enough for the PN532 frame header, InDataExchange and Tg before the APDU
+   and for the frame checksum and postamble after it. */
+#define NFC_FRAME_HEADROOM (16U)
+#define NFC_FRAME_TAILROOM (4U)
+
+/* ISO 7816-4 APDU limits used by the chaining helpers */
+#define NFC_APDU_HEADER_SIZE     (4U)     /* CLA INS P1 P2 */
+#define NFC_SHORT_APDU_MAX_LC    (255U)   /* Largest Lc of a short APDU */
+#define NFC_CLA_CHAINING         (0x10U)  /* CLA bit: more commands of the chain follow */
+
+/* One APDU buffer with headroom and tailroom, so that each layer below the
+   wallet writes its header, trailer and checksum in place around the APDU
+   and a single buffer goes to the bus. See NFCDriver::sendAPDUFrame(). */
+template <uint16_t Capacity>
+struct NFCApduFrame {
+    uint8_t bytes[NFC_FRAME_HEADROOM + Capacity + NFC_FRAME_TAILROOM];
+
+    uint8_t* apdu() {
+        return bytes + NFC_FRAME_HEADROOM;
+    }
+    static constexpr uint16_t capacity() {
+        return Capacity;
+    }
+};
+
 class NFCDriver {
 public:
     virtual bool begin() = 0;
     virtual bool inListPassiveTarget() = 0;
+
+    /* responseLen is the size of response on input and the length of the
+       whole response on output, which may have been chained over several
+       reader frames. */
     virtual bool sendAPDU(const uint8_t* apdu, uint16_t apduLen,
-                          uint8_t* response, uint8_t& responseLen) = 0;
+                          uint8_t* response, uint16_t& responseLen) = 0;
+
+    /* Split APDU exchange: startAPDU() hands the command to the reader and
+       returns, finishAPDU() collects the answer. The caller may compute in
+       between and must keep the APDU buffer alive until finishAPDU().
+       The default implementation simply defers to the blocking sendAPDU(). */
+    virtual bool startAPDU(const uint8_t* apdu, uint16_t apduLen) {
+        pendingApdu = apdu;
+        pendingApduLen = apduLen;
+        return (apdu != nullptr);
+    }
+    virtual bool finishAPDU(uint8_t* response, uint16_t& responseLen) {
+        bool ret = false;
+        if (pendingApdu != nullptr) {
+            ret = sendAPDU(pendingApdu, pendingApduLen, response, responseLen);
+            pendingApdu = nullptr;
+        }
+        return ret;
+    }
+
+    /* Zero-copy variants of sendAPDU()/startAPDU(): apdu points into an
+       NFCApduFrame, and the driver may overwrite the NFC_FRAME_HEADROOM bytes
+       before it and the NFC_FRAME_TAILROOM bytes after it to build its
+       transport frame in place. The APDU bytes themselves are left intact.
+       The default implementation ignores the extra room. */
+    virtual bool sendAPDUFrame(uint8_t* apdu, uint16_t apduLen,
+                               uint8_t* response, uint16_t& responseLen) {
+        return sendAPDU(apdu, apduLen, response, responseLen);
+    }
+    virtual bool startAPDUFrame(uint8_t* apdu, uint16_t apduLen) {
+        return startAPDU(apdu, apduLen);
+    }
+
+    /* Transport chaining: an APDU longer than one reader frame is handed over
+       in consecutive parts, each in an NFCApduFrame (same room rules as
+       sendAPDUFrame()). more is true for every part but the last; the
+       response comes back with the last part. The default implementation
+       only accepts an APDU sent as a single part. */
+    virtual bool sendAPDUFramePart(uint8_t* part, uint16_t partLen, bool more,
+                                   uint8_t* response, uint16_t& responseLen) {
+        return (more == false) && sendAPDUFrame(part, partLen, response, responseLen);
+    }
+
+    /* ISO 7816-4 command chaining: CLA INS P1 P2 and data are sent as short
+       APDUs carrying at most the frame capacity each, with CLA bit 0x10 set
+       on all but the last, which adds Le = 00. Every intermediate APDU must
+       be answered 90 00; the response to the last one is returned. Chunks
+       are copied from data into frame one at a time, so the whole command
+       is never held in memory. */
+    template <uint16_t Capacity>
+    bool sendChainedAPDU(NFCApduFrame<Capacity>& frame, const uint8_t* header,
+                         const uint8_t* data, uint16_t dataLen,
+                         uint8_t* response, uint16_t& responseLen) {
+        static_assert(Capacity > (NFC_APDU_HEADER_SIZE + 2U), "frame too small for a chained APDU");
+        const uint16_t chunkMax = ((Capacity - NFC_APDU_HEADER_SIZE - 2U) < NFC_SHORT_APDU_MAX_LC) ?
+                                  (Capacity - NFC_APDU_HEADER_SIZE - 2U) : NFC_SHORT_APDU_MAX_LC;
+        uint8_t* apdu = frame.apdu();
+        uint16_t offset = 0U;
+        bool ret = (header != nullptr) && ((data != nullptr) || (dataLen == 0U));
+        bool last = false;
+
+        while (ret && (last == false)) {
+            uint16_t chunk = dataLen - offset;
+            uint16_t apduLen = NFC_APDU_HEADER_SIZE;
+
+            last = (chunk <= chunkMax);
+            if (last == false) {
+                chunk = chunkMax;
+            }
+
+            memcpy(apdu, header, NFC_APDU_HEADER_SIZE);
+            if (last == false) {
+                apdu[0] |= NFC_CLA_CHAINING;
+            }
+            if (chunk > 0U) {
+                apdu[apduLen++] = (uint8_t)chunk;
+                memcpy(apdu + apduLen, data + offset, chunk);
+                apduLen += chunk;
+                offset += chunk;
+            }
+
+            if (last) {
+                apdu[apduLen++] = 0x00U; /* Le */
+                ret = sendAPDUFrame(apdu, apduLen, response, responseLen);
+            }
+            else {
+                uint8_t sw[2];
+                uint16_t swLen = sizeof(sw);
+                ret = sendAPDUFrame(apdu, apduLen, sw, swLen) &&
+                      (swLen == sizeof(sw)) && (sw[0] == 0x90U) && (sw[1] == 0x00U);
+            }
+        }
+
+        return ret;
+    }
+
+    /* Extended-length APDU: CLA INS P1 P2 00 Lc1 Lc2 data 00 00, with 1 to
+       65535 data bytes. The APDU is streamed through sendAPDUFramePart() in
+       parts of at most the frame capacity, copied from data into frame one
+       at a time, so it is never assembled in memory. Drivers without
+       transport chaining handle APDUs that fit in one frame. */
+    template <uint16_t Capacity>
+    bool sendExtendedAPDU(NFCApduFrame<Capacity>& frame, const uint8_t* header,
+                          const uint8_t* data, uint16_t dataLen,
+                          uint8_t* response, uint16_t& responseLen) {
+        static_assert(Capacity > (NFC_APDU_HEADER_SIZE + 3U), "frame too small for an extended APDU");
+        uint8_t* part = frame.apdu();
+        uint16_t partLen = 0U;
+        uint16_t offset = 0U;
+        bool ret = (header != nullptr) && (data != nullptr) && (dataLen > 0U);
+        bool more = true;
+
+        if (ret) {
+            memcpy(part, header, NFC_APDU_HEADER_SIZE);
+            part[NFC_APDU_HEADER_SIZE] = 0x00U;
+            part[NFC_APDU_HEADER_SIZE + 1U] = (uint8_t)(dataLen >> 8U);
+            part[NFC_APDU_HEADER_SIZE + 2U] = (uint8_t)(dataLen & 0xFFU);
+            partLen = NFC_APDU_HEADER_SIZE + 3U;
+        }
+
+        while (ret && more) {
+            uint16_t chunk = dataLen - offset;
+
+            if (chunk > (Capacity - partLen)) {
+                chunk = Capacity - partLen;
+            }
+            memcpy(part + partLen, data + offset, chunk);
+            partLen += chunk;
+            offset += chunk;
+
+            /* Le follows the last data byte, in a part of its own if needed */
+            if ((offset == dataLen) && ((partLen + 2U) <= Capacity)) {
+                part[partLen++] = 0x00U;
+                part[partLen++] = 0x00U;
+                more = false;
+            }
+
+            ret = sendAPDUFramePart(part, partLen, more, response, responseLen);
+            partLen = 0U;
+        }
+
+        return ret;
+    }
+
+    /* Split target detection, same contract as startAPDU()/finishAPDU(). */
+    virtual bool startListPassiveTarget() {
+        return true;
+    }
+    virtual bool finishListPassiveTarget() {
+        return inListPassiveTarget();
+    }
+
+    /* Split reader reset, same contract as startAPDU()/finishAPDU(): the
+       reader reconfigures itself while the host is free. The default
+       implementation resets in startResetReader(). */
+    virtual bool startResetReader() {
+        resetReader();
+        return true;
+    }
+    virtual bool finishResetReader() {
+        return true;
+    }
+
+    /* Drops the command started with startAPDU() or startListPassiveTarget()
+       whose answer will not be collected, so that the reader takes the next
+       command at once. The default implementation forgets the deferred APDU. */
+    virtual void abortAPDU() {
+        pendingApdu = nullptr;
+    }
+
+    /* Keep-target mode: holdTarget() puts the activated card to sleep while
+       the reader remembers it, and reselectTarget() wakes that same card
+       without a new detection. Both return false when unsupported, or when
+       the card is gone, and the caller then falls back to resetReader() and
+       a new detection. */
+    virtual bool holdTarget() {
+        return false;
+    }
+    virtual bool reselectTarget() {
+        return false;
+    }
+
+    /* true when finishAPDU() or finishListPassiveTarget() would not block.
+       Drivers without a readiness signal always report true. */
+    virtual bool isResponseReady() {
+        return true;
+    }
+
     virtual bool readUID(uint8_t* uid, uint8_t& uidLength) = 0;
     virtual void resetReader() = 0;
     virtual bool printFirmwareVersion() = 0;
 
     virtual ~NFCDriver() {}
+
+protected:
+    const uint8_t* pendingApdu = nullptr;
+    uint16_t pendingApduLen = 0U;
 };
 
 #endif // NFCDRIVER_H
\ No newline at end of file
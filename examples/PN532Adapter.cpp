@@ -1,6 +1,8 @@
 #include "PN532Adapter.h"
 
 #define PN532BASE_READUID_TIMEOUT_MS    (3000U)
+#define PN532BASE_DETECT_TIMEOUT_MS     (30000U)
+#define PN532BASE_AUTOPOLL_MAX_PERIOD   (15U)
 
 /**
  * @brief Construct a PN532Adapter using hardware SPI.
@@ -36,7 +38,7 @@ PN532Adapter::PN532Adapter(SerialDriver& serialDriver, uint8_t clk, uint8_t miso
  * @brief Construct a PN532Adapter using I2C.
  *
  * @param serialDriver Reference to SerialDriver for debug output.
- * @param irqPin IRQ pin (if applicable).
+ * @param irqPin IRQ pin, or PN532_IRQ_NONE if it is not wired.
  * @param resetPin Reset pin of PN532.
  * @param wire Pointer to TwoWire instance (default: &Wire).
  */
@@ -74,14 +76,41 @@ PN532Adapter::~PN532Adapter() {
 /**
  * @brief Initialize the PN532 module.
  *
- * Calls Adafruit_PN532::begin() and checks firmware.
+ * Calls Adafruit_PN532::begin() and checks firmware. On I2C, then raises the
+ * bus clock up to the speed set with setMaxI2CSpeed(); on UART, the baud
+ * rate up to the one set with setMaxSerialSpeed().
  *
  * @return true if the module is detected and initialized.
  * @return false otherwise.
  */
 bool PN532Adapter::begin() {
+    bool ret = false;
+
     nfc->begin();
-    return nfc->getFirmwareVersion() != 0;
+    ret = (nfc->getFirmwareVersion() != 0U);
+
+    if (ret && (interface == PN532Interface::I2C) && (maxI2CSpeed > 0U)) {
+        uint32_t speed = nfc->setI2CSpeed(maxI2CSpeed);
+
+        serial->print(F("I2C clock: "));
+        if (speed == 0U) {
+            serial->println(F("unchanged"));
+        }
+        else {
+            serial->print(speed / 1000U);
+            serial->println(F(" kHz"));
+        }
+    }
+
+    if (ret && (interface == PN532Interface::UART) && (maxSerialSpeed > 0U)) {
+        uint32_t baud = nfc->setSerialSpeed(maxSerialSpeed);
+
+        serial->print(F("HSU baud rate: "));
+        serial->println(baud);
+        ret = (baud != 0U);
+    }
+
+    return ret;
 }
 
 /**
@@ -107,7 +136,7 @@ bool PN532Adapter::readUID(uint8_t* uidBuffer, uint8_t &uidLength) {
  * @return false otherwise.
  */
 bool PN532Adapter::sendAPDU(const uint8_t* apdu, uint16_t apduLength,
-                            uint8_t* response, uint8_t &responseLength) {
+                            uint8_t* response, uint16_t &responseLength) {
     bool success = nfc->inDataExchange(const_cast<uint8_t*>(apdu), apduLength, response, &responseLength);
 
     if (!success) {
@@ -115,22 +144,143 @@ bool PN532Adapter::sendAPDU(const uint8_t* apdu, uint16_t apduLength,
         return false;
     }
 
-    serial->print(F("APDU response ("));
-    serial->print(responseLength);
-    serial->println(F(" bytes):"));
+    printResponse(response, responseLength);
+
+    return true;
+}
+
+/**
+ * @brief Send an APDU command to a card without waiting for its response.
+ *
+ * @param apdu Pointer to APDU command buffer.
+ * @param apduLength Length of APDU command in bytes.
+ * @return true if the PN532 acknowledged the command.
+ * @return false otherwise.
+ */
+bool PN532Adapter::startAPDU(const uint8_t* apdu, uint16_t apduLength) {
+    bool success = nfc->startDataExchange(const_cast<uint8_t*>(apdu), apduLength);
+
+    if (!success) {
+        serial->println(F("APDU exchange failed!"));
+    }
+
+    return success;
+}
+
+/**
+ * @brief Exchange an APDU held in an NFCApduFrame, building the PN532 frame in place.
+ *
+ * @param apdu Pointer to the APDU inside an NFCApduFrame.
+ * @param apduLength Length of APDU command in bytes.
+ * @param response Buffer to receive the card's response.
+ * @param responseLength Input: size of @p response; Output: length of the response.
+ * @return true if APDU exchange succeeded.
+ * @return false otherwise.
+ */
+bool PN532Adapter::sendAPDUFrame(uint8_t* apdu, uint16_t apduLength,
+                                 uint8_t* response, uint16_t &responseLength) {
+    bool success = nfc->inDataExchangeInPlace(apdu, apduLength, response, &responseLength);
+
+    if (!success) {
+        serial->println(F("APDU exchange failed!"));
+        return false;
+    }
+
+    printResponse(response, responseLength);
+
+    return true;
+}
+
+/**
+ * @brief Send an APDU held in an NFCApduFrame without waiting for its response.
+ *
+ * @param apdu Pointer to the APDU inside an NFCApduFrame.
+ * @param apduLength Length of APDU command in bytes.
+ * @return true if the PN532 acknowledged the command.
+ * @return false otherwise.
+ */
+bool PN532Adapter::startAPDUFrame(uint8_t* apdu, uint16_t apduLength) {
+    bool success = nfc->startDataExchangeInPlace(apdu, apduLength);
+
+    if (!success) {
+        serial->println(F("APDU exchange failed!"));
+    }
+
+    return success;
+}
+
+/**
+ * @brief Send one part of a long APDU, chained to the card by the PN532.
+ *
+ * @param part Pointer to the part inside an NFCApduFrame.
+ * @param partLength Length of the part in bytes.
+ * @param more true if more parts follow.
+ * @param response Buffer to receive the card's response.
+ * @param responseLength Input: size of @p response; Output: length of the response.
+ * @return true if the part was accepted and, for the last part, a response received.
+ * @return false otherwise.
+ */
+bool PN532Adapter::sendAPDUFramePart(uint8_t* part, uint16_t partLength, bool more,
+                                     uint8_t* response, uint16_t &responseLength) {
+    bool success = (partLength <= UINT8_MAX) && nfc->startDataExchangeInPlace(part, (uint8_t)partLength, more);
+
+    if (success) {
+        if (more) {
+            /* The PN532 only reports that the card acknowledged the part */
+            uint16_t noData = 0U;
+            success = nfc->readDataExchangeResponse(response, &noData);
+        }
+        else {
+            success = nfc->readDataExchangeResponse(response, &responseLength);
+        }
+    }
+
+    if (!success) {
+        serial->println(F("APDU exchange failed!"));
+        return false;
+    }
+
+    if (!more) {
+        printResponse(response, responseLength);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Collect the response of an APDU sent with startAPDU().
+ *
+ * @param response Buffer to receive the card's response.
+ * @param responseLength Input: size of @p response; Output: length of the response.
+ * @return true if APDU exchange succeeded.
+ * @return false otherwise.
+ */
+bool PN532Adapter::finishAPDU(uint8_t* response, uint16_t &responseLength) {
+    bool success = nfc->readDataExchangeResponse(response, &responseLength);
 
-    for (uint8_t i = 0; i < responseLength; i++) {
-        serial->print(F("0x"));
-        if (response[i] < 16) serial->print(F("0"));
-        serial->print(response[i], HEX);
-        serial->print(F(" "));
-        if ((i + 1) % 16 == 0 && (i + 1) != responseLength) serial->println();
+    if (!success) {
+        serial->println(F("APDU exchange failed!"));
+        return false;
     }
-    serial->println();
+
+    printResponse(response, responseLength);
 
     return true;
 }
 
+/**
+ * @brief Print an APDU response as a hex dump.
+ *
+ * @param response Pointer to the response bytes.
+ * @param responseLength Length of the response in bytes.
+ */
+void PN532Adapter::printResponse(const uint8_t* response, uint16_t responseLength) {
+    serial->print(F("APDU response ("));
+    serial->print(responseLength);
+    serial->println(F(" bytes):"));
+    serial->printHexDump(response, responseLength);
+}
+
 /**
  * @brief Check if a passive target (card) is present.
  *
@@ -138,16 +288,214 @@ bool PN532Adapter::sendAPDU(const uint8_t* apdu, uint16_t apduLength,
  * @return false otherwise.
  */
 bool PN532Adapter::inListPassiveTarget() {
-    return nfc->inListPassiveTarget();
+    return startListPassiveTarget() && finishListPassiveTarget();
+}
+
+/**
+ * @brief Start passive target detection and return immediately.
+ *
+ * @return true if the PN532 acknowledged the command.
+ * @return false otherwise.
+ */
+bool PN532Adapter::startListPassiveTarget() {
+    bool ret = false;
+
+    detectStartedAt = millis();
+    detectStartPolls = nfc->statusPolls();
+
+    if (autoPollPeriod > 0U) {
+        ret = nfc->startAutoPoll(PN532_AUTOPOLL_ENDLESS, autoPollPeriod, autoPollTypes, autoPollTypeCount);
+    }
+    else {
+        ret = nfc->startInListPassiveTarget();
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Collect the passive target detected after startListPassiveTarget().
+ *
+ * @return true if a card is detected.
+ * @return false otherwise.
+ */
+bool PN532Adapter::finishListPassiveTarget() {
+    bool ret = false;
+
+    if (autoPollPeriod > 0U) {
+        ret = nfc->readAutoPoll(NULL, PN532BASE_DETECT_TIMEOUT_MS);
+    }
+    else {
+        ret = nfc->readInListPassiveTarget(PN532BASE_DETECT_TIMEOUT_MS);
+    }
+
+    if (ret) {
+        detectionMs = millis() - detectStartedAt;
+        detectionPolls = nfc->statusPolls() - detectStartPolls;
+
+        serial->print(F("Card detected in "));
+        serial->print(detectionMs);
+        serial->print(F(" ms, bus status polls: "));
+        serial->println(detectionPolls);
+
+        (void)negotiateBitRate();
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Select InAutoPoll detection and its parameters.
+ *
+ * @param periodMs Pause between polling rounds in ms, 0 to use InListPassiveTarget.
+ * @param targetTypes Target types to poll for.
+ * @param targetTypeCount Number of target types.
+ * @return true if the configuration was accepted, false otherwise.
+ */
+bool PN532Adapter::setAutoPoll(uint16_t periodMs, const uint8_t* targetTypes, uint8_t targetTypeCount) {
+    bool ret = false;
+    uint32_t period = ((uint32_t)periodMs + PN532_AUTOPOLL_PERIOD_MS - 1U) / PN532_AUTOPOLL_PERIOD_MS;
+
+    if (periodMs == 0U) {
+        autoPollPeriod = 0U;
+        autoPollTypeCount = 0U;
+        ret = true;
+    }
+    else if ((period <= PN532BASE_AUTOPOLL_MAX_PERIOD) && (targetTypes != NULL) &&
+             (targetTypeCount > 0U) && (targetTypeCount <= PN532_AUTOPOLL_MAX_TYPES)) {
+        memcpy(autoPollTypes, targetTypes, targetTypeCount);
+        autoPollTypeCount = targetTypeCount;
+        autoPollPeriod = (uint8_t)period;
+        ret = true;
+    }
+    else {
+        /* Out of range, keep the current configuration */
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Negotiate the fastest common bit rate with the card just inlisted.
+ *
+ * Only symmetric rates are requested. The ATS TA(1) byte announces the rates
+ * from reader to card in bits 0..2 and from card to reader in bits 4..6, for
+ * 212, 424 and 848 kbps.
+ *
+ * @return true if a rate above 106 kbps was negotiated, false if the link stays at 106 kbps.
+ */
+bool PN532Adapter::negotiateBitRate() {
+    bool ret = false;
+    uint8_t supported = nfc->targetBitRates();
+    uint8_t rate = (uint8_t)maxBitRate;
+
+    currentBitRate = PN532BitRate::KBPS_106;
+
+    while ((ret == false) && (rate > PN532_BITRATE_106)) {
+        uint8_t toCard = (uint8_t)(1U << (rate - 1U));
+        uint8_t toReader = (uint8_t)(1U << (rate + 3U));
+
+        if (((supported & toCard) != 0U) && ((supported & toReader) != 0U) &&
+            nfc->inPSL(rate, rate)) {
+            currentBitRate = (PN532BitRate)rate;
+            ret = true;
+        }
+        else {
+            rate--;
+        }
+    }
+
+    if (maxBitRate != PN532BitRate::KBPS_106) {
+        serial->print(F("RF bit rate: "));
+        serial->print(106U << (uint8_t)currentBitRate);
+        serial->println(F(" kbps"));
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Check whether the PN532 has a response ready.
+ *
+ * @return true if a response can be read without blocking.
+ * @return false otherwise.
+ */
+bool PN532Adapter::isResponseReady() {
+    return nfc->isCommandDone();
 }
 
 /**
  * @brief Reset the PN532 reader and configure it.
  */
 void PN532Adapter::resetReader() {
+    resetPending = false;
     nfc->SAMConfig();
 }
 
+/**
+ * @brief Start reconfiguring the PN532 reader and return immediately.
+ *
+ * @return true if the PN532 acknowledged the command.
+ * @return false otherwise.
+ */
+bool PN532Adapter::startResetReader() {
+    resetPending = nfc->startSAMConfig();
+    return resetPending;
+}
+
+/**
+ * @brief Collect the answer of a reset started with startResetReader().
+ *
+ * @return true if no reset was pending or the PN532 confirmed it.
+ * @return false otherwise.
+ */
+bool PN532Adapter::finishResetReader() {
+    bool ret = true;
+
+    if (resetPending) {
+        resetPending = false;
+        ret = nfc->finishSAMConfig();
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Abort the command still running on the PN532.
+ *
+ * Without this, a command sent next (such as the SAMConfiguration of
+ * startResetReader()) would reach a PN532 still busy with the old one.
+ */
+void PN532Adapter::abortAPDU() {
+    (void)nfc->abortCommand();
+}
+
+/**
+ * @brief Deselect the card and keep it known to the PN532.
+ *
+ * @return true if the PN532 deselected the card.
+ * @return false otherwise.
+ */
+bool PN532Adapter::holdTarget() {
+    return nfc->inDeselect();
+}
+
+/**
+ * @brief Reactivate the card deselected by holdTarget().
+ *
+ * @return true if the card was selected again.
+ * @return false otherwise.
+ */
+bool PN532Adapter::reselectTarget() {
+    bool ret = nfc->inSelect();
+
+    if (ret) {
+        (void)negotiateBitRate();
+    }
+
+    return ret;
+}
+
 /**
  * @brief Print firmware and chip information to Serial.
  *
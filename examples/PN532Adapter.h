@@ -6,6 +6,10 @@
 #include "NFCDriver.h"
 #include "SerialDriver.h"
 
+#if (PN532_DATAEXCHANGE_HEADROOM > NFC_FRAME_HEADROOM) || (PN532_FRAME_TAILROOM > NFC_FRAME_TAILROOM)
+#error "NFCApduFrame room too small for the PN532 frame"
+#endif
+
 /**
  * @brief Enum representing the supported communication interfaces for the PN532 NFC module.
  *
@@ -20,6 +24,16 @@ enum class PN532Interface {
     UART          /* Use UART interface. */
 };
 
+/**
+ * @brief RF bit rates of an ISO14443-4 link, in the PN532 InPSL encoding.
+ */
+enum class PN532BitRate : uint8_t {
+    KBPS_106 = PN532_BITRATE_106, /* Activation rate, always supported. */
+    KBPS_212 = PN532_BITRATE_212, /* 212 kbps. */
+    KBPS_424 = PN532_BITRATE_424, /* 424 kbps. */
+    KBPS_848 = PN532_BITRATE_848  /* 848 kbps. */
+};
+
 /**
  * @brief Adapter class wrapping the Adafruit_PN532 library.
  *
@@ -61,9 +75,14 @@ public:
      * @brief Constructs a PN532Adapter using the I2C interface.
      *
      * @param serialDriver Reference to SerialDriver for debug output.
-     * @param irqPin The IRQ pin (optional for some configurations).
+     * @param irqPin The IRQ pin, or PN532_IRQ_NONE if the IRQ line is not wired.
      * @param resetPin The reset pin of the PN532 module.
      * @param wire Pointer to TwoWire instance to use (default is &Wire).
+     *
+     * @note With the IRQ pin, waiting for the reader costs no I2C traffic. With
+     *       PN532_IRQ_NONE the RDY byte is polled over the bus. A pin given here
+     *       but left unconnected is detected by the driver, which then falls back
+     *       to RDY polling.
      */
     PN532Adapter(SerialDriver& serialDriver, uint8_t irqPin, uint8_t resetPin, TwoWire *wire = &Wire);
 
@@ -136,7 +155,99 @@ public:
      * @return false if the exchange failed.
      */
     bool sendAPDU(const uint8_t* apdu, uint16_t apduLength,
-                  uint8_t* response, uint8_t &responseLength) override;
+                  uint8_t* response, uint16_t &responseLength) override;
+
+    /**
+     * @brief Send an APDU command without waiting for the card's response.
+     *
+     * The PN532 exchanges the APDU with the card on its own while the host
+     * keeps running; the response is collected with finishAPDU().
+     *
+     * @param apdu Pointer to APDU command buffer.
+     * @param apduLength Length of APDU command in bytes.
+     * @return true if the PN532 acknowledged the command.
+     * @return false otherwise.
+     */
+    bool startAPDU(const uint8_t* apdu, uint16_t apduLength) override;
+
+    /**
+     * @brief Exchange an APDU held in an NFCApduFrame without copying it.
+     *
+     * The InDataExchange header and the PN532 frame are built in the room
+     * around the APDU and the frame is written to the bus as is.
+     *
+     * @param apdu Pointer to the APDU inside an NFCApduFrame.
+     * @param apduLength Length of APDU command in bytes.
+     * @param response Pointer to buffer where the card's response will be stored.
+     * @param responseLength Input: size of @p response; Output: length of the response.
+     * @return true if the APDU command was successfully sent and a response received.
+     * @return false if the exchange failed.
+     */
+    bool sendAPDUFrame(uint8_t* apdu, uint16_t apduLength,
+                       uint8_t* response, uint16_t &responseLength) override;
+
+    /**
+     * @brief Send an APDU held in an NFCApduFrame without copying it or waiting for the response.
+     *
+     * @param apdu Pointer to the APDU inside an NFCApduFrame.
+     * @param apduLength Length of APDU command in bytes.
+     * @return true if the PN532 acknowledged the command.
+     * @return false otherwise.
+     */
+    bool startAPDUFrame(uint8_t* apdu, uint16_t apduLength) override;
+
+    /**
+     * @brief Send one part of an APDU longer than one PN532 frame.
+     *
+     * Parts other than the last are sent with the MI bit set in Tg, so the
+     * PN532 chains them to the card; the card's response comes with the last part.
+     *
+     * @param part Pointer to the part inside an NFCApduFrame.
+     * @param partLength Length of the part in bytes.
+     * @param more true if more parts follow.
+     * @param response Pointer to buffer where the card's response will be stored.
+     * @param responseLength Input: size of @p response; Output: length of the response.
+     * @return true if the part was accepted and, for the last part, a response received.
+     * @return false if the exchange failed.
+     */
+    bool sendAPDUFramePart(uint8_t* part, uint16_t partLength, bool more,
+                           uint8_t* response, uint16_t &responseLength) override;
+
+    /**
+     * @brief Wait for and read the response of an APDU sent with startAPDU().
+     *
+     * @param response Pointer to buffer where the card's response will be stored.
+     * @param responseLength Input: size of @p response; Output: length of the response.
+     * @return true if a response was received.
+     * @return false if the exchange failed.
+     */
+    bool finishAPDU(uint8_t* response, uint16_t &responseLength) override;
+
+    /**
+     * @brief Start waiting for a passive NFC target without blocking.
+     *
+     * Uses InListPassiveTarget, or InAutoPoll once configured with setAutoPoll().
+     *
+     * @return true if the PN532 acknowledged the command.
+     * @return false otherwise.
+     */
+    bool startListPassiveTarget() override;
+
+    /**
+     * @brief Read the target detected after startListPassiveTarget().
+     *
+     * @return true if a passive target (card) was inlisted.
+     * @return false otherwise.
+     */
+    bool finishListPassiveTarget() override;
+
+    /**
+     * @brief Check whether the PN532 has a response ready.
+     *
+     * @return true if finishAPDU(), finishListPassiveTarget() or finishResetReader() would not block.
+     * @return false otherwise.
+     */
+    bool isResponseReady() override;
 
     /**
      * @brief Checks for presence of a passive NFC target.
@@ -151,6 +262,46 @@ public:
      */
     void resetReader() override;
 
+    /**
+     * @brief Start reconfiguring the reader (SAMConfiguration) without waiting for the PN532.
+     *
+     * @return true if the PN532 acknowledged the command.
+     * @return false otherwise.
+     */
+    bool startResetReader() override;
+
+    /**
+     * @brief Complete a reset started with startResetReader().
+     *
+     * @return true if no reset was pending or the PN532 confirmed it.
+     * @return false otherwise.
+     */
+    bool finishResetReader() override;
+
+    /**
+     * @brief Abort the pending command with an ACK frame, so the PN532 takes the next one.
+     */
+    void abortAPDU() override;
+
+    /**
+     * @brief Deselect the card (InDeselect) while the PN532 keeps its identity.
+     *
+     * @return true if the card was deselected.
+     * @return false otherwise.
+     */
+    bool holdTarget() override;
+
+    /**
+     * @brief Activate again the card held by holdTarget() (InSelect).
+     *
+     * The card is addressed by its known UID, skipping anticollision. The bit
+     * rate set with setMaxBitRate() is negotiated again.
+     *
+     * @return true if the card answered.
+     * @return false if it left the field.
+     */
+    bool reselectTarget() override;
+
     /**
      * @brief Prints the PN532 firmware version and chip information to Serial.
      *
@@ -161,10 +312,122 @@ public:
 
     ///@}
 
+    /**
+     * @brief Set the highest RF bit rate negotiated after each card activation.
+     *
+     * After a card is inlisted, the fastest rate supported in both directions
+     * by the card (from its ATS) and not above @p rate is requested with a PPS
+     * exchange (InPSL). If the card refuses, the next lower rate is tried, down
+     * to 106 kbps where the link simply stays.
+     *
+     * @param rate Highest bit rate to use; KBPS_106 (default) disables negotiation.
+     */
+    void setMaxBitRate(PN532BitRate rate) {
+        maxBitRate = rate;
+    }
+
+    /**
+     * @brief Set the highest I2C clock tried by begin() on the I2C interface.
+     *
+     * begin() raises the clock to the fastest of 1 MHz, 400 kHz and 100 kHz
+     * not above @p hz that passes the PN532 communication line tests, and
+     * falls back to the next lower one on a NACK or a corrupted echo.
+     *
+     * @param hz Highest I2C clock in Hz; 0 (default) keeps the Wire clock as is.
+     */
+    void setMaxI2CSpeed(uint32_t hz) {
+        maxI2CSpeed = hz;
+    }
+
+    /**
+     * @brief Set the highest HSU baud rate tried by begin() on the UART interface.
+     *
+     * begin() switches the PN532 and the host UART with SetSerialBaudRate to
+     * the fastest rate from 1.288 Mbaud down to 115200 baud not above @p baud
+     * that passes the PN532 communication line tests. A failed rate is
+     * recovered with a hardware reset, so the reset pin must be wired.
+     *
+     * @param baud Highest baud rate; 0 (default) stays at 115200 baud.
+     */
+    void setMaxSerialSpeed(uint32_t baud) {
+        maxSerialSpeed = baud;
+    }
+
+    /**
+     * @brief RF bit rate of the current card link.
+     *
+     * @return Bit rate negotiated at the last card activation.
+     */
+    PN532BitRate bitRate() const {
+        return currentBitRate;
+    }
+
+    /**
+     * @brief Detect cards with InAutoPoll instead of InListPassiveTarget.
+     *
+     * The PN532 polls the field for the given target types on its own, pausing
+     * @p periodMs between rounds, and signals a card on its IRQ line. When the
+     * IRQ pin is wired (I2C constructor), waiting for a card costs no bus
+     * transaction, so the host can sleep or do other work in between.
+     *
+     * @param periodMs Pause between polling rounds, rounded up to a multiple of
+     *                 150 ms, at most 2250 ms. 0 restores InListPassiveTarget.
+     * @param targetTypes Target types to poll for (PN532_AUTOPOLL_*).
+     * @param targetTypeCount Number of entries in @p targetTypes, at most PN532_AUTOPOLL_MAX_TYPES.
+     * @return true if the configuration was accepted.
+     * @return false if the period or the number of types is out of range.
+     */
+    bool setAutoPoll(uint16_t periodMs, const uint8_t* targetTypes, uint8_t targetTypeCount);
+
+    /**
+     * @brief Time taken by the last successful detection.
+     *
+     * @return Milliseconds from the start of the detection to the card being reported.
+     */
+    uint32_t lastDetectionMs() const {
+        return detectionMs;
+    }
+
+    /**
+     * @brief Bus traffic of the last successful detection.
+     *
+     * @return Number of ready checks made over SPI or I2C while waiting for the card.
+     */
+    uint32_t lastDetectionStatusPolls() const {
+        return detectionPolls;
+    }
+
 private:
     SerialDriver* serial = nullptr; ///< Serial driver for debug output.
     PN532Interface interface; ///< The active interface type currently used.
     Adafruit_PN532* nfc = nullptr; ///< Pointer to the underlying Adafruit_PN532 instance.
+    bool resetPending = false; ///< startResetReader() awaits finishResetReader().
+    PN532BitRate maxBitRate = PN532BitRate::KBPS_106;     ///< Highest bit rate to negotiate.
+    PN532BitRate currentBitRate = PN532BitRate::KBPS_106; ///< Bit rate of the current card link.
+    uint32_t maxI2CSpeed = 0U;     ///< Highest I2C clock tried by begin(), 0 to keep it.
+    uint32_t maxSerialSpeed = 0U;  ///< Highest HSU baud rate tried by begin(), 0 to keep it.
+    uint8_t autoPollPeriod = 0U;   ///< InAutoPoll period in 150 ms units, 0 to use InListPassiveTarget.
+    uint8_t autoPollTypes[PN532_AUTOPOLL_MAX_TYPES];  ///< Target types polled by InAutoPoll.
+    uint8_t autoPollTypeCount = 0U; ///< Number of entries in @ref autoPollTypes.
+    uint32_t detectStartedAt = 0U; ///< millis() at the start of the current detection.
+    uint32_t detectStartPolls = 0U; ///< Status poll count at the start of the current detection.
+    uint32_t detectionMs = 0U;     ///< Duration of the last successful detection.
+    uint32_t detectionPolls = 0U;  ///< Status polls of the last successful detection.
+
+    /**
+     * @brief Raise the RF bit rate of the card just inlisted, up to @ref maxBitRate.
+     *
+     * @return true if a rate above 106 kbps was negotiated.
+     */
+    bool negotiateBitRate();
+
+    /**
+     * @brief Print an APDU response as a hex dump to the debug serial.
+     *
+     * @param response Pointer to the response bytes.
+     * @param responseLength Length of the response in bytes.
+     */
+    void printResponse(const uint8_t* response, uint16_t responseLength);
 };
 
 #endif // PN532ADAPTER_H
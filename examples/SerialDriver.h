@@ -2,6 +2,9 @@
 #define SERIALDRIVER_H
 #include <Arduino.h>
 
+/** Bytes per line of printHexDump() */
+#define SERIALDRIVER_HEX_DUMP_WIDTH (16U)
+
 /**
  * @class SerialDriver
  * @brief Abstract interface for serial communication.
@@ -11,6 +14,7 @@
  * to be used interchangeably by higher-level code like CryptnoxWallet.
  *
  * Implementations must provide all print/println variants used for debug output.
+ * write() and poll() have defaults; buffered implementations override them.
  */
 class SerialDriver {
 public:
@@ -128,6 +132,65 @@ public:
 
     ///@}
 
+    /**
+     * @brief Write a block of raw bytes.
+     *
+     * The default implementation prints the bytes one by one. Implementations
+     * should override it to take the whole block in one call.
+     *
+     * @param buffer Bytes to write.
+     * @param length Number of bytes.
+     * @return Number of bytes written.
+     */
+    virtual size_t write(const uint8_t* buffer, size_t length) {
+        for (size_t i = 0U; i < length; i++) {
+            print(static_cast<char>(buffer[i]));
+        }
+        return length;
+    }
+
+    /**
+     * @brief Move buffered output along without blocking.
+     *
+     * Called from idle points and polling loops. Does nothing for unbuffered
+     * implementations.
+     */
+    virtual void poll() {}
+
+    /**
+     * @brief Print bytes as a hex dump.
+     *
+     * Each byte is printed as "0xXX ", SERIALDRIVER_HEX_DUMP_WIDTH bytes per
+     * line, and the dump ends with a newline. Each line is formatted locally
+     * and handed over with a single write().
+     *
+     * @param data Bytes to print.
+     * @param length Number of bytes.
+     */
+    void printHexDump(const uint8_t* data, uint16_t length) {
+        static const char digits[] = "0123456789ABCDEF";
+        char line[(SERIALDRIVER_HEX_DUMP_WIDTH * 5U) + 2U];
+        uint16_t i = 0U;
+
+        do {
+            size_t n = 0U;
+            uint16_t end = i + SERIALDRIVER_HEX_DUMP_WIDTH;
+            if (end > length) {
+                end = length;
+            }
+            for (; i < end; i++) {
+                line[n++] = '0';
+                line[n++] = 'x';
+                line[n++] = digits[data[i] >> 4];
+                line[n++] = digits[data[i] & 0x0FU];
+                line[n++] = ' ';
+            }
+            line[n++] = '\r';
+            line[n++] = '\n';
+            (void)write(reinterpret_cast<const uint8_t*>(line), n);
+        } while (i < length);
+    }
+
     /**
      * @brief Virtual destructor for proper cleanup of derived classes.
      */
@@ -40,9 +40,13 @@ void setup() {
     if (wallet.begin()) {
         serialAdapter.println(F("PN532 initialized"));
         wallet.printPN532FirmwareVersion();
+
+        /* Compute ECDH while the card answers OPEN SECURE CHANNEL */
+        wallet.setPipelinedHandshake(true);
     } else {
         serialAdapter.println(F("PN532 init failed"));
-        /* Halt program if initialization fails */
+        /* Send buffered output, then halt program if initialization fails */
+        serialAdapter.flush();
         while(1);
     }
 }
@@ -56,12 +60,21 @@ void setup() {
  *
  * On each loop iteration, the code checks for the presence of a
  * passive NFC/ISO-DEP card and processes wallet APDU commands.
+ * Between two polls, one ephemeral keypair is pre-generated so the
+ * next secure channel does not wait for key generation. The wait between
+ * iterations keeps the serial adapter draining its buffered output.
  */
 void loop() {
     
     /* Process any detected NFC card */
     (void)wallet.processCard();
 
-    /* Wait 1 second before next loop iteration */
-    delay(1000);
+    /* Use idle time to pre-generate secure channel keypairs */
+    (void)wallet.refillKeyPool();
+
+    /* Wait 1 second before next loop iteration, draining debug output meanwhile */
+    const uint32_t waitStart = millis();
+    while ((millis() - waitStart) < 1000UL) {
+        serialAdapter.poll();
+    }
 }
@@ -118,6 +118,9 @@ Adafruit_BusIO_Register::Adafruit_BusIO_Register(
 bool Adafruit_BusIO_Register::write(uint8_t *buffer, uint8_t len) {
   uint8_t addrbuffer[2] = {(uint8_t)(_address & 0xFF),
                            (uint8_t)(_address >> 8)};
+  // raw bytes: the shadow copy is set again by write(value) if it applies
+  _shadowValid = false;
+  _busWrites++;
   if (_i2cdevice) {
     return _i2cdevice->write(buffer, len, true, addrbuffer, _addrwidth);
   }
@@ -177,15 +180,29 @@ bool Adafruit_BusIO_Register::write(uint32_t value, uint8_t numbytes) {
     }
     value >>= 8;
   }
-  return write(_buffer, numbytes);
+  if (!write(_buffer, numbytes)) {
+    return false;
+  }
+
+  // write-through: the copy is the register content if all of it was written
+  _shadowValid = shadowing() && (numbytes == _width);
+  if (_shadowValid && (numbytes < 4)) {
+    _cached &= (1UL << (8 * numbytes)) - 1;
+  }
+  return true;
 }
 
 /*!
  *    @brief  Read data from the register location. This does not do any error
- * checking!
+ * checking! With the shadow copy enabled and valid, no bus transaction is
+ * made.
  *    @return Returns 0xFFFFFFFF on failure, value otherwise
  */
 uint32_t Adafruit_BusIO_Register::read(void) {
+  if (shadowing() && _shadowValid) {
+    return _cached;
+  }
+
   if (!read(_buffer, _width)) {
     return -1;
   }
@@ -201,6 +218,11 @@ uint32_t Adafruit_BusIO_Register::read(void) {
     }
   }
 
+  if (shadowing()) {
+    _cached = value;
+    _shadowValid = true;
+  }
+
   return value;
 }
 
@@ -219,6 +241,7 @@ uint32_t Adafruit_BusIO_Register::readCached(void) { return _cached; }
 bool Adafruit_BusIO_Register::read(uint8_t *buffer, uint8_t len) {
   uint8_t addrbuffer[2] = {(uint8_t)(_address & 0xFF),
                            (uint8_t)(_address >> 8)};
+  _busReads++;
   if (_i2cdevice) {
     return _i2cdevice->write_then_read(addrbuffer, _addrwidth, buffer, len);
   }
@@ -363,7 +386,10 @@ uint8_t Adafruit_BusIO_Register::width(void) { return _width; }
  *    @brief  Set the default width of data
  *    @param width the default width of data read from register
  */
-void Adafruit_BusIO_Register::setWidth(uint8_t width) { _width = width; }
+void Adafruit_BusIO_Register::setWidth(uint8_t width) {
+  _width = width;
+  _shadowValid = false;
+}
 
 /*!
  *    @brief  Set register address
@@ -371,6 +397,7 @@ void Adafruit_BusIO_Register::setWidth(uint8_t width) { _width = width; }
  */
 void Adafruit_BusIO_Register::setAddress(uint16_t address) {
   _address = address;
+  _shadowValid = false;
 }
 
 /*!
@@ -381,4 +408,58 @@ void Adafruit_BusIO_Register::setAddressWidth(uint16_t address_width) {
   _addrwidth = address_width;
 }
 
+/*!
+ *    @brief  Keep a write-through shadow copy of the register. read(), and so
+ * Adafruit_BusIO_RegisterBits::write(), then return the last value written or
+ * read instead of reading the device, which turns a burst of bit-field
+ * updates into one write each. Only for registers that the device does not
+ * change by itself, see setVolatile(). The default is
+ * BUSIO_REGISTER_SHADOW_DEFAULT.
+ *    @param enable true to use the shadow copy
+ */
+void Adafruit_BusIO_Register::enableShadow(bool enable) {
+  _shadowEnabled = enable;
+  _shadowValid = false;
+}
+
+/*!
+ *    @brief  Mark a register whose content the device changes by itself
+ * (status, interrupt flags, FIFO...): it is always read from the device, even
+ * with the shadow copy enabled, e.g. by BUSIO_REGISTER_SHADOW_DEFAULT
+ *    @param isVolatile true for a volatile register
+ */
+void Adafruit_BusIO_Register::setVolatile(bool isVolatile) {
+  _volatile = isVolatile;
+  _shadowValid = false;
+}
+
+/*!
+ *    @brief  Drop the shadow copy, so the next read() reads the device.
+ * Needed after a device reset, or after writing the register other than
+ * through this object.
+ */
+void Adafruit_BusIO_Register::invalidateShadow(void) { _shadowValid = false; }
+
+/*!
+ *    @brief  Number of register reads made on the bus since construction or
+ * resetCounters()
+ *    @returns The read transaction count
+ */
+uint32_t Adafruit_BusIO_Register::busReads(void) { return _busReads; }
+
+/*!
+ *    @brief  Number of register writes made on the bus since construction or
+ * resetCounters()
+ *    @returns The write transaction count
+ */
+uint32_t Adafruit_BusIO_Register::busWrites(void) { return _busWrites; }
+
+/*!
+ *    @brief  Reset the read and write transaction counters
+ */
+void Adafruit_BusIO_Register::resetCounters(void) {
+  _busReads = 0;
+  _busWrites = 0;
+}
+
 #endif // SPI exists
@@ -10,6 +10,11 @@
 #include <Adafruit_I2CDevice.h>
 #include <Adafruit_SPIDevice.h>
 
+#ifndef BUSIO_REGISTER_SHADOW_DEFAULT
+#define BUSIO_REGISTER_SHADOW_DEFAULT                                          \
+  false ///< Whether registers start with their shadow copy enabled
+#endif
+
 typedef enum _Adafruit_BusIO_SPIRegType {
   ADDRBIT8_HIGH_TOREAD = 0,
   /*!<
@@ -77,6 +82,13 @@ public:
   void setAddress(uint16_t address);
   void setAddressWidth(uint16_t address_width);
 
+  void enableShadow(bool enable = true);
+  void setVolatile(bool isVolatile = true);
+  void invalidateShadow(void);
+  uint32_t busReads(void);
+  uint32_t busWrites(void);
+  void resetCounters(void);
+
 #if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_SERIAL)
   void print(Stream *s = &Serial);
   void println(Stream *s = &Serial);
@@ -95,6 +107,13 @@ private:
   uint8_t _buffer[4]; // we won't support anything larger than uint32 for
                       // non-buffered read
   uint32_t _cached = 0;
+
+  bool _shadowEnabled = BUSIO_REGISTER_SHADOW_DEFAULT; // see enableShadow()
+  bool _volatile = false;    // never served from the shadow copy
+  bool _shadowValid = false; // _cached holds the register content
+  uint32_t _busReads = 0, _busWrites = 0; // transactions since reset
+
+  bool shadowing(void) { return _shadowEnabled && !_volatile; }
 };
 
 /*!
@@ -134,6 +134,9 @@ bool Adafruit_SPIDevice::begin(void) {
     if (_miso != -1) {
       pinMode(_miso, INPUT);
     }
+
+    selectSoftTransfer();
+    calibrateSoftTransfer();
   }
 
   _begun = true;
@@ -154,9 +157,15 @@ void Adafruit_SPIDevice::transfer(uint8_t *buffer, size_t len) {
 #ifdef BUSIO_HAS_HW_SPI
 #if defined(SPARK)
     _spi->transfer(buffer, buffer, len, nullptr);
+#elif defined(STM32) && defined(STM32_CORE_VERSION) &&                         \
+    (STM32_CORE_VERSION >= 0x02000000)
+    // STM32 cores 2.0 and later: in-place buffer transfer, receiving too
+    _spi->transfer(buffer, len);
 #elif defined(STM32)
+    // STM32 cores before 2.0: their buffer transfer() also drives the
+    // hardware SS pin, so clock byte by byte and keep each received byte
     for (size_t i = 0; i < len; i++) {
-      _spi->transfer(buffer[i]);
+      buffer[i] = _spi->transfer(buffer[i]);
     }
 #else
     _spi->transfer(buffer, len);
@@ -168,104 +177,146 @@ void Adafruit_SPIDevice::transfer(uint8_t *buffer, size_t len) {
   //
   // SOFTWARE SPI
   //
-  uint8_t startbit;
-  if (_dataOrder == SPI_BITORDER_LSBFIRST) {
-    startbit = 0x1;
-  } else {
-    startbit = 0x80;
+  if (_softTransfer == nullptr) {
+    selectSoftTransfer();
   }
+  (this->*_softTransfer)(buffer, len);
+}
 
-  bool towrite, lastmosi = !(buffer[0] & startbit);
-  uint8_t bitdelay_us = (1000000 / _freq) / 2;
-
-  for (size_t i = 0; i < len; i++) {
-    uint8_t reply = 0;
-    uint8_t send = buffer[i];
-
-    /*
-    Serial.print("\tSending software SPI byte 0x");
-    Serial.print(send, HEX);
-    Serial.print(" -> 0x");
-    */
-
-    // Serial.print(send, HEX);
-    for (uint8_t b = startbit; b != 0;
-         b = (_dataOrder == SPI_BITORDER_LSBFIRST) ? b << 1 : b >> 1) {
-
-      if (bitdelay_us) {
-        delayMicroseconds(bitdelay_us);
-      }
-
-      if (_dataMode == SPI_MODE0 || _dataMode == SPI_MODE2) {
-        towrite = send & b;
-        if ((_mosi != -1) && (lastmosi != towrite)) {
-          BUSIO_WRITE_MOSI(towrite);
-          lastmosi = towrite;
-        }
-
-        BUSIO_SET_CLOCK_HIGH();
-
-        if (bitdelay_us) {
-          delayMicroseconds(bitdelay_us);
-        }
-
-        if (_miso != -1) {
-          if (BUSIO_READ_MISO())
-            reply |= b;
-        }
-
-        BUSIO_SET_CLOCK_LOW();
-
-      } else if (_dataMode == SPI_MODE3) {
-
-        if (_mosi != -1) { // transmit on falling edge
-          BUSIO_WRITE_MOSI(send & b);
-        }
-
-        BUSIO_SET_CLOCK_LOW();
+/*!
+ *    @brief  Clock one bit out and in over software SPI
+ *    @param  out       The bit to send
+ *    @param  lastmosi  Current MOSI level, to skip redundant writes
+ *    @return The bit received
+ */
+template <uint8_t edges>
+inline bool Adafruit_SPIDevice::softBit(bool out, bool &lastmosi) {
+  bool in = false;
 
-        if (bitdelay_us) {
-          delayMicroseconds(bitdelay_us);
-        }
+  if (edges == SOFT_MODE3) {
+    if (_mosi != -1) { // transmit on falling edge
+      BUSIO_WRITE_MOSI(out);
+    }
+    BUSIO_SET_CLOCK_LOW();
+    if (_bitDelayUs) {
+      delayMicroseconds(_bitDelayUs);
+    }
+    BUSIO_SET_CLOCK_HIGH();
+    if (_bitDelayUs) {
+      delayMicroseconds(_bitDelayUs);
+    }
+    in = (_miso != -1) && BUSIO_READ_MISO(); // read on rising edge
+  } else if (edges == SOFT_MODE1) {
+    BUSIO_SET_CLOCK_HIGH();
+    if (_bitDelayUs) {
+      delayMicroseconds(_bitDelayUs);
+    }
+    if (_mosi != -1) {
+      BUSIO_WRITE_MOSI(out);
+    }
+    BUSIO_SET_CLOCK_LOW();
+    in = (_miso != -1) && BUSIO_READ_MISO();
+  } else { // SPI_MODE0 and SPI_MODE2
+    if (_bitDelayUs) {
+      delayMicroseconds(_bitDelayUs);
+    }
+    if ((_mosi != -1) && (lastmosi != out)) {
+      BUSIO_WRITE_MOSI(out);
+      lastmosi = out;
+    }
+    BUSIO_SET_CLOCK_HIGH();
+    if (_bitDelayUs) {
+      delayMicroseconds(_bitDelayUs);
+    }
+    in = (_miso != -1) && BUSIO_READ_MISO();
+    BUSIO_SET_CLOCK_LOW();
+  }
 
-        BUSIO_SET_CLOCK_HIGH();
+  return in;
+}
 
-        if (bitdelay_us) {
-          delayMicroseconds(bitdelay_us);
-        }
+/*!
+ *    @brief  Software SPI transfer for one mode and bit order, with the 8
+ * bits of each byte unrolled
+ *    @param  buffer The buffer to send and receive at the same time
+ *    @param  len    The number of bytes to transfer
+ */
+template <uint8_t edges, bool lsbFirst>
+void Adafruit_SPIDevice::softTransfer(uint8_t *buffer, size_t len) {
+  const uint8_t b0 = lsbFirst ? 0x01 : 0x80, b1 = lsbFirst ? 0x02 : 0x40,
+                b2 = lsbFirst ? 0x04 : 0x20, b3 = lsbFirst ? 0x08 : 0x10,
+                b4 = lsbFirst ? 0x10 : 0x08, b5 = lsbFirst ? 0x20 : 0x04,
+                b6 = lsbFirst ? 0x40 : 0x02, b7 = lsbFirst ? 0x80 : 0x01;
+  bool lastmosi = !(buffer[0] & b0);
 
-        if (_miso != -1) { // read on rising edge
-          if (BUSIO_READ_MISO()) {
-            reply |= b;
-          }
-        }
+  for (size_t i = 0; i < len; i++) {
+    uint8_t send = buffer[i];
+    uint8_t reply = 0;
 
-      } else { // || _dataMode == SPI_MODE1)
+    reply |= softBit<edges>(send & b0, lastmosi) ? b0 : 0;
+    reply |= softBit<edges>(send & b1, lastmosi) ? b1 : 0;
+    reply |= softBit<edges>(send & b2, lastmosi) ? b2 : 0;
+    reply |= softBit<edges>(send & b3, lastmosi) ? b3 : 0;
+    reply |= softBit<edges>(send & b4, lastmosi) ? b4 : 0;
+    reply |= softBit<edges>(send & b5, lastmosi) ? b5 : 0;
+    reply |= softBit<edges>(send & b6, lastmosi) ? b6 : 0;
+    reply |= softBit<edges>(send & b7, lastmosi) ? b7 : 0;
 
-        BUSIO_SET_CLOCK_HIGH();
+    if (_miso != -1) {
+      buffer[i] = reply;
+    }
+  }
+}
 
-        if (bitdelay_us) {
-          delayMicroseconds(bitdelay_us);
-        }
+/*!
+ *    @brief  Pick the software SPI loop matching the data mode and bit
+ * order, so no mode or order test is left in the bit loop
+ */
+void Adafruit_SPIDevice::selectSoftTransfer(void) {
+  bool lsb = (_dataOrder == SPI_BITORDER_LSBFIRST);
+  uint32_t halfPeriodUs = (1000000 / _freq) / 2; // until calibrated
+
+  _bitDelayUs = (halfPeriodUs > 255) ? 255 : halfPeriodUs;
+
+  if (_dataMode == SPI_MODE3) {
+    _softTransfer = lsb ? &Adafruit_SPIDevice::softTransfer<SOFT_MODE3, true>
+                        : &Adafruit_SPIDevice::softTransfer<SOFT_MODE3, false>;
+  } else if (_dataMode == SPI_MODE1) {
+    _softTransfer = lsb ? &Adafruit_SPIDevice::softTransfer<SOFT_MODE1, true>
+                        : &Adafruit_SPIDevice::softTransfer<SOFT_MODE1, false>;
+  } else {
+    _softTransfer = lsb ? &Adafruit_SPIDevice::softTransfer<SOFT_MODE0, true>
+                        : &Adafruit_SPIDevice::softTransfer<SOFT_MODE0, false>;
+  }
+}
 
-        if (_mosi != -1) {
-          BUSIO_WRITE_MOSI(send & b);
-        }
+/*!
+ *    @brief  Set the pause per clock phase of software SPI from the time the
+ * loop itself takes, measured with CS deasserted, so the clock gets close to
+ * the requested frequency instead of adding a full half period on top of the
+ * pin I/O cost
+ */
+void Adafruit_SPIDevice::calibrateSoftTransfer(void) {
+  uint32_t periodNs = 1000000000UL / _freq;
+  uint8_t dummy[8];
+
+  if (periodNs <= 2000) {
+    // 500 kHz and up: a 1 us pause per phase alone would take the whole
+    // period, so clock as fast as the pin I/O allows
+    _bitDelayUs = 0;
+    return;
+  }
 
-        BUSIO_SET_CLOCK_LOW();
+  memset(dummy, 0xFF, sizeof(dummy)); // keep MOSI at its idle level
+  uint32_t start = micros();
+  _bitDelayUs = 0;
+  (this->*_softTransfer)(dummy, sizeof(dummy));
+  uint32_t loopNs = (micros() - start) * 1000UL / (sizeof(dummy) * 8);
 
-        if (_miso != -1) {
-          if (BUSIO_READ_MISO()) {
-            reply |= b;
-          }
-        }
-      }
-    }
-    if (_miso != -1) {
-      buffer[i] = reply;
-    }
+  if (periodNs > loopNs) {
+    uint32_t pause = (periodNs - loopNs) / 2000; // two phases per bit
+    _bitDelayUs = (pause > 255) ? 255 : pause;
   }
-  return;
 }
 
 /*!
@@ -333,6 +384,40 @@ void Adafruit_SPIDevice::endTransactionWithDeassertingCS() {
   endTransaction();
 }
 
+/*!
+ *    @brief  Send a buffer over hard/soft SPI with buffer-level transfers,
+ * discarding the received bytes, without transaction management
+ *    @param  buffer The buffer to send, left unchanged
+ *    @param  len    The number of bytes to send
+ */
+void Adafruit_SPIDevice::transmit(const uint8_t *buffer, size_t len) {
+  if (len == 0) {
+    return;
+  }
+#if defined(ARDUINO_ARCH_ESP32)
+  if (_spi) {
+    _spi->transferBytes((uint8_t *)buffer, nullptr, len);
+    return;
+  }
+#elif defined(SPARK)
+  if (_spi) {
+    _spi->transfer((void *)buffer, nullptr, len, nullptr);
+    return;
+  }
+#endif
+
+  // transfer() overwrites its buffer with the received bytes, so the data
+  // goes through a stack copy, one chunk per transfer() call
+  uint8_t chunk[BUSIO_SPI_CHUNK_SIZE];
+  while (len > 0) {
+    size_t n = (len < sizeof(chunk)) ? len : sizeof(chunk);
+    memcpy(chunk, buffer, n);
+    transfer(chunk, n);
+    buffer += n;
+    len -= n;
+  }
+}
+
 /*!
  *    @brief  Write a buffer or two to the SPI device, with transaction
  * management.
@@ -350,24 +435,8 @@ bool Adafruit_SPIDevice::write(const uint8_t *buffer, size_t len,
   beginTransactionWithAssertingCS();
 
   // do the writing
-#if defined(ARDUINO_ARCH_ESP32)
-  if (_spi) {
-    if (prefix_len > 0) {
-      _spi->transferBytes((uint8_t *)prefix_buffer, nullptr, prefix_len);
-    }
-    if (len > 0) {
-      _spi->transferBytes((uint8_t *)buffer, nullptr, len);
-    }
-  } else
-#endif
-  {
-    for (size_t i = 0; i < prefix_len; i++) {
-      transfer(prefix_buffer[i]);
-    }
-    for (size_t i = 0; i < len; i++) {
-      transfer(buffer[i]);
-    }
-  }
+  transmit(prefix_buffer, prefix_len);
+  transmit(buffer, len);
   endTransactionWithDeassertingCS();
 
 #ifdef DEBUG_SERIAL
@@ -444,18 +513,7 @@ bool Adafruit_SPIDevice::write_then_read(const uint8_t *write_buffer,
                                          size_t read_len, uint8_t sendvalue) {
   beginTransactionWithAssertingCS();
   // do the writing
-#if defined(ARDUINO_ARCH_ESP32)
-  if (_spi) {
-    if (write_len > 0) {
-      _spi->transferBytes((uint8_t *)write_buffer, nullptr, write_len);
-    }
-  } else
-#endif
-  {
-    for (size_t i = 0; i < write_len; i++) {
-      transfer(write_buffer[i]);
-    }
-  }
+  transmit(write_buffer, write_len);
 
 #ifdef DEBUG_SERIAL
   DEBUG_SERIAL.print(F("\tSPIDevice Wrote: "));
@@ -470,10 +528,9 @@ bool Adafruit_SPIDevice::write_then_read(const uint8_t *write_buffer,
   DEBUG_SERIAL.println();
 #endif
 
-  // do the reading
-  for (size_t i = 0; i < read_len; i++) {
-    read_buffer[i] = transfer(sendvalue);
-  }
+  // do the reading, in one buffer transfer
+  memset(read_buffer, sendvalue, read_len);
+  transfer(read_buffer, read_len);
 
 #ifdef DEBUG_SERIAL
   DEBUG_SERIAL.print(F("\tSPIDevice Read: "));
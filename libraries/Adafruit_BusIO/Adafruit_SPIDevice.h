@@ -46,6 +46,11 @@ typedef enum _BitOrder {
 typedef BitOrder BusIOBitOrder;
 #endif
 
+#ifndef BUSIO_SPI_CHUNK_SIZE
+/// Stack bytes used to send const buffers with a buffer-level transfer()
+#define BUSIO_SPI_CHUNK_SIZE 32
+#endif
+
 #if defined(__IMXRT1062__) // Teensy 4.x
 // *Warning* I disabled the usage of FAST_PINIO as the set/clear operations
 // used in the cpp file are not atomic and can effect multiple IO pins
@@ -137,6 +142,19 @@ private:
   BusIOBitOrder _dataOrder;
   uint8_t _dataMode;
   void setChipSelect(int value);
+  void transmit(const uint8_t *buffer, size_t len);
+
+  // Software SPI: clock edges of each mode, see softBit()
+  enum SoftEdges : uint8_t { SOFT_MODE0, SOFT_MODE1, SOFT_MODE3 };
+  typedef void (Adafruit_SPIDevice::*SoftTransfer)(uint8_t *buffer,
+                                                   size_t len);
+  SoftTransfer _softTransfer = nullptr; ///< Loop for the mode and bit order
+  uint8_t _bitDelayUs = 0;              ///< Pause per clock phase
+  void selectSoftTransfer(void);
+  void calibrateSoftTransfer(void);
+  template <uint8_t edges> bool softBit(bool out, bool &lastmosi);
+  template <uint8_t edges, bool lsbFirst>
+  void softTransfer(uint8_t *buffer, size_t len);
 
   int8_t _cs, _sck, _mosi, _miso;
 #ifdef BUSIO_USE_FAST_PINIO
@@ -0,0 +1,54 @@
+#include <Adafruit_BusIO_Register.h>
+#include <Adafruit_I2CDevice.h>
+
+#define I2C_ADDRESS 0x60
+Adafruit_I2CDevice i2c_dev = Adafruit_I2CDevice(I2C_ADDRESS);
+
+// A configuration register split in bit fields
+Adafruit_BusIO_Register config_reg = Adafruit_BusIO_Register(&i2c_dev, 0x01);
+Adafruit_BusIO_RegisterBits mode_bits =
+    Adafruit_BusIO_RegisterBits(&config_reg, 2, 0);
+Adafruit_BusIO_RegisterBits gain_bits =
+    Adafruit_BusIO_RegisterBits(&config_reg, 3, 2);
+Adafruit_BusIO_RegisterBits enable_bit =
+    Adafruit_BusIO_RegisterBits(&config_reg, 1, 7);
+
+void configure(uint8_t mode, uint8_t gain) {
+  config_reg.resetCounters();
+  mode_bits.write(mode);
+  gain_bits.write(gain);
+  enable_bit.write(1);
+  Serial.print("  bus reads: ");
+  Serial.print(config_reg.busReads());
+  Serial.print(", bus writes: ");
+  Serial.println(config_reg.busWrites());
+}
+
+void setup() {
+  while (!Serial) {
+    delay(10);
+  }
+  Serial.begin(115200);
+  Serial.println("I2C register shadow test");
+
+  if (!i2c_dev.begin()) {
+    Serial.print("Did not find device at 0x");
+    Serial.println(i2c_dev.address(), HEX);
+    while (1)
+      ;
+  }
+
+  // Every bit field write reads the register first
+  Serial.println("Without shadow copy:");
+  configure(1, 5);
+
+  // Only the first write reads the register, the others use the copy
+  config_reg.enableShadow();
+  Serial.println("With shadow copy:");
+  configure(2, 3);
+
+  Serial.print("Config register = 0x");
+  Serial.println(config_reg.read(), HEX);
+}
+
+void loop() {}
@@ -27,6 +27,30 @@
 
     @section  HISTORY
 
+    v2.9 - Added abortCommand() to drop a pending command with an ACK frame
+
+    v2.8 - PN532_IRQ_NONE tells the I2C constructor that the IRQ line is
+            not wired. A declared IRQ pin that never goes low is detected on
+            I2C by the RDY byte, which is still polled as a fallback
+
+    v2.7 - HSU responses are read by frame length rather than by Stream
+            timeout, and setSerialSpeed() raises the HSU baud rate with
+            SetSerialBaudRate up to 1.288 Mbaud
+
+    v2.6 - Each I2C response is read in one transaction at most as long as
+            the Wire buffer, straight into the packet buffer, and
+            setI2CSpeed() raises the I2C clock as far as the bus carries it
+
+    v2.5 - Each instance owns its packet buffer (PN532_PACKBUFFSIZ) and IRQ
+            flag, so several readers can run in parallel
+
+    v2.4 - Added startAutoPoll() and readAutoPoll() (InAutoPoll) to wait for
+            a card with no host bus traffic, and statusPolls()
+
+    v2.3 - Added startCommand(), isCommandDone() and finishCommand() to run
+            any command without blocking, with an optional callback through
+            setCommandCallback() and serviceCommand()
+
     v2.2 - Added startPassiveTargetIDDetection() to start card detection and
             readDetectedPassiveTargetID() to read it, useful when using the
             IRQ pin.
@@ -59,9 +83,9 @@
 
 #include "Adafruit_PN532.h"
 
-byte pn532ack[] = {0x00, 0x00, 0xFF,
-                   0x00, 0xFF, 0x00}; ///< ACK message from PN532
-byte pn532response_firmwarevers[] = {
+static const byte pn532ack[] = {0x00, 0x00, 0xFF,
+                                0x00, 0xFF, 0x00}; ///< ACK message from PN532
+static const byte pn532response_firmwarevers[] = {
     0x00, 0x00, 0xFF,
     0x06, 0xFA, 0xD5}; ///< Expected firmware version message from PN532
 
@@ -75,9 +99,39 @@ byte pn532response_firmwarevers[] = {
 #define PN532DEBUGPRINT Serial ///< Fixed name for debug Serial instance
 // #define PN532DEBUGPRINT SerialUSB ///< Fixed name for debug Serial instance
 
-#define PN532_PACKBUFFSIZ 255                ///< Packet buffer size in bytes
-byte pn532_packetbuffer[PN532_PACKBUFFSIZ]; ///< Packet buffer used in various
-                                            ///< transactions
+static volatile bool *volatile pn532_irqFlags[PN532_IRQ_SLOTS] = {
+    NULL}; ///< IRQ flag of the instance attached to each interrupt handler
+
+/**************************************************************************/
+/*!
+    @brief  IRQ pin interrupt handlers, one per slot since attachInterrupt()
+            passes no context: the PN532 pulls IRQ low when an ACK or a
+            response frame is ready to be read
+*/
+/**************************************************************************/
+static void pn532_irqHandler0(void) { *pn532_irqFlags[0] = true; }
+static void pn532_irqHandler1(void) { *pn532_irqFlags[1] = true; }
+static void pn532_irqHandler2(void) { *pn532_irqFlags[2] = true; }
+static void pn532_irqHandler3(void) { *pn532_irqFlags[3] = true; }
+
+static void (*const pn532_irqHandlers[PN532_IRQ_SLOTS])(void) = {
+    pn532_irqHandler0, pn532_irqHandler1, pn532_irqHandler2,
+    pn532_irqHandler3}; ///< Handler of each slot of pn532_irqFlags
+
+static const uint32_t pn532_baudrates[] = {
+    9600,   19200,  38400,  57600,  115200,
+    230400, 460800, 921600, 1288000}; ///< HSU baud rate of each
+                                      ///< SetSerialBaudRate code
+
+/**************************************************************************/
+/*!
+    @brief  Byte i of line test number probe: a counter, inverted on odd
+            bytes so that consecutive bytes toggle most bits
+*/
+/**************************************************************************/
+static uint8_t pn532_linetestbyte(uint8_t probe, uint8_t i) {
+  return (uint8_t)((i * 0x3B) + (probe * 0x55)) ^ ((i & 1) ? 0xFF : 0x00);
+}
 
 /**************************************************************************/
 /*!
@@ -100,14 +154,19 @@ Adafruit_PN532::Adafruit_PN532(uint8_t clk, uint8_t miso, uint8_t mosi,
 /*!
     @brief  Instantiates a new PN532 class using I2C.
 
-    @param  irq       Location of the IRQ pin
+    @param  irq       Location of the IRQ pin, or PN532_IRQ_NONE if it is
+                      not wired: readiness is then polled with the RDY byte.
+                      The pin is pulled up, so a pin left unconnected reads
+                      high and is detected by the RDY fallback of isready()
     @param  reset     Location of the RSTPD_N pin
     @param  theWire   pointer to I2C bus to use
 */
 /**************************************************************************/
 Adafruit_PN532::Adafruit_PN532(uint8_t irq, uint8_t reset, TwoWire *theWire)
-    : _irq(irq), _reset(reset) {
-  pinMode(_irq, INPUT);
+    : _irq((irq == PN532_IRQ_NONE) ? -1 : (int8_t)irq), _reset(reset) {
+  if (_irq != -1) {
+    pinMode(_irq, INPUT_PULLUP);
+  }
   pinMode(_reset, OUTPUT);
   i2c_dev = new Adafruit_I2CDevice(PN532_I2C_ADDRESS, theWire);
 }
@@ -160,7 +219,9 @@ bool Adafruit_PN532::begin() {
       return false;
     }
   } else if (ser_dev) {
-    ser_dev->begin(115200);
+    // after the reset below, the PN532 is back to its default baud rate
+    _baud = PN532_HSU_DEFAULT_BAUD;
+    ser_dev->begin(_baud);
     // clear out anything in read buffer
     while (ser_dev->available())
       ser_dev->read();
@@ -171,9 +232,60 @@ bool Adafruit_PN532::begin() {
   reset(); // HW reset - put in known state
   delay(10);
   wakeup(); // hey! wakeup!
+  attachIrq();
   return true;
 }
 
+/**************************************************************************/
+/*!
+    @brief  Detaches the IRQ interrupt of this instance, if any.
+*/
+/**************************************************************************/
+Adafruit_PN532::~Adafruit_PN532() { detachIrq(); }
+
+/**************************************************************************/
+/*!
+    @brief  Releases the IRQ interrupt slot of this instance, if it has one.
+*/
+/**************************************************************************/
+void Adafruit_PN532::detachIrq() {
+  for (uint8_t i = 0; i < PN532_IRQ_SLOTS; i++) {
+    if (pn532_irqFlags[i] == &_irqFlag) {
+      detachInterrupt(digitalPinToInterrupt(_irq));
+      pn532_irqFlags[i] = NULL;
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Routes the falling edge of the IRQ pin, if wired, to the
+            interrupt flag of this instance so isready() does not need a bus
+            transaction. Up to PN532_IRQ_SLOTS instances get an interrupt;
+            the others, and boards where the pin has no interrupt, read the
+            IRQ level instead.
+*/
+/**************************************************************************/
+void Adafruit_PN532::attachIrq() {
+  if (_irq == -1) {
+    return;
+  }
+#ifdef NOT_AN_INTERRUPT
+  if (digitalPinToInterrupt(_irq) == NOT_AN_INTERRUPT) {
+    return;
+  }
+#endif
+  for (uint8_t i = 0; i < PN532_IRQ_SLOTS; i++) {
+    if ((pn532_irqFlags[i] == NULL) || (pn532_irqFlags[i] == &_irqFlag)) {
+      _irqFlag = false;
+      pn532_irqFlags[i] = &_irqFlag;
+      attachInterrupt(digitalPinToInterrupt(_irq), pn532_irqHandlers[i],
+                      FALLING);
+      return;
+    }
+  }
+}
+
 /**************************************************************************/
 /*!
     @brief  Perform a hardware reset. Requires reset pin to have been provided.
@@ -288,7 +400,7 @@ uint32_t Adafruit_PN532::getFirmwareVersion(void) {
 
   // check some basic stuff
   if (0 != memcmp((char *)pn532_packetbuffer,
-                  (char *)pn532response_firmwarevers, 6)) {
+                  (const char *)pn532response_firmwarevers, 6)) {
 #ifdef PN532DEBUG
     PN532DEBUGPRINT.println(F("Firmware doesn't match!"));
 #endif
@@ -322,19 +434,26 @@ uint32_t Adafruit_PN532::getFirmwareVersion(void) {
 // default timeout of one second
 bool Adafruit_PN532::sendCommandCheckAck(uint8_t *cmd, uint8_t cmdlen,
                                          uint16_t timeout) {
-
-  // I2C works without using IRQ pin by polling for RDY byte
-  // seems to work best with some delays between transactions
-  uint8_t SLOWDOWN = 0;
-  if (i2c_dev || spi_dev) // SPI and I2C need 1ms slow for page reads
-    SLOWDOWN = 1;
-
   // write the command
   writecommand(cmd, cmdlen);
 
-  // I2C TUNING
-  delay(SLOWDOWN);
+  return waitCommandAck(timeout);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Waits for the PN532 to acknowledge the command just written and,
+            unless told otherwise, for its response to be ready
+
+    @param  timeout       timeout before giving up
+    @param  waitResponse  false to return as soon as the ACK is read, leaving
+                          the response to be polled with isResponseReady()
 
+    @returns  1 if everything is OK, 0 if timeout occured before an
+              ACK was recieved
+*/
+/**************************************************************************/
+bool Adafruit_PN532::waitCommandAck(uint16_t timeout, bool waitResponse) {
   // Wait for chip to say its ready!
   if (!waitready(timeout)) {
     return false;
@@ -354,11 +473,8 @@ bool Adafruit_PN532::sendCommandCheckAck(uint8_t *cmd, uint8_t cmdlen,
     return false;
   }
 
-  // I2C TUNING
-  delay(SLOWDOWN);
-
   // Wait for chip to say its ready!
-  if (!waitready(timeout)) {
+  if (waitResponse && !waitready(timeout)) {
     return false;
   }
 
@@ -493,19 +609,43 @@ uint8_t Adafruit_PN532::readGPIO(void) {
 */
 /**************************************************************************/
 bool Adafruit_PN532::SAMConfig(void) {
+  if (!startSAMConfig())
+    return false;
+
+  return finishSAMConfig();
+}
+
+/**************************************************************************/
+/*!
+    @brief   Starts configuring the SAM (Secure Access Module) without
+             waiting for the PN532 to answer; complete it with
+             finishSAMConfig()
+    @return  true if the command was acknowledged, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::startSAMConfig(void) {
   pn532_packetbuffer[0] = PN532_COMMAND_SAMCONFIGURATION;
   pn532_packetbuffer[1] = 0x01; // normal mode;
   pn532_packetbuffer[2] = 0x14; // timeout 50ms * 20 = 1 second
   pn532_packetbuffer[3] = 0x01; // use IRQ pin!
 
-  if (!sendCommandCheckAck(pn532_packetbuffer, 4))
-    return false;
+  return startCommand(pn532_packetbuffer, 4, 100);
+}
 
-  // read data packet
-  readdata(pn532_packetbuffer, 9);
+/**************************************************************************/
+/*!
+    @brief   Waits for and checks the answer to startSAMConfig()
+    @param   timeout  Timeout in ms to wait for the answer
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::finishSAMConfig(uint16_t timeout) {
+  if (!_commandPending ||
+      (_pendingCommand != PN532_COMMAND_SAMCONFIGURATION)) {
+    return false;
+  }
 
-  int offset = 6;
-  return (pn532_packetbuffer[offset] == 0x15);
+  return finishCommand(NULL, 0, timeout) == 0;
 }
 
 /**************************************************************************/
@@ -537,6 +677,287 @@ bool Adafruit_PN532::setPassiveActivationRetries(uint8_t maxRetries) {
   return 1;
 }
 
+/**************************************************************************/
+/*!
+    @brief  Raises the I2C clock as far as the bus carries it: from
+            PN532_I2C_FASTPLUS_HZ down to PN532_I2C_STANDARD_HZ, the first
+            speed not above maxSpeed that passes PN532_LINE_TEST_PROBES
+            communication line tests is kept. A NACK shows as a missing
+            ACK frame and corruption as a bad checksum or echo, and both
+            make the next lower speed tried.
+
+    @param  maxSpeed  Highest I2C clock to try, in Hz
+
+    @returns The I2C clock in use, or 0 if no speed passed or the platform
+             cannot set the clock
+*/
+/**************************************************************************/
+uint32_t Adafruit_PN532::setI2CSpeed(uint32_t maxSpeed) {
+  static const uint32_t speeds[] = {PN532_I2C_FASTPLUS_HZ, PN532_I2C_FAST_HZ,
+                                    PN532_I2C_STANDARD_HZ};
+
+  if (!i2c_dev) {
+    return 0;
+  }
+
+  for (uint8_t i = 0; i < sizeof(speeds) / sizeof(speeds[0]); i++) {
+    if ((speeds[i] <= maxSpeed) && i2c_dev->setSpeed(speeds[i]) &&
+        checkline()) {
+#ifdef PN532DEBUG
+      PN532DEBUGPRINT.print(F("I2C clock "));
+      PN532DEBUGPRINT.println(speeds[i]);
+#endif
+      return speeds[i];
+    }
+  }
+
+  return 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Raises the HSU baud rate with SetSerialBaudRate: from
+            PN532_HSU_MAX_BAUD down to PN532_HSU_DEFAULT_BAUD, the first rate
+            not above maxBaud that the host UART and the PN532 agree on, as
+            shown by PN532_LINE_TEST_PROBES communication line tests, is
+            kept. After a failed attempt the PN532 is reset back to its
+            default rate with begin(), so the reset pin must be wired for
+            the fallback to work.
+
+    @param  maxBaud   Highest baud rate to try
+
+    @returns The baud rate in use, or 0 if the HSU is not in use or the
+             link does not work even at the default rate
+*/
+/**************************************************************************/
+uint32_t Adafruit_PN532::setSerialSpeed(uint32_t maxBaud) {
+  if (!ser_dev) {
+    return 0;
+  }
+
+  for (int8_t code = sizeof(pn532_baudrates) / sizeof(pn532_baudrates[0]) - 1;
+       (code >= 0) && (pn532_baudrates[code] >= PN532_HSU_DEFAULT_BAUD);
+       code--) {
+    uint32_t baud = pn532_baudrates[code];
+    if (baud > maxBaud) {
+      continue;
+    }
+    if (((baud == _baud) || switchbaudrate(code)) && checkline()) {
+#ifdef PN532DEBUG
+      PN532DEBUGPRINT.print(F("HSU baud rate "));
+      PN532DEBUGPRINT.println(baud);
+#endif
+      return baud;
+    }
+    begin(); // back to the default rate
+  }
+
+  return 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Switches the PN532 and the host UART to the baud rate of a
+            SetSerialBaudRate code. The PN532 answers at the old rate and
+            changes rate once the host acknowledges the answer with an ACK
+            frame.
+
+    @param  code      Index in pn532_baudrates
+    @return true if the PN532 accepted the rate
+*/
+/**************************************************************************/
+bool Adafruit_PN532::switchbaudrate(uint8_t code) {
+  pn532_packetbuffer[0] = PN532_COMMAND_SETSERIALBAUDRATE;
+  pn532_packetbuffer[1] = code;
+
+  if (!startframe(pn532_packetbuffer, 2, 100) || (readresponse(100) != 0)) {
+    return false;
+  }
+
+  ser_dev->write(pn532ack, sizeof(pn532ack));
+  ser_dev->flush(); // the ACK must leave at the old rate
+  delay(1);         // time for the PN532 to switch
+
+  _baud = pn532_baudrates[code];
+  ser_dev->begin(_baud);
+  while (ser_dev->available()) {
+    ser_dev->read();
+  }
+
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Runs PN532_LINE_TEST_PROBES Diagnose communication line tests:
+            the PN532 echoes PN532_LINE_TEST_LENGTH bytes of alternating
+            bit patterns, which must come back unchanged
+
+    @returns true if every echo was received intact
+*/
+/**************************************************************************/
+bool Adafruit_PN532::checkline() {
+  for (uint8_t probe = 0; probe < PN532_LINE_TEST_PROBES; probe++) {
+    pn532_packetbuffer[0] = PN532_COMMAND_DIAGNOSE;
+    pn532_packetbuffer[1] = 0x00; // communication line test
+    for (uint8_t i = 0; i < PN532_LINE_TEST_LENGTH; i++) {
+      pn532_packetbuffer[2 + i] = pn532_linetestbyte(probe, i);
+    }
+
+    if (!startframe(pn532_packetbuffer, 2 + PN532_LINE_TEST_LENGTH,
+                    PN532_LINE_TEST_TIMEOUT) ||
+        (readresponse(PN532_LINE_TEST_TIMEOUT) !=
+         1 + PN532_LINE_TEST_LENGTH)) {
+      return false;
+    }
+
+    // Response: test number, then the echoed data
+    for (uint8_t i = 0; i < PN532_LINE_TEST_LENGTH; i++) {
+      if (pn532_packetbuffer[8 + i] != pn532_linetestbyte(probe, i)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+/***** Asynchronous Commands ******/
+
+/**************************************************************************/
+/*!
+    @brief   Sends a command and returns as soon as the PN532 acknowledged it,
+             leaving the PN532 to execute it while the host is free. Poll
+             isCommandDone() or use setCommandCallback(), then collect the
+             answer with finishCommand(). Writing another command drops the
+             pending one.
+
+    @param   cmd      Command code followed by its parameters
+    @param   cmdlen   Command length in bytes
+    @param   timeout  Timeout in ms to wait for the ACK
+    @return  true if the command was acknowledged, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::startCommand(uint8_t *cmd, uint8_t cmdlen,
+                                  uint16_t timeout) {
+  // Commands built in the packet buffer already have the frame room around
+  // them; others are staged there first
+  if (cmd != pn532_packetbuffer) {
+    memmove(pn532_packetbuffer, cmd, cmdlen);
+  }
+
+  return startframe(pn532_packetbuffer, cmdlen, timeout);
+}
+
+/**************************************************************************/
+/*!
+    @brief   Tells whether the command started with startCommand() has its
+             response ready, i.e. finishCommand() would not block.
+
+    @return  true if a response is ready, false if the PN532 is still busy or
+             no command is pending.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::isCommandDone() { return _commandPending && isready(); }
+
+/**************************************************************************/
+/*!
+    @brief   Waits for and reads the response to the command started with
+             startCommand(). The response code is checked against the
+             command; the data after it is copied to response.
+
+    @param   response        Buffer receiving the response data, may be NULL
+                             if responseLength is 0
+    @param   responseLength  Size of response
+    @param   timeout         Timeout in ms to wait for the response (0 waits
+                             forever). On timeout the command stays pending.
+    @return  Number of response data bytes, or -1 on timeout, on an invalid
+             or unexpected frame, or if the data does not fit in response.
+*/
+/**************************************************************************/
+int16_t Adafruit_PN532::finishCommand(uint8_t *response,
+                                      uint8_t responseLength,
+                                      uint16_t timeout) {
+  int16_t length = readresponse(timeout);
+
+  if (length > responseLength) {
+    return -1;
+  }
+  if (length > 0) {
+    memcpy(response, pn532_packetbuffer + 7, length);
+  }
+
+  return length;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Aborts the pending command by sending an ACK frame, as the
+             PN532 user manual prescribes for a command whose answer the
+             host gives up on. The PN532 drops it and takes the next command
+             at once; a command written while it is still busy would be lost.
+
+    @return  true if a command was pending, false if there was nothing to
+             abort (no frame is sent then).
+*/
+/**************************************************************************/
+bool Adafruit_PN532::abortCommand() {
+  if (!_commandPending) {
+    return false;
+  }
+
+  _irqFlag = false;
+  _commandPending = false;
+
+  if (spi_dev) {
+    uint8_t frame[1 + sizeof(pn532ack)];
+    frame[0] = PN532_SPI_DATAWRITE;
+    memcpy(frame + 1, pn532ack, sizeof(pn532ack));
+    spi_dev->write(frame, sizeof(frame));
+  } else if (i2c_dev) {
+    i2c_dev->write(pn532ack, sizeof(pn532ack));
+  } else if (ser_dev) {
+    ser_dev->write(pn532ack, sizeof(pn532ack));
+  }
+
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Sets the function serviceCommand() calls once the pending
+             command has its response ready. The callback is expected to
+             collect the response, with finishCommand() or the matching read
+             function.
+
+    @param   callback  Function to call, NULL to disable
+    @param   context   Value passed to callback
+*/
+/**************************************************************************/
+void Adafruit_PN532::setCommandCallback(PN532CommandCallback callback,
+                                        void *context) {
+  _commandCallback = callback;
+  _commandContext = context;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Calls the command callback if the pending command has its
+             response ready. Meant to be called from loop(); with the IRQ pin
+             wired it costs a pin read.
+
+    @return  true if the callback was called, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::serviceCommand() {
+  if ((_commandCallback == NULL) || !isCommandDone()) {
+    return false;
+  }
+
+  _commandCallback(_commandContext);
+  return true;
+}
+
 /***** ISO14443A Commands ******/
 
 /**************************************************************************/
@@ -650,166 +1071,550 @@ bool Adafruit_PN532::readDetectedPassiveTargetID(uint8_t *uid,
   PN532DEBUGPRINT.println();
 #endif
 
-  return 1;
-}
+  return 1;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Exchanges an APDU with the currently inlisted peer
+
+    @param   send            Pointer to data to send
+    @param   sendLength      Length of the data to send
+    @param   response        Pointer to response data
+    @param   responseLength  Pointer to the response data length
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::inDataExchange(uint8_t *send, uint8_t sendLength,
+                                    uint8_t *response,
+                                    uint8_t *responseLength) {
+  if (!startDataExchange(send, sendLength)) {
+    return false;
+  }
+
+  return readDataExchangeResponse(response, responseLength);
+}
+
+/**************************************************************************/
+/*!
+    @brief   Exchanges an APDU with the currently inlisted peer, accepting a
+             response longer than 255 bytes
+
+    @param   send            Pointer to data to send
+    @param   sendLength      Length of the data to send
+    @param   response        Pointer to response data
+    @param   responseLength  Pointer to the response data length
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::inDataExchange(uint8_t *send, uint8_t sendLength,
+                                    uint8_t *response,
+                                    uint16_t *responseLength) {
+  if (!startDataExchange(send, sendLength)) {
+    return false;
+  }
+
+  return readDataExchangeResponse(response, responseLength);
+}
+
+/**************************************************************************/
+/*!
+    @brief   Sends an APDU to the currently inlisted peer without waiting
+             for the answer. The PN532 keeps exchanging with the card while
+             the host is free; collect the answer with
+             readDataExchangeResponse().
+
+    @param   send            Pointer to data to send
+    @param   sendLength      Length of the data to send
+    @return  true if the command was acknowledged, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::startDataExchange(uint8_t *send, uint8_t sendLength) {
+  if (sendLength > PN532_PACKBUFFSIZ - 2) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("APDU length too long for packet buffer"));
+#endif
+    return false;
+  }
+
+  // Stage the APDU after InDataExchange and Tg; the packet buffer has the
+  // frame room around it
+  memmove(pn532_packetbuffer + 2, send, sendLength);
+
+  return startDataExchangeInPlace(pn532_packetbuffer + 2, sendLength);
+}
+
+/**************************************************************************/
+/*!
+    @brief   Exchanges an APDU with the currently inlisted peer, building the
+             PN532 frame in place around it
+
+    @param   send            Pointer to data to send, preceded by
+                             PN532_DATAEXCHANGE_HEADROOM and followed by
+                             PN532_FRAME_TAILROOM writable bytes
+    @param   sendLength      Length of the data to send
+    @param   response        Pointer to response data
+    @param   responseLength  Pointer to the response data length
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::inDataExchangeInPlace(uint8_t *send, uint8_t sendLength,
+                                           uint8_t *response,
+                                           uint8_t *responseLength) {
+  if (!startDataExchangeInPlace(send, sendLength)) {
+    return false;
+  }
+
+  return readDataExchangeResponse(response, responseLength);
+}
+
+/**************************************************************************/
+/*!
+    @brief   Exchanges an APDU like inDataExchangeInPlace(), accepting a
+             response longer than 255 bytes
+
+    @param   send            Pointer to data to send, preceded by
+                             PN532_DATAEXCHANGE_HEADROOM and followed by
+                             PN532_FRAME_TAILROOM writable bytes
+    @param   sendLength      Length of the data to send
+    @param   response        Pointer to response data
+    @param   responseLength  Pointer to the response data length
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::inDataExchangeInPlace(uint8_t *send, uint8_t sendLength,
+                                           uint8_t *response,
+                                           uint16_t *responseLength) {
+  if (!startDataExchangeInPlace(send, sendLength)) {
+    return false;
+  }
+
+  return readDataExchangeResponse(response, responseLength);
+}
+
+/**************************************************************************/
+/*!
+    @brief   Sends an APDU like startDataExchange(), without copying it: the
+             InDataExchange header and the PN532 frame are written into the
+             room around the APDU and the whole buffer goes to the bus.
+             The APDU bytes are left unchanged.
+
+             With more set, the data is one part of a longer APDU: the MI bit
+             in Tg makes the PN532 chain it to the card, and the response is
+             a bare status once the card acknowledged the part. The next part
+             follows with another call; the last one, without more, gets the
+             card's response.
+
+    @param   send            Pointer to data to send, preceded by
+                             PN532_DATAEXCHANGE_HEADROOM and followed by
+                             PN532_FRAME_TAILROOM writable bytes
+    @param   sendLength      Length of the data to send
+    @param   more            true if more parts of the APDU follow
+    @return  true if the command was acknowledged, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::startDataExchangeInPlace(uint8_t *send,
+                                              uint8_t sendLength, bool more) {
+  if (sendLength > PN532_PACKBUFFSIZ - 2) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("APDU length too long for packet buffer"));
+#endif
+    return false;
+  }
+
+  uint8_t *cmd = send - 2;
+  cmd[0] = PN532_COMMAND_INDATAEXCHANGE;
+  cmd[1] = _inListedTag | (more ? PN532_STATUS_MI : 0);
+
+  if (!startframe(cmd, sendLength + 2, 1000)) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Could not send APDU"));
+#endif
+    return false;
+  }
+
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Waits for and reads the answer to a data exchange started with
+             startDataExchange()
+
+    @param   response        Pointer to response data
+    @param   responseLength  Pointer to the response data length
+    @param   timeout         Timeout in ms to wait for the answer
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::readDataExchangeResponse(uint8_t *response,
+                                              uint8_t *responseLength,
+                                              uint16_t timeout) {
+  uint16_t length = *responseLength;
+
+  if (!readDataExchangeResponse(response, &length, timeout)) {
+    return false;
+  }
+
+  *responseLength = length;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Waits for and reads the answer to a data exchange started with
+             startDataExchange(), reassembling a response the card chained
+             over several frames: while the status has the MI bit set, an
+             InDataExchange without data asks the PN532 for the next part,
+             which is appended to response.
+
+    @param   response        Pointer to response data
+    @param   responseLength  Input: size of response; Output: length of the
+                             whole response
+    @param   timeout         Timeout in ms to wait for each part
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::readDataExchangeResponse(uint8_t *response,
+                                              uint16_t *responseLength,
+                                              uint16_t timeout) {
+  uint16_t total = 0;
+  bool more = true;
+
+  while (more) {
+    int16_t length = readresponse(timeout);
+
+    if (length < 1) {
+#ifdef PN532DEBUG
+      PN532DEBUGPRINT.println(F("Response never received for APDU..."));
+#endif
+      return false;
+    }
+
+    uint8_t status = pn532_packetbuffer[7];
+    if ((status & PN532_STATUS_ERROR_MASK) != 0) {
+#ifdef PN532DEBUG
+      PN532DEBUGPRINT.println(F("Status code indicates an error"));
+#endif
+      return false;
+    }
+
+    length -= 1;
+
+    if ((uint16_t)length > (*responseLength - total)) {
+#ifdef PN532DEBUG
+      PN532DEBUGPRINT.println(F("Response too long for buffer"));
+#endif
+      return false;
+    }
+
+    memcpy(response + total, pn532_packetbuffer + 8, length);
+    total += length;
+
+    more = (status & PN532_STATUS_MI) != 0;
+    if (more) {
+      pn532_packetbuffer[0] = PN532_COMMAND_INDATAEXCHANGE;
+      pn532_packetbuffer[1] = _inListedTag;
+
+      if (!startCommand(pn532_packetbuffer, 2, 1000)) {
+        return false;
+      }
+    }
+  }
+
+  *responseLength = total;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief   'InLists' a passive target. PN532 acting as reader/initiator,
+             peer acting as card/responder.
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::inListPassiveTarget() {
+  if (!startInListPassiveTarget()) {
+    return false;
+  }
+
+  return readInListPassiveTarget(30000);
+}
+
+/**************************************************************************/
+/*!
+    @brief   Starts 'InListing' a passive target without waiting for a card.
+             The PN532 keeps polling the field on its own; the host can check
+             isResponseReady() and collect the target with
+             readInListPassiveTarget().
+    @return  true if the command was acknowledged, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::startInListPassiveTarget() {
+  pn532_packetbuffer[0] = PN532_COMMAND_INLISTPASSIVETARGET;
+  pn532_packetbuffer[1] = 1;
+  pn532_packetbuffer[2] = 0;
+
+#ifdef PN532DEBUG
+  PN532DEBUGPRINT.print(F("About to inList passive target"));
+#endif
+
+  if (!startCommand(pn532_packetbuffer, 3, 1000)) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Could not send inlist message"));
+#endif
+    return false;
+  }
+
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Waits for and reads the target inlisted by
+             startInListPassiveTarget()
+    @param   timeout  Timeout in ms to wait for a card (0 waits forever)
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::readInListPassiveTarget(uint16_t timeout) {
+  int16_t length = readresponse(timeout);
+
+  if (length < 2) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Unexpected response to inlist passive host"));
+#endif
+    return false;
+  }
+
+  if (pn532_packetbuffer[7] != 1) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("Unhandled number of targets inlisted"));
+#endif
+    PN532DEBUGPRINT.println(F("Number of tags inlisted:"));
+    PN532DEBUGPRINT.println(pn532_packetbuffer[7]);
+    return false;
+  }
+
+  _inListedTag = pn532_packetbuffer[8];
+  PN532DEBUGPRINT.print(F("Tag number: "));
+  PN532DEBUGPRINT.println(_inListedTag);
+
+  readTargetBitRates(8, 7 + length);
+
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Starts polling the field for targets (InAutoPoll) and returns
+             without waiting. The PN532 polls on its own, so the host bus is
+             idle until a target is found; with the IRQ pin wired the host
+             checks isResponseReady() without any bus transaction. The target
+             is then collected with readAutoPoll() and activated as with
+             inListPassiveTarget().
+
+    @param   pollCount  Number of polling rounds, PN532_AUTOPOLL_ENDLESS to
+                        poll until a target is found
+    @param   period     Pause between rounds, in units of
+                        PN532_AUTOPOLL_PERIOD_MS (1 to 15)
+    @param   types      Target types to poll for (PN532_AUTOPOLL_*)
+    @param   typeCount  Number of entries in types (1 to
+                        PN532_AUTOPOLL_MAX_TYPES)
+    @return  true if the command was acknowledged, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::startAutoPoll(uint8_t pollCount, uint8_t period,
+                                   const uint8_t *types, uint8_t typeCount) {
+  if ((typeCount == 0) || (typeCount > PN532_AUTOPOLL_MAX_TYPES)) {
+    return false;
+  }
+
+  pn532_packetbuffer[0] = PN532_COMMAND_INAUTOPOLL;
+  pn532_packetbuffer[1] = pollCount;
+  pn532_packetbuffer[2] = period;
+  memcpy(pn532_packetbuffer + 3, types, typeCount);
+
+  return startCommand(pn532_packetbuffer, 3 + typeCount, 1000);
+}
+
+/**************************************************************************/
+/*!
+    @brief   Waits for and reads the first target found by startAutoPoll()
+
+    @param   targetType  If not NULL, receives the type of the target
+                         (PN532_AUTOPOLL_*)
+    @param   timeout     Timeout in ms to wait for a target (0 waits forever)
+    @return  true if a target was found, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::readAutoPoll(uint8_t *targetType, uint16_t timeout) {
+  int16_t length = readresponse(timeout);
+
+  // NbTg, then per target: Type, data length, target data starting with Tg
+  if ((length < 4) || (pn532_packetbuffer[7] == 0)) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.println(F("No target found by auto poll"));
+#endif
+    return false;
+  }
+
+  uint8_t type = pn532_packetbuffer[8];
+  uint16_t end = 10 + pn532_packetbuffer[9];
+  if (end > 7 + length) {
+    end = 7 + length;
+  }
+
+  _inListedTag = pn532_packetbuffer[10];
+  _targetBitRates = 0;
+  if ((type == PN532_AUTOPOLL_GENERIC_106A) ||
+      (type == PN532_AUTOPOLL_MIFARE) ||
+      (type == PN532_AUTOPOLL_ISO14443_4A)) {
+    readTargetBitRates(10, end);
+  }
+
+  if (targetType != NULL) {
+    *targetType = type;
+  }
+
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief   Reads the ATS interface byte TA(1) of a type A target into
+             _targetBitRates
+
+    @param   tg   Index in pn532_packetbuffer of the target data: Tg,
+                  SENS_RES (2), SEL_RES, NFCIDLength, NFCID, then the ATS of
+                  ISO14443-4 targets: TL, T0, TA, ...
+    @param   end  Index in pn532_packetbuffer just past the target data
+*/
+/**************************************************************************/
+void Adafruit_PN532::readTargetBitRates(uint8_t tg, uint16_t end) {
+  _targetBitRates = 0;
+  if (end > tg + 4) {
+    uint16_t ats = tg + 5 + pn532_packetbuffer[tg + 4];
+    if ((end >= ats + 3) && (pn532_packetbuffer[ats] >= 3) &&
+        ((pn532_packetbuffer[ats + 1] & PN532_ATS_T0_TA) != 0)) {
+      _targetBitRates = pn532_packetbuffer[ats + 2];
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief   Bit rates supported by the target inlisted by
+             inListPassiveTarget(), as announced in its ATS
+
+    @return  The ATS interface byte TA(1): bits 0..2 for 212/424/848 kbps
+             from the PN532 to the target, bits 4..6 for the same rates from
+             the target to the PN532, bit 7 if both directions must use the
+             same rate. 0 if the target only supports 106 kbps.
+*/
+/**************************************************************************/
+uint8_t Adafruit_PN532::targetBitRates() { return _targetBitRates; }
+
+/**************************************************************************/
+/*!
+    @brief   Number of ready checks made over the SPI or I2C bus since
+             construction, a measure of the bus traffic spent waiting for the
+             PN532. Checks on the IRQ pin are not counted.
+
+    @return  Status poll count.
+*/
+/**************************************************************************/
+uint32_t Adafruit_PN532::statusPolls() { return _statusPolls; }
 
 /**************************************************************************/
 /*!
-    @brief   Exchanges an APDU with the currently inlisted peer
+    @brief   Changes the bit rates used with the inlisted target (InPSL,
+             a PPS exchange for an ISO14443-4 target). On failure the
+             target keeps the previous bit rates.
 
-    @param   send            Pointer to data to send
-    @param   sendLength      Length of the data to send
-    @param   response        Pointer to response data
-    @param   responseLength  Pointer to the response data length
+    @param   brit  Bit rate from the PN532 to the target (PN532_BITRATE_*)
+    @param   brti  Bit rate from the target to the PN532 (PN532_BITRATE_*)
     @return  true on success, false otherwise.
 */
 /**************************************************************************/
-bool Adafruit_PN532::inDataExchange(uint8_t *send, uint8_t sendLength,
-                                    uint8_t *response,
-                                    uint8_t *responseLength) {
-  if (sendLength > PN532_PACKBUFFSIZ - 2) {
-#ifdef PN532DEBUG
-    PN532DEBUGPRINT.println(F("APDU length too long for packet buffer"));
-#endif
-    return false;
-  }
-  uint8_t i;
+bool Adafruit_PN532::inPSL(uint8_t brit, uint8_t brti) {
+  uint8_t status;
 
-  pn532_packetbuffer[0] = 0x40; // PN532_COMMAND_INDATAEXCHANGE;
+  pn532_packetbuffer[0] = PN532_COMMAND_INPSL;
   pn532_packetbuffer[1] = _inListedTag;
-  for (i = 0; i < sendLength; ++i) {
-    pn532_packetbuffer[i + 2] = send[i];
-  }
+  pn532_packetbuffer[2] = brit;
+  pn532_packetbuffer[3] = brti;
 
-  if (!sendCommandCheckAck(pn532_packetbuffer, sendLength + 2, 1000)) {
-#ifdef PN532DEBUG
-    PN532DEBUGPRINT.println(F("Could not send APDU"));
-#endif
+  if (!startCommand(pn532_packetbuffer, 4, 1000)) {
     return false;
   }
 
-  if (!waitready(1000)) {
-#ifdef PN532DEBUG
-    PN532DEBUGPRINT.println(F("Response never received for APDU..."));
-#endif
+  if (finishCommand(&status, 1) != 1) {
     return false;
   }
 
-  readdata(pn532_packetbuffer, sizeof(pn532_packetbuffer));
-
-  if (pn532_packetbuffer[0] == 0 && pn532_packetbuffer[1] == 0 &&
-      pn532_packetbuffer[2] == 0xff) {
-    uint8_t length = pn532_packetbuffer[3];
-    if (pn532_packetbuffer[4] != (uint8_t)(~length + 1)) {
-#ifdef PN532DEBUG
-      PN532DEBUGPRINT.println(F("Length check invalid"));
-      PN532DEBUGPRINT.println(length, HEX);
-      PN532DEBUGPRINT.println((~length) + 1, HEX);
-#endif
-      return false;
-    }
-    if (pn532_packetbuffer[5] == PN532_PN532TOHOST &&
-        pn532_packetbuffer[6] == PN532_RESPONSE_INDATAEXCHANGE) {
-      if ((pn532_packetbuffer[7] & 0x3f) != 0) {
-#ifdef PN532DEBUG
-        PN532DEBUGPRINT.println(F("Status code indicates an error"));
-#endif
-        return false;
-      }
+  return (status & PN532_STATUS_ERROR_MASK) == 0;
+}
 
-      length -= 3;
+/**************************************************************************/
+/*!
+    @brief   Deselects the inlisted target (InDeselect). The PN532 keeps the
+             target's identity, so inSelect() can activate it again without
+             a new anticollision.
 
-      if (length > *responseLength) {
-        return false;
-      }
+    @return  true on success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::inDeselect() {
+  return targetCommand(PN532_COMMAND_INDESELECT);
+}
 
-      for (i = 0; i < length; ++i) {
-        response[i] = pn532_packetbuffer[8 + i];
-      }
-      *responseLength = length;
+/**************************************************************************/
+/*!
+    @brief   Activates again the target deselected by inDeselect()
+             (InSelect), addressing it by its known UID.
 
-      return true;
-    } else {
-      PN532DEBUGPRINT.print(F("Don't know how to handle this command: "));
-      PN532DEBUGPRINT.println(pn532_packetbuffer[6], HEX);
-      return false;
-    }
-  } else {
-    PN532DEBUGPRINT.println(F("Preamble missing"));
-    return false;
-  }
-}
+    @return  true on success, false if the target left the field.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::inSelect() { return targetCommand(PN532_COMMAND_INSELECT); }
 
 /**************************************************************************/
 /*!
-    @brief   'InLists' a passive target. PN532 acting as reader/initiator,
-             peer acting as card/responder.
+    @brief   Releases the inlisted target (InRelease). The PN532 forgets it
+             and a new inListPassiveTarget() is needed.
+
     @return  true on success, false otherwise.
 */
 /**************************************************************************/
-bool Adafruit_PN532::inListPassiveTarget() {
-  pn532_packetbuffer[0] = PN532_COMMAND_INLISTPASSIVETARGET;
-  pn532_packetbuffer[1] = 1;
-  pn532_packetbuffer[2] = 0;
+bool Adafruit_PN532::inRelease() {
+  return targetCommand(PN532_COMMAND_INRELEASE);
+}
 
-#ifdef PN532DEBUG
-  PN532DEBUGPRINT.print(F("About to inList passive target"));
-#endif
+/**************************************************************************/
+/*!
+    @brief   Sends a command whose only parameter is the inlisted target
+             number and whose answer is a status byte.
 
-  if (!sendCommandCheckAck(pn532_packetbuffer, 3, 1000)) {
-#ifdef PN532DEBUG
-    PN532DEBUGPRINT.println(F("Could not send inlist message"));
-#endif
-    return false;
-  }
+    @param   command  PN532 command code
+    @return  true if the PN532 reports success, false otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::targetCommand(uint8_t command) {
+  uint8_t status;
 
-  if (!waitready(30000)) {
+  pn532_packetbuffer[0] = command;
+  pn532_packetbuffer[1] = _inListedTag;
+
+  if (!startCommand(pn532_packetbuffer, 2, 1000)) {
     return false;
   }
 
-  readdata(pn532_packetbuffer, sizeof(pn532_packetbuffer));
-
-  if (pn532_packetbuffer[0] == 0 && pn532_packetbuffer[1] == 0 &&
-      pn532_packetbuffer[2] == 0xff) {
-    uint8_t length = pn532_packetbuffer[3];
-    if (pn532_packetbuffer[4] != (uint8_t)(~length + 1)) {
-#ifdef PN532DEBUG
-      PN532DEBUGPRINT.println(F("Length check invalid"));
-      PN532DEBUGPRINT.println(length, HEX);
-      PN532DEBUGPRINT.println((~length) + 1, HEX);
-#endif
-      return false;
-    }
-    if (pn532_packetbuffer[5] == PN532_PN532TOHOST &&
-        pn532_packetbuffer[6] == PN532_RESPONSE_INLISTPASSIVETARGET) {
-      if (pn532_packetbuffer[7] != 1) {
-#ifdef PN532DEBUG
-        PN532DEBUGPRINT.println(F("Unhandled number of targets inlisted"));
-#endif
-        PN532DEBUGPRINT.println(F("Number of tags inlisted:"));
-        PN532DEBUGPRINT.println(pn532_packetbuffer[7]);
-        return false;
-      }
-
-      _inListedTag = pn532_packetbuffer[8];
-      PN532DEBUGPRINT.print(F("Tag number: "));
-      PN532DEBUGPRINT.println(_inListedTag);
-
-      return true;
-    } else {
-#ifdef PN532DEBUG
-      PN532DEBUGPRINT.print(F("Unexpected response to inlist passive host"));
-#endif
-      return false;
-    }
-  } else {
-#ifdef PN532DEBUG
-    PN532DEBUGPRINT.println(F("Preamble missing"));
-#endif
+  if (finishCommand(&status, 1) != 1) {
     return false;
   }
 
-  return true;
+  return (status & PN532_STATUS_ERROR_MASK) == 0;
 }
 
 /***** Mifare Classic Functions ******/
@@ -1528,74 +2333,196 @@ uint8_t Adafruit_PN532::ntag2xx_WriteNDEFURI(uint8_t uriIdentifier, char *url,
 */
 /**************************************************************************/
 bool Adafruit_PN532::readack() {
-  uint8_t ackbuff[6];
+  uint8_t ackframe[1 + 6]; // room for the I2C RDY byte before the ACK
+  uint8_t *ackbuff = ackframe + 1;
 
   if (spi_dev) {
     uint8_t cmd = PN532_SPI_DATAREAD;
     spi_dev->write_then_read(&cmd, 1, ackbuff, 6);
+    _irqFlag = false; // the ACK is read: an edge seen so far was its own
   } else if (i2c_dev || ser_dev) {
     readdata(ackbuff, 6);
   }
 
-  return (0 == memcmp((char *)ackbuff, (char *)pn532ack, 6));
+  return (0 == memcmp((char *)ackbuff, (const char *)pn532ack, 6));
 }
 
 /**************************************************************************/
 /*!
     @brief  Return true if the PN532 is ready with a response.
+
+            With the IRQ pin the check needs no bus transaction. Over I2C,
+            until the pin has been seen low once, the RDY byte is still read
+            at most every PN532_WAITREADY_MAX_US while the pin reports not
+            ready: an I2C sketch written before the IRQ pin was used may pass
+            a pin that is not wired. When the RDY byte says ready and the pin
+            is still high, the pin is dropped and this instance polls the RDY
+            byte from then on.
+
+            The interrupt flag is cleared whenever the pin reports the frame
+            and after every frame or ACK read: an edge landing between the
+            flag check and the pin read would otherwise be taken for the
+            next frame.
 */
 /**************************************************************************/
 bool Adafruit_PN532::isready() {
-  if (spi_dev) {
+  if (_irq != -1) {
+    // IRQ check: the PN532 holds the pin low while a frame is pending, so no
+    // bus transaction is needed. The interrupt flag catches the edge.
+    if (_irqFlag) {
+      _irqFlag = false;
+      _irqWired = true;
+      return true;
+    }
+    if (digitalRead(_irq) == LOW) {
+      // The edge of this same frame may have set the flag since the check
+      _irqFlag = false;
+      _irqWired = true;
+      return true;
+    }
+    if (!i2c_dev || _irqWired ||
+        ((uint32_t)(micros() - _rdyPolledAt) < PN532_WAITREADY_MAX_US)) {
+      return false;
+    }
+    _rdyPolledAt = micros();
+    if (!i2cready()) {
+      return false;
+    }
+    // The PN532 pulls IRQ low together with RDY: a pin still high is not
+    // connected to it
+    if (digitalRead(_irq) != LOW) {
+      detachIrq();
+      _irq = -1;
+    }
+    return true;
+  } else if (spi_dev) {
     // SPI ready check via Status Request
     uint8_t cmd = PN532_SPI_STATREAD;
     uint8_t reply;
+    _statusPolls++;
     spi_dev->write_then_read(&cmd, 1, &reply, 1);
     return reply == PN532_SPI_READY;
   } else if (i2c_dev) {
-    // I2C ready check via reading RDY byte
-    uint8_t rdy[1];
-    i2c_dev->read(rdy, 1);
-    return rdy[0] == PN532_I2C_READY;
+    return i2cready();
   } else if (ser_dev) {
     // Serial ready check based on non-zero read buffer
     return (ser_dev->available() != 0);
-  } else if (_irq != -1) {
-    uint8_t x = digitalRead(_irq);
-    return x == 0;
   }
   return false;
 }
 
 /**************************************************************************/
 /*!
-    @brief  Waits until the PN532 is ready.
+    @brief  I2C ready check via reading the RDY byte.
+
+    @returns true if the PN532 has a frame ready.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::i2cready() {
+  uint8_t rdy[1];
+  _statusPolls++;
+  i2c_dev->read(rdy, 1);
+  return rdy[0] == PN532_I2C_READY;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Tells whether the answer to the last command can be read without
+            blocking. Use it to poll commands started with
+            startDataExchange() or startInListPassiveTarget().
+
+    @returns true if the PN532 has a response ready.
+*/
+/**************************************************************************/
+bool Adafruit_PN532::isResponseReady() { return isready(); }
 
-    @param  timeout   Timeout before giving up
+/**************************************************************************/
+/*!
+    @brief  Waits until the PN532 is ready. With the IRQ pin wired the check
+            is a pin read and is repeated without pausing; otherwise each
+            check is a bus transaction and the pause between checks doubles
+            from PN532_WAITREADY_MIN_US up to PN532_WAITREADY_MAX_US, so a
+            fast answer is seen within microseconds and a slow card does not
+            keep the bus busy.
+
+    @param  timeout   Timeout in ms before giving up (0 waits forever)
 */
 /**************************************************************************/
 bool Adafruit_PN532::waitready(uint16_t timeout) {
-  uint16_t timer = 0;
+#ifdef PN532_SPI_HOLD_CS_STATUS
+  if ((_irq == -1) && spi_dev) {
+    return waitreadyspi(timeout);
+  }
+#endif
+
+  uint32_t start = millis();
+  uint16_t pause = PN532_WAITREADY_MIN_US;
   while (!isready()) {
-    if (timeout != 0) {
-      timer += 10;
-      if (timer > timeout) {
+    if ((timeout != 0) && ((millis() - start) > timeout)) {
 #ifdef PN532DEBUG
-        PN532DEBUGPRINT.println("TIMEOUT!");
+      PN532DEBUGPRINT.println("TIMEOUT!");
 #endif
-        return false;
-      }
+      return false;
+    }
+    if (_irq != -1) {
+      yield();
+    } else {
+      delayMicroseconds(pause);
+      pause = (pause < (PN532_WAITREADY_MAX_US / 2)) ? (pause * 2)
+                                                     : PN532_WAITREADY_MAX_US;
     }
-    delay(10);
   }
   return true;
 }
 
 /**************************************************************************/
 /*!
-    @brief  Reads n bytes of data from the PN532 via SPI or I2C.
+    @brief  Waits until the PN532 is ready, over SPI, in a single
+            transaction: the status read command is sent once, then the
+            status byte is clocked again with CS held, with the same growing
+            pause as waitready(), until it reports ready. Used by waitready()
+            when PN532_SPI_HOLD_CS_STATUS is defined.
+
+    @param  timeout   Timeout in ms before giving up (0 waits forever)
+*/
+/**************************************************************************/
+bool Adafruit_PN532::waitreadyspi(uint16_t timeout) {
+  uint32_t start = millis();
+  uint16_t pause = PN532_WAITREADY_MIN_US;
+  uint8_t cmd = PN532_SPI_STATREAD;
+  bool ready = false;
+
+  spi_dev->beginTransactionWithAssertingCS();
+  spi_dev->transfer(&cmd, 1);
+  for (;;) {
+    _statusPolls++;
+    if (spi_dev->transfer(0xFF) == PN532_SPI_READY) {
+      ready = true;
+      break;
+    }
+    if ((timeout != 0) && ((millis() - start) > timeout)) {
+#ifdef PN532DEBUG
+      PN532DEBUGPRINT.println("TIMEOUT!");
+#endif
+      break;
+    }
+    delayMicroseconds(pause);
+    pause = (pause < (PN532_WAITREADY_MAX_US / 2)) ? (pause * 2)
+                                                   : PN532_WAITREADY_MAX_US;
+  }
+  spi_dev->endTransactionWithDeassertingCS();
+
+  return ready;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads n bytes of data from the PN532 via SPI or I2C. On I2C the
+            RDY byte lands just before buff, and at most i2creadlimit() bytes
+            are read: the bytes of buff past that limit are left as they are.
 
-    @param  buff      Pointer to the buffer where data will be written
+    @param  buff      Pointer to the buffer where data will be written, with
+                      one writable byte before it
     @param  n         Number of bytes to be read
 */
 /**************************************************************************/
@@ -1605,16 +2532,26 @@ void Adafruit_PN532::readdata(uint8_t *buff, uint8_t n) {
     uint8_t cmd = PN532_SPI_DATAREAD;
     spi_dev->write_then_read(&cmd, 1, buff, n);
   } else if (i2c_dev) {
-    // I2C read
-    uint8_t rbuff[n + 1]; // +1 for leading RDY byte
-    i2c_dev->read(rbuff, n + 1);
-    for (uint8_t i = 0; i < n; i++) {
-      buff[i] = rbuff[i + 1];
-    }
+    // I2C read, +1 for leading RDY byte
+    uint8_t limit = i2creadlimit();
+    i2c_dev->read(buff - 1, ((n < limit) ? n : limit) + 1);
   } else if (ser_dev) {
-    // Serial read
-    ser_dev->readBytes(buff, n);
+    // Serial read, driven by the frame length so that no time is spent
+    // waiting for bytes past the end of the frame
+    const uint8_t header = 5; // PREAMBLE, START CODE (2), LEN, LCS
+    if ((n > header) && readserial(buff, header)) {
+      // An ACK frame (LEN 0, LCS FF) has only the postamble left
+      uint16_t total = header + (((buff[3] == 0) && (buff[4] == 0xFF))
+                                     ? 1
+                                     : buff[3] + 2);
+      readserial(buff + header, ((total < n) ? total : n) - header);
+    } else {
+      readserial(buff, n);
+    }
   }
+  // The frame is read: an edge seen so far was its own, the PN532 signals
+  // the next frame only after this
+  _irqFlag = false;
 #ifdef PN532DEBUG
   PN532DEBUGPRINT.print(F("Reading: "));
   for (uint8_t i = 0; i < n; i++) {
@@ -1625,6 +2562,155 @@ void Adafruit_PN532::readdata(uint8_t *buff, uint8_t n) {
 #endif
 }
 
+/**************************************************************************/
+/*!
+    @brief  Reads one response frame without over-reading: the preamble,
+            start code, LEN and LCS first, then exactly the LEN data bytes,
+            DCS and postamble. On SPI both phases share one chip select; on
+            I2C a new read restarts the frame, so the first read takes up to
+            PN532_I2C_FIRST_READ bytes, which holds most frames whole, and
+            only a longer frame is read again in full. The RDY byte lands
+            just before buff.
+
+    @param  buff      Buffer receiving the frame from the preamble on, with
+                      one writable byte before it
+    @param  n         Size of buff
+    @return true if a frame with valid LCS and DCS fitting in buff was read
+*/
+/**************************************************************************/
+bool Adafruit_PN532::readframe(uint8_t *buff, uint8_t n) {
+  const uint8_t header = 5; // PREAMBLE, START CODE (2), LEN, LCS
+  bool valid = false;
+  uint8_t length = 0;
+
+  if (spi_dev) {
+    uint8_t cmd = PN532_SPI_DATAREAD;
+    spi_dev->beginTransactionWithAssertingCS();
+    spi_dev->transfer(&cmd, 1);
+    memset(buff, 0xFF, header);
+    spi_dev->transfer(buff, header);
+    length = buff[3];
+    valid = readframeheader(buff, n);
+    if (valid) {
+      memset(buff + header, 0xFF, length + 2);
+      spi_dev->transfer(buff + header, length + 2);
+    }
+    spi_dev->endTransactionWithDeassertingCS();
+  } else if (i2c_dev) {
+    uint8_t limit = i2creadlimit();
+    uint8_t first = (n < limit) ? n : limit;
+    if (first > PN532_I2C_FIRST_READ) {
+      first = PN532_I2C_FIRST_READ;
+    }
+    // +1 for leading RDY byte
+    valid = i2c_dev->read(buff - 1, first + 1) &&
+            (buff[-1] == PN532_I2C_READY) && readframeheader(buff, n);
+    length = buff[3];
+    uint16_t total = header + length + 2;
+    if (valid && (total > first)) {
+      valid = (total <= limit) && i2c_dev->read(buff - 1, total + 1) &&
+              (buff[-1] == PN532_I2C_READY);
+    }
+  } else if (ser_dev) {
+    valid = readserial(buff, header) && readframeheader(buff, n);
+    length = buff[3];
+    if (valid) {
+      valid = readserial(buff + header, length + 2);
+    }
+  }
+  // As in readdata(): the edge of this frame must not announce the next one
+  _irqFlag = false;
+
+  if (valid) {
+    uint8_t dcs = 0;
+    for (uint8_t i = 0; i <= length; i++) {
+      dcs += buff[header + i]; // data and DCS add up to zero
+    }
+    valid = (dcs == 0);
+  }
+
+#ifdef PN532DEBUG
+  PN532DEBUGPRINT.print(F("Reading: "));
+  for (uint16_t i = 0; i < (uint16_t)(header + (valid ? length + 2 : 0));
+       i++) {
+    PN532DEBUGPRINT.print(F(" 0x"));
+    PN532DEBUGPRINT.print(buff[i], HEX);
+  }
+  PN532DEBUGPRINT.println();
+  if (!valid) {
+    PN532DEBUGPRINT.println(F("Frame check invalid"));
+  }
+#endif
+
+  return valid;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads exactly n bytes from the HSU, waiting no longer than their
+            transfer time at the current baud rate plus
+            PN532_HSU_READ_MARGIN, instead of the Stream timeout
+
+    @param  buff      Buffer receiving the bytes
+    @param  n         Number of bytes to read
+    @return true if all n bytes arrived in time
+*/
+/**************************************************************************/
+bool Adafruit_PN532::readserial(uint8_t *buff, uint8_t n) {
+  // 10 bits per byte on the line
+  uint32_t timeout = PN532_HSU_READ_MARGIN + (n * 10000UL) / _baud;
+  uint32_t start = millis();
+  uint8_t received = 0;
+
+  while (received < n) {
+    int c = ser_dev->read();
+    if (c >= 0) {
+      buff[received++] = (uint8_t)c;
+    } else if ((millis() - start) > timeout) {
+#ifdef PN532DEBUG
+      PN532DEBUGPRINT.println(F("HSU read timeout"));
+#endif
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Longest read of frame bytes in one I2C transaction. The PN532
+            sends the RDY byte and the frame from its start on every read,
+            so a read split to fit the Wire buffer would not continue the
+            frame: frames longer than this cannot be received.
+
+    @return Frame bytes that fit in the Wire buffer after the RDY byte
+*/
+/**************************************************************************/
+uint8_t Adafruit_PN532::i2creadlimit() {
+  size_t limit = i2c_dev->maxBufferSize() - 1;
+  return (limit < 255) ? limit : 255;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Checks the preamble, start code and LCS of a response frame and
+            that the whole frame fits in the receive buffer
+
+    @param  buff      Frame header (5 bytes from the preamble on)
+    @param  n         Size of the receive buffer
+    @return true if the header is valid
+*/
+/**************************************************************************/
+bool Adafruit_PN532::readframeheader(const uint8_t *buff, uint8_t n) {
+  uint8_t length = buff[3];
+
+  return (buff[0] == PN532_PREAMBLE) && (buff[1] == PN532_STARTCODE1) &&
+         (buff[2] == PN532_STARTCODE2) && (length > 0) &&
+         ((uint8_t)(length + buff[4]) == 0) &&
+         ((uint16_t)length + 7 <= n);
+}
+
 /**************************************************************************/
 /*!
     @brief   set the PN532 as iso14443a Target behaving as a SmartCard
@@ -1733,88 +2819,133 @@ uint8_t Adafruit_PN532::setDataTarget(uint8_t *cmd, uint8_t cmdlen) {
 */
 /**************************************************************************/
 void Adafruit_PN532::writecommand(uint8_t *cmd, uint8_t cmdlen) {
-  if (spi_dev) {
-    // SPI command write.
-    uint8_t checksum;
-    uint8_t packet[9 + cmdlen];
-    uint8_t *p = packet;
-    cmdlen++;
-
-    p[0] = PN532_SPI_DATAWRITE;
-    p++;
-
-    p[0] = PN532_PREAMBLE;
-    p++;
-    p[0] = PN532_STARTCODE1;
-    p++;
-    p[0] = PN532_STARTCODE2;
-    p++;
-    checksum = PN532_PREAMBLE + PN532_STARTCODE1 + PN532_STARTCODE2;
-
-    p[0] = cmdlen;
-    p++;
-    p[0] = ~cmdlen + 1;
-    p++;
-
-    p[0] = PN532_HOSTTOPN532;
-    p++;
-    checksum += PN532_HOSTTOPN532;
-
-    for (uint8_t i = 0; i < cmdlen - 1; i++) {
-      p[0] = cmd[i];
-      p++;
-      checksum += cmd[i];
-    }
+  // Commands built in the packet buffer already have the frame room around
+  // them; others are staged there first
+  if (cmd != pn532_packetbuffer) {
+    memmove(pn532_packetbuffer, cmd, cmdlen);
+  }
+
+  writeframe(pn532_packetbuffer, cmdlen);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Writes a command to the PN532, building the frame header in the
+            PN532_FRAME_HEADROOM bytes before it and the checksum and
+            postamble in the PN532_FRAME_TAILROOM bytes after it, so the
+            whole frame goes to the bus in one write without a copy
+
+    @param  cmd       Pointer to the command buffer, with frame room around it
+    @param  cmdlen    Command length in bytes
+*/
+/**************************************************************************/
+void Adafruit_PN532::writeframe(uint8_t *cmd, uint8_t cmdlen) {
+  uint8_t LEN = cmdlen + 1;
+  uint8_t sum = PN532_HOSTTOPN532;
+  for (uint8_t i = 0; i < cmdlen; i++) {
+    sum += cmd[i];
+  }
+
+  // Header, written backwards from the command
+  cmd[-1] = PN532_HOSTTOPN532;
+  cmd[-2] = ~LEN + 1;
+  cmd[-3] = LEN;
+  cmd[-4] = PN532_STARTCODE2;
+  cmd[-5] = PN532_STARTCODE1;
+  cmd[-6] = PN532_PREAMBLE;
+  cmd[-7] = PN532_SPI_DATAWRITE; // only sent over SPI
 
-    p[0] = ~checksum;
-    p++;
-    p[0] = PN532_POSTAMBLE;
-    p++;
+  // Trailer
+  cmd[cmdlen] = ~sum + 1;
+  cmd[cmdlen + 1] = PN532_POSTAMBLE;
+
+  uint8_t *frame = cmd - 6;
+  size_t frameLength = 6 + cmdlen + PN532_FRAME_TAILROOM;
 
 #ifdef PN532DEBUG
-    Serial.print("Sending : ");
-    for (int i = 1; i < 8 + cmdlen; i++) {
-      Serial.print("0x");
-      Serial.print(packet[i], HEX);
-      Serial.print(", ");
-    }
-    Serial.println();
+  Serial.print("Sending : ");
+  for (size_t i = 1; i < frameLength; i++) {
+    Serial.print("0x");
+    Serial.print(frame[i], HEX);
+    Serial.print(", ");
+  }
+  Serial.println();
 #endif
 
-    spi_dev->write(packet, 8 + cmdlen);
-  } else if (i2c_dev || ser_dev) {
-    // I2C or Serial command write.
-    uint8_t packet[8 + cmdlen];
-    uint8_t LEN = cmdlen + 1;
-
-    packet[0] = PN532_PREAMBLE;
-    packet[1] = PN532_STARTCODE1;
-    packet[2] = PN532_STARTCODE2;
-    packet[3] = LEN;
-    packet[4] = ~LEN + 1;
-    packet[5] = PN532_HOSTTOPN532;
-    uint8_t sum = 0;
-    for (uint8_t i = 0; i < cmdlen; i++) {
-      packet[6 + i] = cmd[i];
-      sum += cmd[i];
-    }
-    packet[6 + cmdlen] = ~(PN532_HOSTTOPN532 + sum) + 1;
-    packet[7 + cmdlen] = PN532_POSTAMBLE;
+  // Forget any edge left over from an earlier frame, and any command whose
+  // response is dropped by this one
+  _irqFlag = false;
+  _commandPending = false;
+
+  if (spi_dev) {
+    spi_dev->write(frame - 1, frameLength + 1);
+  } else if (i2c_dev) {
+    i2c_dev->write(frame, frameLength);
+  } else if (ser_dev) {
+    ser_dev->write(frame, frameLength);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Writes a command frame in place, like writeframe(), waits for the
+            ACK only and records the command as pending for readresponse()
+
+    @param  cmd       Pointer to the command buffer, with frame room around it
+    @param  cmdlen    Command length in bytes
+    @param  timeout   Timeout in ms to wait for the ACK
+    @return true if the command was acknowledged
+*/
+/**************************************************************************/
+bool Adafruit_PN532::startframe(uint8_t *cmd, uint8_t cmdlen,
+                                uint16_t timeout) {
+  uint8_t command = cmd[0];
+
+  writeframe(cmd, cmdlen);
+
+  if (!waitCommandAck(timeout, false)) {
+    return false;
+  }
 
+  _pendingCommand = command;
+  _commandPending = true;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Waits for and reads the response frame to the pending command
+            into pn532_packetbuffer, checking that it comes from the PN532
+            and answers that command. The response data starts at
+            pn532_packetbuffer[7].
+
+    @param  timeout   Timeout in ms to wait for the response (0 waits
+                      forever). On timeout the command stays pending.
+    @return Number of response data bytes, or -1 on error
+*/
+/**************************************************************************/
+int16_t Adafruit_PN532::readresponse(uint16_t timeout) {
+  if (!_commandPending || !waitready(timeout)) {
+    return -1;
+  }
+  _commandPending = false;
+
+  if (!readframe(pn532_packetbuffer, PN532_PACKBUFFSIZ)) {
 #ifdef PN532DEBUG
-    Serial.print("Sending : ");
-    for (int i = 1; i < 8 + cmdlen; i++) {
-      Serial.print("0x");
-      Serial.print(packet[i], HEX);
-      Serial.print(", ");
-    }
-    Serial.println();
+    PN532DEBUGPRINT.println(F("Invalid response frame"));
 #endif
+    return -1;
+  }
 
-    if (i2c_dev) {
-      i2c_dev->write(packet, 8 + cmdlen);
-    } else {
-      ser_dev->write(packet, 8 + cmdlen);
-    }
+  if ((pn532_packetbuffer[3] < 2) ||
+      (pn532_packetbuffer[5] != PN532_PN532TOHOST) ||
+      (pn532_packetbuffer[6] != (uint8_t)(_pendingCommand + 1))) {
+#ifdef PN532DEBUG
+    PN532DEBUGPRINT.print(F("Don't know how to handle this command: "));
+    PN532DEBUGPRINT.println(pn532_packetbuffer[6], HEX);
+#endif
+    return -1;
   }
+
+  return pn532_packetbuffer[3] - 2;
 }
@@ -63,6 +63,11 @@
 #define PN532_RESPONSE_INDATAEXCHANGE (0x41)      ///< Data exchange
 #define PN532_RESPONSE_INLISTPASSIVETARGET (0x4B) ///< List passive target
 
+#define PN532_STATUS_ERROR_MASK (0x3F) ///< Error code bits of a status byte
+#define PN532_STATUS_MI                                                        \
+  (0x40) ///< More information bit, in a status byte or in Tg: the data
+         ///< continues in the next frame
+
 #define PN532_WAKEUP (0x55) ///< Wake
 
 #define PN532_SPI_STATREAD (0x02)  ///< Stat read
@@ -70,14 +75,87 @@
 #define PN532_SPI_DATAREAD (0x03)  ///< Data read
 #define PN532_SPI_READY (0x01)     ///< Ready
 
+// Uncomment to poll the SPI status in one transaction per wait: the status
+// read command is sent once and the status byte clocked again, with CS held,
+// until the PN532 is ready. Only for PN532 parts that keep sending the status
+// byte while CS stays asserted. The default build leaves it off and keeps one
+// transaction per status byte: the transaction count is unchanged, only the
+// SPI driver calls per transaction drop (tests/host/bench_spi.cpp).
+// #define PN532_SPI_HOLD_CS_STATUS
+
+#define PN532_FRAME_HEADROOM                                                   \
+  (7) ///< Bytes before a command for the frame header (SPI DW, PREAMBLE,
+      ///< START CODE, LEN, LCS, TFI)
+#define PN532_FRAME_TAILROOM (2) ///< Bytes after a command for DCS and POSTAMBLE
+#define PN532_DATAEXCHANGE_HEADROOM                                            \
+  (PN532_FRAME_HEADROOM + 2) ///< Bytes before an APDU for the frame header,
+                             ///< InDataExchange and Tg
+
 #define PN532_I2C_ADDRESS (0x48 >> 1) ///< Default I2C address
 #define PN532_I2C_READBIT (0x01)      ///< Read bit
 #define PN532_I2C_BUSY (0x00)         ///< Busy
 #define PN532_I2C_READY (0x01)        ///< Ready
 #define PN532_I2C_READYTIMEOUT (20)   ///< Ready timeout
+#define PN532_I2C_STANDARD_HZ (100000UL) ///< I2C standard mode clock
+#define PN532_I2C_FAST_HZ (400000UL)     ///< I2C fast mode clock
+#define PN532_I2C_FASTPLUS_HZ (1000000UL) ///< I2C fast mode plus clock
+
+#define PN532_HSU_DEFAULT_BAUD (115200UL) ///< HSU baud rate after reset
+#define PN532_HSU_MAX_BAUD (1288000UL)    ///< Fastest HSU baud rate
+#define PN532_HSU_READ_MARGIN                                                  \
+  (10) ///< Time in ms allowed on top of the transfer time of an HSU read
+
+#ifndef PN532_I2C_FIRST_READ
+#define PN532_I2C_FIRST_READ                                                   \
+  (31) ///< Frame bytes taken by the first I2C read of a response; a longer
+       ///< frame is read again in full
+#endif
+
+#define PN532_LINE_TEST_PROBES                                                 \
+  (4) ///< Communication line tests a bus speed must pass
+#define PN532_LINE_TEST_LENGTH (16) ///< Data bytes of one line test
+#define PN532_LINE_TEST_TIMEOUT                                                \
+  (50) ///< Timeout in ms of one line test
+
+#define PN532_IRQ_NONE                                                         \
+  (0xFF) ///< IRQ pin argument of the I2C constructor when the IRQ line is not
+         ///< wired: readiness is then polled with the I2C RDY byte
+
+#define PN532_WAITREADY_MIN_US                                                 \
+  (50) ///< First pause in us between ready polls when the IRQ is not wired
+#define PN532_WAITREADY_MAX_US                                                 \
+  (2000) ///< Longest pause in us between ready polls when the IRQ is not wired
+
+#ifndef PN532_PACKBUFFSIZ
+#define PN532_PACKBUFFSIZ                                                      \
+  (255) ///< Packet buffer size in bytes, per instance (at most 255)
+#endif
+
+#define PN532_IRQ_SLOTS                                                        \
+  (4) ///< Most instances whose IRQ pin is handled by an interrupt
 
 #define PN532_MIFARE_ISO14443A (0x00) ///< MiFare
 
+// Bit rates for InPSL (BRit / BRti)
+#define PN532_BITRATE_106 (0x00) ///< 106 kbps
+#define PN532_BITRATE_212 (0x01) ///< 212 kbps
+#define PN532_BITRATE_424 (0x02) ///< 424 kbps
+#define PN532_BITRATE_848 (0x03) ///< 848 kbps (ISO14443-4 targets only)
+
+#define PN532_ATS_T0_TA (0x10) ///< ATS format byte T0: interface byte TA present
+
+// Target types for InAutoPoll
+#define PN532_AUTOPOLL_GENERIC_106A (0x00) ///< Any 106 kbps type A target
+#define PN532_AUTOPOLL_JEWEL (0x04)        ///< Innovision Jewel
+#define PN532_AUTOPOLL_MIFARE (0x10)       ///< Mifare card
+#define PN532_AUTOPOLL_FELICA_212 (0x11)   ///< FeliCa 212 kbps
+#define PN532_AUTOPOLL_FELICA_424 (0x12)   ///< FeliCa 424 kbps
+#define PN532_AUTOPOLL_ISO14443_4A (0x20)  ///< ISO14443-4 type A
+#define PN532_AUTOPOLL_ISO14443_4B (0x23)  ///< ISO14443-4 type B
+#define PN532_AUTOPOLL_ENDLESS (0xFF)      ///< Poll until a target is found
+#define PN532_AUTOPOLL_PERIOD_MS (150)     ///< Unit of the InAutoPoll period
+#define PN532_AUTOPOLL_MAX_TYPES (15)      ///< Most target types in one poll
+
 // Mifare Commands
 #define MIFARE_CMD_AUTH_A (0x60)           ///< Auth A
 #define MIFARE_CMD_AUTH_B (0x61)           ///< Auth B
@@ -135,6 +213,9 @@
 #define PN532_GPIO_P34 (4)              ///< GPIO 34
 #define PN532_GPIO_P35 (5)              ///< GPIO 35
 
+typedef void (*PN532CommandCallback)(
+    void *context); ///< Called by serviceCommand() when a response is ready
+
 /**
  * @brief Class for working with Adafruit PN532 NFC/RFID breakout boards.
  */
@@ -146,6 +227,9 @@ public:
   Adafruit_PN532(uint8_t irq, uint8_t reset,
                  TwoWire *theWire = &Wire);              // Hardware I2C
   Adafruit_PN532(uint8_t reset, HardwareSerial *theSer); // Hardware UART
+  ~Adafruit_PN532();
+  Adafruit_PN532(const Adafruit_PN532 &) = delete;
+  Adafruit_PN532 &operator=(const Adafruit_PN532 &) = delete;
   bool begin(void);
 
   void reset(void);
@@ -153,12 +237,25 @@ public:
 
   // Generic PN532 functions
   bool SAMConfig(void);
+  bool startSAMConfig(void);
+  bool finishSAMConfig(uint16_t timeout = 100);
   uint32_t getFirmwareVersion(void);
   bool sendCommandCheckAck(uint8_t *cmd, uint8_t cmdlen,
                            uint16_t timeout = 100);
   bool writeGPIO(uint8_t pinstate);
   uint8_t readGPIO(void);
   bool setPassiveActivationRetries(uint8_t maxRetries);
+  uint32_t setI2CSpeed(uint32_t maxSpeed = PN532_I2C_FASTPLUS_HZ);
+  uint32_t setSerialSpeed(uint32_t maxBaud = PN532_HSU_MAX_BAUD);
+
+  // Asynchronous commands
+  bool startCommand(uint8_t *cmd, uint8_t cmdlen, uint16_t timeout = 1000);
+  bool isCommandDone();
+  int16_t finishCommand(uint8_t *response, uint8_t responseLength,
+                        uint16_t timeout = 1000);
+  bool abortCommand();
+  void setCommandCallback(PN532CommandCallback callback, void *context = NULL);
+  bool serviceCommand();
 
   // ISO14443A functions
   bool readPassiveTargetID(
@@ -168,7 +265,32 @@ public:
   bool readDetectedPassiveTargetID(uint8_t *uid, uint8_t *uidLength);
   bool inDataExchange(uint8_t *send, uint8_t sendLength, uint8_t *response,
                       uint8_t *responseLength);
+  bool inDataExchange(uint8_t *send, uint8_t sendLength, uint8_t *response,
+                      uint16_t *responseLength);
+  bool startDataExchange(uint8_t *send, uint8_t sendLength);
+  bool inDataExchangeInPlace(uint8_t *send, uint8_t sendLength,
+                             uint8_t *response, uint8_t *responseLength);
+  bool inDataExchangeInPlace(uint8_t *send, uint8_t sendLength,
+                             uint8_t *response, uint16_t *responseLength);
+  bool startDataExchangeInPlace(uint8_t *send, uint8_t sendLength,
+                                bool more = false);
+  bool readDataExchangeResponse(uint8_t *response, uint8_t *responseLength,
+                                uint16_t timeout = 1000);
+  bool readDataExchangeResponse(uint8_t *response, uint16_t *responseLength,
+                                uint16_t timeout = 1000);
   bool inListPassiveTarget();
+  bool startInListPassiveTarget();
+  bool readInListPassiveTarget(uint16_t timeout = 30000);
+  bool isResponseReady();
+  bool startAutoPoll(uint8_t pollCount, uint8_t period, const uint8_t *types,
+                     uint8_t typeCount);
+  bool readAutoPoll(uint8_t *targetType = NULL, uint16_t timeout = 0);
+  uint8_t targetBitRates();
+  uint32_t statusPolls();
+  bool inPSL(uint8_t brit, uint8_t brti);
+  bool inDeselect();
+  bool inSelect();
+  bool inRelease();
   uint8_t AsTarget();
   uint8_t getDataTarget(uint8_t *cmd, uint8_t *cmdlen);
   uint8_t setDataTarget(uint8_t *cmd, uint8_t cmdlen);
@@ -205,12 +327,45 @@ private:
   int8_t _uidLen;      // uid len
   int8_t _key[6];      // Mifare Classic key
   int8_t _inListedTag; // Tg number of inlisted tag.
+  uint8_t _targetBitRates = 0; // ATS TA byte of the inlisted tag, 0 if none
+  uint32_t _statusPolls = 0;   // Ready checks made over the bus
+  uint32_t _baud = PN532_HSU_DEFAULT_BAUD; // HSU baud rate in use
+  bool _commandPending = false; // A started command awaits its response
+  uint8_t _pendingCommand = 0;  // Code of that command
+  PN532CommandCallback _commandCallback = NULL; // See setCommandCallback()
+  void *_commandContext = NULL;                 // Passed to _commandCallback
+  volatile bool _irqFlag = false; // Set on a falling IRQ edge: frame ready
+  uint32_t _rdyPolledAt = 0; // micros() of the last I2C RDY fallback poll
+  bool _irqWired = false;    // IRQ pin seen low, so it is connected
+
+  byte _framebuffer[PN532_FRAME_HEADROOM + PN532_PACKBUFFSIZ +
+                    PN532_FRAME_TAILROOM]; // Packet buffer with room for the
+                                           // frame around it
+  byte *const pn532_packetbuffer =
+      _framebuffer + PN532_FRAME_HEADROOM; // Packet buffer used in various
+                                           // transactions
 
   // Low level communication functions that handle both SPI and I2C.
   void readdata(uint8_t *buff, uint8_t n);
+  bool readframe(uint8_t *buff, uint8_t n);
+  bool readframeheader(const uint8_t *buff, uint8_t n);
+  uint8_t i2creadlimit();
+  bool readserial(uint8_t *buff, uint8_t n);
+  bool switchbaudrate(uint8_t code);
+  bool checkline();
   void writecommand(uint8_t *cmd, uint8_t cmdlen);
+  void writeframe(uint8_t *cmd, uint8_t cmdlen);
+  bool startframe(uint8_t *cmd, uint8_t cmdlen, uint16_t timeout);
+  int16_t readresponse(uint16_t timeout);
+  bool targetCommand(uint8_t command);
+  void readTargetBitRates(uint8_t tg, uint16_t end);
+  bool waitCommandAck(uint16_t timeout, bool waitResponse = true);
+  void attachIrq();
+  void detachIrq();
+  bool i2cready();
   bool isready();
   bool waitready(uint16_t timeout);
+  bool waitreadyspi(uint16_t timeout);
   bool readack();
 
   Adafruit_SPIDevice *spi_dev = NULL;
@@ -0,0 +1,130 @@
+/**************************************************************************/
+/*!
+    @file     i2c_speed.ino
+    @license  BSD (see license.txt)
+
+    This example measures the host to PN532 throughput over I2C at each
+    clock speed (100 kHz, 400 kHz and 1 MHz), then keeps the fastest one
+    the bus carries.
+
+    For every speed, setI2CSpeed() sets the clock and checks it with a few
+    Diagnose communication line tests; when they fail (NACK or corrupted
+    echo) the next lower speed is used instead. A line test echoing a
+    block of data is then timed a number of times, and the average time
+    per command and the bytes per second in both directions are printed.
+    No card is needed.
+
+    The PN532 datasheet specifies I2C up to 400 kHz: 1 MHz works only on
+    some boards, with short wires and strong pull-ups.
+
+This is an example sketch for the Adafruit PN532 NFC/RFID breakout boards
+This library works with the Adafruit NFC breakout
+  ----> https://www.adafruit.com/products/364
+
+Check out the links above for our tutorials and wiring diagrams
+These chips use SPI or I2C to communicate.
+*/
+/**************************************************************************/
+#include <Wire.h>
+#include <SPI.h>
+#include <Adafruit_PN532.h>
+
+// Define the pins connected to the IRQ and reset lines.  Use the values
+// below (2, 3) for the shield!
+#define PN532_IRQ   (2)
+#define PN532_RESET (3)  // Not connected by default on the NFC Shield
+
+// Number of line tests timed at each speed
+#define EXCHANGES (50)
+
+// Data bytes echoed by each line test: command and response frames both
+// fit in a 32-byte Wire buffer
+#define ECHO_LENGTH (20)
+
+Adafruit_PN532 nfc(PN532_IRQ, PN532_RESET);
+
+const uint32_t speeds[] = { PN532_I2C_STANDARD_HZ, PN532_I2C_FAST_HZ,
+                            PN532_I2C_FASTPLUS_HZ };
+
+uint8_t command[2 + ECHO_LENGTH];
+uint8_t response[1 + ECHO_LENGTH];
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10); // for Leonardo/Micro/Zero
+  Serial.println("Hello!");
+
+  nfc.begin();
+
+  uint32_t versiondata = nfc.getFirmwareVersion();
+  if (! versiondata) {
+    Serial.print("Didn't find PN53x board");
+    while (1); // halt
+  }
+
+  // Got ok data, print it out!
+  Serial.print("Found chip PN5"); Serial.println((versiondata>>24) & 0xFF, HEX);
+  Serial.print("Firmware ver. "); Serial.print((versiondata>>16) & 0xFF, DEC);
+  Serial.print('.'); Serial.println((versiondata>>8) & 0xFF, DEC);
+
+  // Diagnose, communication line test, then the data to echo
+  command[0] = PN532_COMMAND_DIAGNOSE;
+  command[1] = 0x00;
+  for (uint8_t i = 0; i < ECHO_LENGTH; i++) {
+    command[2 + i] = i * 13;
+  }
+}
+
+void loop(void) {
+  uint32_t fastest = 0;
+
+  for (uint8_t s = 0; s < sizeof(speeds) / sizeof(speeds[0]); s++) {
+    Serial.print(speeds[s] / 1000); Serial.print(" kHz: ");
+
+    uint32_t speed = nfc.setI2CSpeed(speeds[s]);
+    if (speed != speeds[s]) {
+      Serial.print("not usable, ");
+      if (speed == 0) {
+        Serial.println("no working speed");
+        continue;
+      }
+      Serial.print("fell back to "); Serial.print(speed / 1000);
+      Serial.println(" kHz");
+      continue;
+    }
+    fastest = speed;
+
+    uint32_t bytes = 0;
+    uint16_t done = 0;
+    uint32_t start = micros();
+    for (; done < EXCHANGES; done++) {
+      if (!nfc.startCommand(command, sizeof(command)) ||
+          (nfc.finishCommand(response, sizeof(response)) != sizeof(response)) ||
+          (memcmp(response + 1, command + 2, ECHO_LENGTH) != 0)) {
+        break;
+      }
+      bytes += sizeof(command) + sizeof(response);
+    }
+    uint32_t elapsed = micros() - start;
+
+    if (done == 0) {
+      Serial.println("line test failed");
+      continue;
+    }
+    Serial.print(elapsed / done / 1000.0, 2); Serial.print(" ms/command, ");
+    Serial.print(bytes * 1000000.0 / elapsed, 0); Serial.print(" bytes/s");
+    if (done < EXCHANGES) {
+      Serial.print(" (failed after "); Serial.print(done); Serial.print(" commands)");
+    }
+    Serial.println("");
+  }
+
+  // Keep the fastest speed that passed
+  if (fastest != 0) {
+    nfc.setI2CSpeed(fastest);
+    Serial.print("Using "); Serial.print(fastest / 1000); Serial.println(" kHz");
+  }
+
+  Serial.println("");
+  delay(5000);
+}
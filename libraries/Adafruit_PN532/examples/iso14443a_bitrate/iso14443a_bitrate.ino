@@ -0,0 +1,160 @@
+/**************************************************************************/
+/*!
+    @file     iso14443a_bitrate.ino
+    @license  BSD (see license.txt)
+
+    This example measures the APDU throughput of an ISO14443-4 card at
+    each RF bit rate (106, 212, 424 and 848 kbps) supported by both the
+    card and the PN532.
+
+    For every rate, the card is activated at 106 kbps, switched to the
+    rate with InPSL, then the same APDU is exchanged a number of times.
+    The average time per APDU and the bytes per second in both directions
+    are printed. The RF field is cycled between rates so that the card
+    starts again from 106 kbps.
+
+    Keep the card still on the antenna for the whole run: higher rates
+    are more sensitive to distance and alignment.
+
+This is an example sketch for the Adafruit PN532 NFC/RFID breakout boards
+This library works with the Adafruit NFC breakout
+  ----> https://www.adafruit.com/products/364
+
+Check out the links above for our tutorials and wiring diagrams
+These chips use SPI or I2C to communicate.
+*/
+/**************************************************************************/
+#include <Wire.h>
+#include <SPI.h>
+#include <Adafruit_PN532.h>
+
+// If using the breakout with SPI, define the pins for SPI communication.
+#define PN532_SCK  (2)
+#define PN532_MOSI (3)
+#define PN532_SS   (4)
+#define PN532_MISO (5)
+
+// If using the breakout or shield with I2C, define just the pins connected
+// to the IRQ and reset lines.  Use the values below (2, 3) for the shield!
+#define PN532_IRQ   (2)
+#define PN532_RESET (3)  // Not connected by default on the NFC Shield
+
+// Number of APDUs timed at each bit rate
+#define EXCHANGES (50)
+
+// Uncomment just _one_ line below depending on how your breakout or shield
+// is connected to the Arduino:
+
+// Use this line for a breakout with a SPI connection:
+Adafruit_PN532 nfc(PN532_SCK, PN532_MISO, PN532_MOSI, PN532_SS);
+
+// Use this line for a breakout with a hardware SPI connection.  Note that
+// the PN532 SCK, MOSI, and MISO pins need to be connected to the Arduino's
+// hardware SPI SCK, MOSI, and MISO pins.  On an Arduino Uno these are
+// SCK = 13, MOSI = 11, MISO = 12.  The SS line can be any digital IO pin.
+//Adafruit_PN532 nfc(PN532_SS);
+
+// Or use this line for a breakout or shield with an I2C connection:
+//Adafruit_PN532 nfc(PN532_IRQ, PN532_RESET);
+
+// SELECT by name with an empty AID: answered by most ISO14443-4 cards
+uint8_t apdu[] = { 0x00, 0xA4, 0x04, 0x00, 0x00 };
+uint8_t response[255];
+
+const uint16_t kbps[] = { 106, 212, 424, 848 };
+
+// Turn the RF field off then on again (RFConfiguration, item 1)
+bool cycleField(void) {
+  uint8_t off[] = { PN532_COMMAND_RFCONFIGURATION, 0x01, 0x00 };
+  uint8_t on[] = { PN532_COMMAND_RFCONFIGURATION, 0x01, 0x01 };
+
+  if (!nfc.startCommand(off, sizeof(off)) || (nfc.finishCommand(NULL, 0) < 0)) {
+    return false;
+  }
+  delay(10);
+  return nfc.startCommand(on, sizeof(on)) && (nfc.finishCommand(NULL, 0) >= 0);
+}
+
+// Activate the card and switch it to bit rate 'rate' (PN532_BITRATE_*)
+bool activate(uint8_t rate) {
+  if (!cycleField() || !nfc.inListPassiveTarget()) {
+    return false;
+  }
+  if (rate == PN532_BITRATE_106) {
+    return true;
+  }
+
+  // TA(1): same rate supported from the reader (bits 0..2) and to it (bits 4..6)
+  uint8_t ta = nfc.targetBitRates();
+  if (((ta & (1 << (rate - 1))) == 0) || ((ta & (1 << (rate + 3))) == 0)) {
+    return false;
+  }
+  return nfc.inPSL(rate, rate);
+}
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10); // for Leonardo/Micro/Zero
+  Serial.println("Hello!");
+
+  nfc.begin();
+
+  uint32_t versiondata = nfc.getFirmwareVersion();
+  if (! versiondata) {
+    Serial.print("Didn't find PN53x board");
+    while (1); // halt
+  }
+
+  // Got ok data, print it out!
+  Serial.print("Found chip PN5"); Serial.println((versiondata>>24) & 0xFF, HEX);
+  Serial.print("Firmware ver. "); Serial.print((versiondata>>16) & 0xFF, DEC);
+  Serial.print('.'); Serial.println((versiondata>>8) & 0xFF, DEC);
+
+  // Retry activation a limited number of times, so that a card lost at a
+  // higher rate does not block the benchmark
+  nfc.setPassiveActivationRetries(0x10);
+
+  Serial.println("Waiting for an ISO14443-4 card");
+  while (!nfc.inListPassiveTarget()) {
+    delay(100);
+  }
+  Serial.print("Card found, ATS TA(1) = 0x");
+  Serial.println(nfc.targetBitRates(), HEX);
+}
+
+void loop(void) {
+  for (uint8_t rate = PN532_BITRATE_106; rate <= PN532_BITRATE_848; rate++) {
+    Serial.print(kbps[rate]); Serial.print(" kbps: ");
+
+    if (!activate(rate)) {
+      Serial.println("not supported");
+      continue;
+    }
+
+    uint32_t bytes = 0;
+    uint16_t done = 0;
+    uint32_t start = micros();
+    for (; done < EXCHANGES; done++) {
+      uint16_t responseLength = sizeof(response);
+      if (!nfc.inDataExchange(apdu, sizeof(apdu), response, &responseLength)) {
+        break;
+      }
+      bytes += sizeof(apdu) + responseLength;
+    }
+    uint32_t elapsed = micros() - start;
+
+    if (done == 0) {
+      Serial.println("exchange failed");
+      continue;
+    }
+    Serial.print(elapsed / done / 1000.0, 2); Serial.print(" ms/APDU, ");
+    Serial.print(bytes * 1000000.0 / elapsed, 0); Serial.print(" bytes/s");
+    if (done < EXCHANGES) {
+      Serial.print(" (failed after "); Serial.print(done); Serial.print(" APDUs)");
+    }
+    Serial.println("");
+  }
+
+  Serial.println("");
+  delay(5000);
+}
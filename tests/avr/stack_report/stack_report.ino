@@ -0,0 +1,169 @@
+/**
+ * @file stack_report.ino
+ * @brief Static and peak stack SRAM of the handshake on an AVR.
+ *
+ * Runs the handshake against CryptnoxCardSimulator, with no reader, as the
+ * blocking processCard(), the pipelined processCard() and a poll-driven tap.
+ * For each it prints the static SRAM of the sketch (.data and .bss), the peak
+ * stack of the handshake and their sum, against the SRAM of the part, then
+ * halts. CryptnoxWallet holds its CW_ScratchArena in .bss rather than on the
+ * stack, so only the sum tells whether a change saved RAM.
+ *
+ * Peak stack is measured by painting the free RAM between the end of .bss
+ * and the stack pointer before each run and finding the deepest byte
+ * overwritten; it includes the card simulator and the interrupt handlers.
+ *
+ * The sketch is built from a folder holding it together with the SDK sources
+ * of examples/ (without examples.ino and the PN532 adapter) and
+ * tests/host/CryptnoxCardSimulator.*, against libraries/, and run in simavr;
+ * see .github/workflows/avr_sram.yml.
+ */
+
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include "ArduinoSerialAdapter.h"
+#include "CryptnoxCardSimulator.h"
+#include "CryptnoxWallet.h"
+
+/**
+ * @def REPORT_PAINT
+ * @brief Value painted over the free RAM.
+ */
+#define REPORT_PAINT         (0xA5U)
+
+/**
+ * @def REPORT_STACK_MARGIN
+ * @brief Bytes left unpainted below the stack pointer of the painting function.
+ */
+#define REPORT_STACK_MARGIN  (16U)
+
+extern uint8_t __data_start; /**< Start of .data, first byte of static SRAM */
+extern uint8_t __bss_end;    /**< End of .bss, last byte of static SRAM + 1 */
+extern void* __brkval;       /**< End of the heap, NULL while it is unused */
+
+/** @brief Way the handshake is driven. */
+enum class ReportPath : uint8_t {
+    SEQUENTIAL,
+    PIPELINED,
+    TAP
+};
+
+ArduinoSerialAdapter serialAdapter;
+CryptnoxCardSimulator card(serialAdapter);
+CryptnoxWallet wallet(card, serialAdapter);
+CW_TapContext tap;
+
+/**
+ * @brief Lowest address the stack can grow to.
+ *
+ * @return End of the heap, or of .bss when the heap is unused.
+ */
+static uint8_t* freeRamStart() {
+    return (__brkval != NULL) ? (uint8_t*)__brkval : &__bss_end;
+}
+
+/**
+ * @brief Paint the free RAM below the caller.
+ */
+static __attribute__((noinline)) void paintStack() {
+    uint8_t* p = freeRamStart();
+    uint8_t* end = (uint8_t*)SP - REPORT_STACK_MARGIN;
+
+    while (p < end) {
+        *p = REPORT_PAINT;
+        p++;
+    }
+}
+
+/**
+ * @brief Deepest stack use below @p top since paintStack().
+ *
+ * @param top Stack pointer of the caller when it painted the stack.
+ * @return Bytes of stack used below @p top.
+ */
+static uint16_t measureStack(const uint8_t* top) {
+    const uint8_t* p = freeRamStart();
+
+    while ((p < top) && (*p == REPORT_PAINT)) {
+        p++;
+    }
+
+    return (uint16_t)(top - p);
+}
+
+/**
+ * @brief Run one handshake along @p path.
+ */
+static __attribute__((noinline)) void runPath(ReportPath path) {
+    wallet.setPipelinedHandshake(path == ReportPath::PIPELINED);
+    if (path == ReportPath::TAP) {
+        wallet.beginTap(tap);
+        while (wallet.poll(tap) == CW_TapStatus::BUSY) {
+        }
+    } else {
+        (void)wallet.processCard();
+    }
+}
+
+/**
+ * @brief Measure and print one path.
+ *
+ * @param name Label of the path.
+ * @param path Way the handshake is driven.
+ */
+static void reportPath(const __FlashStringHelper* name, ReportPath path) {
+    uint16_t staticBytes = (uint16_t)(&__bss_end - &__data_start);
+    uint16_t ramBytes = (uint16_t)(RAMEND + 1U - RAMSTART);
+    const uint8_t* top = (const uint8_t*)SP;
+
+    paintStack();
+    runPath(path);
+    uint16_t peak = measureStack(top);
+
+    serialAdapter.print(F("SRAM "));
+    serialAdapter.print(name);
+    serialAdapter.print(F(": static "));
+    serialAdapter.print(staticBytes);
+    serialAdapter.print(F(" + peak stack "));
+    serialAdapter.print(peak);
+    serialAdapter.print(F(" = "));
+    serialAdapter.print((uint16_t)(staticBytes + peak));
+    serialAdapter.print(F(" of "));
+    serialAdapter.print(ramBytes);
+    serialAdapter.print(F(" bytes, PIN "));
+    serialAdapter.println(card.isPinVerified() ? F("verified") : F("NOT verified"));
+}
+
+/**
+ * @brief Arduino setup function: runs the three reports, then halts.
+ */
+void setup() {
+    serialAdapter.begin(115200);
+
+    serialAdapter.print(F("SRAM sizeof(CryptnoxWallet) "));
+    serialAdapter.print((uint16_t)sizeof(CryptnoxWallet));
+    serialAdapter.print(F(", of which CW_ScratchArena "));
+    serialAdapter.print((uint16_t)sizeof(CW_ScratchArena));
+    serialAdapter.print(F("; sizeof(CW_TapContext) "));
+    serialAdapter.println((uint16_t)sizeof(CW_TapContext));
+
+    if (wallet.begin()) {
+        reportPath(F("processCard, sequential"), ReportPath::SEQUENTIAL);
+        reportPath(F("processCard, pipelined"), ReportPath::PIPELINED);
+        reportPath(F("poll() tap"), ReportPath::TAP);
+    } else {
+        serialAdapter.println(F("SRAM wallet init failed"));
+    }
+
+    /* Send buffered output, then stop: simavr exits on sleep with interrupts off */
+    serialAdapter.flush();
+    cli();
+    sleep_enable();
+    sleep_cpu();
+}
+
+/**
+ * @brief Arduino main loop, not reached.
+ */
+void loop() {
+}
@@ -0,0 +1,598 @@
+#include <Arduino.h>
+#include <SHA512.h>
+#include "CryptnoxCardSimulator.h"
+#include "uECC.h"
+
+#define SIM_BLOCK_SIZE              16U
+#define SIM_HEADER_SIZE              5U
+#define SIM_SALT_SIZE               32U
+#define SIM_CHALLENGE_SIZE          32U
+#define SIM_NONCE_SIZE               8U
+#define SIM_SELECT_DATA_SIZE        24U
+#define SIM_CERT_SIGNATURE_SIZE     72U
+#define SIM_PAIRING_DATA            "Cryptnox Basic CommonPairingData"
+
+/* SELECT command of the Cryptnox application */
+static const uint8_t sim_selectCommand[] = {
+    0x00, 0xA4, 0x04, 0x00, 0x07, 0xA0, 0x00, 0x00, 0x10, 0x00, 0x01, 0x12
+};
+
+/* Fixed 4-byte UID reported by readUID() */
+static const uint8_t sim_uid[] = { 0x08, 0xC7, 0x1F, 0x5A };
+
+/**
+ * @brief Construct the simulator.
+ *
+ * @param serialDriver Reference to SerialDriver for debug output.
+ */
+CryptnoxCardSimulator::CryptnoxCardSimulator(SerialDriver& serialDriver)
+    : serial(&serialDriver) {
+    const uint8_t defaultPin[] = { 0x31, 0x32, 0x33, 0x34 }; /* PIN code 1234 */
+
+    (void)setPin(defaultPin, sizeof(defaultPin));
+    memset(ephemeralPublicKey, 0U, sizeof(ephemeralPublicKey));
+    memset(ephemeralPrivateKey, 0U, sizeof(ephemeralPrivateKey));
+    memset(lastMac, 0U, sizeof(lastMac));
+    memset(responseBuffer, 0U, sizeof(responseBuffer));
+}
+
+/**
+ * @brief Set the card latency of one command.
+ *
+ * @param command Command to configure.
+ * @param latencyMs Latency in milliseconds.
+ */
+void CryptnoxCardSimulator::setLatency(CW_SimCommand command, uint16_t latencyMs) {
+    if (command < CW_SimCommand::COUNT) {
+        latency[(uint8_t)command] = latencyMs;
+    }
+}
+
+/**
+ * @brief Put the card in or out of the field.
+ *
+ * @param present true if the card is in the field.
+ */
+void CryptnoxCardSimulator::setCardPresent(bool present) {
+    cardPresent = present;
+    if (present == false) {
+        resetReader();
+    }
+}
+
+/**
+ * @brief Change the accepted PIN.
+ *
+ * @param newPin PIN digits.
+ * @param newPinLength Number of digits.
+ * @return true if stored, false if too long.
+ */
+bool CryptnoxCardSimulator::setPin(const uint8_t* newPin, uint8_t newPinLength) {
+    bool ret = false;
+
+    if ((newPin != NULL) && (newPinLength <= CW_SIM_MAX_PIN_SIZE)) {
+        memcpy(pin, newPin, newPinLength);
+        pinLength = newPinLength;
+        ret = true;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Host time spent before the last occurrence of a command.
+ *
+ * @param command Command to query.
+ * @return Time in microseconds.
+ */
+uint32_t CryptnoxCardSimulator::hostTimeMicros(CW_SimCommand command) const {
+    uint32_t ret = 0U;
+
+    if (command < CW_SimCommand::COUNT) {
+        ret = hostTime[(uint8_t)command];
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Initialize the simulator.
+ *
+ * @return Always true.
+ */
+bool CryptnoxCardSimulator::begin() {
+    resetReader();
+    return true;
+}
+
+/**
+ * @brief Detect the simulated card, waiting for the DETECT latency.
+ *
+ * @return true if the card is present.
+ */
+bool CryptnoxCardSimulator::inListPassiveTarget() {
+    (void)startListPassiveTarget();
+    return finishListPassiveTarget();
+}
+
+/**
+ * @brief Start target detection.
+ *
+ * @return Always true.
+ */
+bool CryptnoxCardSimulator::startListPassiveTarget() {
+    readyAt = millis() + latency[(uint8_t)CW_SimCommand::DETECT];
+    pending = true;
+    return true;
+}
+
+/**
+ * @brief Complete target detection; a detected card starts with no application selected.
+ *
+ * @return true if the card is present.
+ */
+bool CryptnoxCardSimulator::finishListPassiveTarget() {
+    while (isResponseReady() == false) {
+        delay(1U);
+    }
+    pending = false;
+    held = false;
+    lastResponseAt = micros();
+
+    if (cardPresent) {
+        resetReader();
+        detections++;
+    }
+
+    return cardPresent;
+}
+
+/**
+ * @brief Process an APDU and return its response after the command latency.
+ *
+ * @return true if a response was returned.
+ */
+bool CryptnoxCardSimulator::sendAPDU(const uint8_t* apdu, uint16_t apduLength,
+                                     uint8_t* response, uint16_t &responseLength) {
+    bool ret = false;
+
+    if (startAPDU(apdu, apduLength)) {
+        ret = finishAPDU(response, responseLength);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Process an APDU; its response is ready after the command latency.
+ *
+ * @return true if the card is present and the APDU fits.
+ */
+bool CryptnoxCardSimulator::startAPDU(const uint8_t* apdu, uint16_t apduLength) {
+    bool ret = false;
+
+    if (cardPresent && (apdu != NULL) && (apduLength >= SIM_HEADER_SIZE) && (apduLength <= CW_SIM_BUFFER_SIZE)) {
+        uint32_t arrivedAt = micros();
+        CW_SimCommand command = process(apdu, apduLength);
+
+        hostTime[(uint8_t)command] = arrivedAt - lastResponseAt;
+        readyAt = millis() + latency[(uint8_t)command];
+        pending = true;
+        apdus++;
+        ret = true;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Wait for the pending APDU latency and return its response.
+ *
+ * @return true if a response was returned.
+ */
+bool CryptnoxCardSimulator::finishAPDU(uint8_t* response, uint16_t &responseLength) {
+    bool ret = false;
+
+    if (pending) {
+        while (isResponseReady() == false) {
+            delay(1U);
+        }
+        pending = false;
+
+        if ((response != NULL) && (responseBufferLength <= responseLength)) {
+            memcpy(response, responseBuffer, responseBufferLength);
+            responseLength = responseBufferLength;
+            ret = true;
+        }
+
+        lastResponseAt = micros();
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Check whether the pending latency has elapsed.
+ *
+ * @return true if the response can be read without waiting.
+ */
+bool CryptnoxCardSimulator::isResponseReady() {
+    return ((int32_t)(millis() - readyAt) >= 0);
+}
+
+/**
+ * @brief Return the fixed UID of the simulated card.
+ *
+ * @return true if the card is present.
+ */
+bool CryptnoxCardSimulator::readUID(uint8_t* uidBuffer, uint8_t &uidLength) {
+    bool ret = false;
+
+    if (cardPresent && (uidBuffer != NULL)) {
+        memcpy(uidBuffer, sim_uid, sizeof(sim_uid));
+        uidLength = sizeof(sim_uid);
+        ret = true;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Drop the selected application and the secure channel.
+ */
+void CryptnoxCardSimulator::resetReader() {
+    selected = false;
+    pending = false;
+    closeChannel();
+}
+
+/**
+ * @brief Drop the pending operation.
+ */
+void CryptnoxCardSimulator::abortAPDU() {
+    if (pending) {
+        pending = false;
+        aborts++;
+    }
+}
+
+/**
+ * @brief Deselect the card, keeping it for reselectTarget().
+ *
+ * @return true if the card is present.
+ */
+bool CryptnoxCardSimulator::holdTarget() {
+    resetReader();
+    held = cardPresent;
+    return held;
+}
+
+/**
+ * @brief Wake the held card with no application selected.
+ *
+ * @return true if a card is held and still present.
+ */
+bool CryptnoxCardSimulator::reselectTarget() {
+    bool ret = held && cardPresent;
+
+    held = false;
+    if (ret) {
+        resetReader();
+        lastResponseAt = micros();
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Print the simulator identification.
+ *
+ * @return Always true.
+ */
+bool CryptnoxCardSimulator::printFirmwareVersion() {
+    serial->println(F("Cryptnox card simulator (no PN532)"));
+    return true;
+}
+
+/**
+ * @brief Dispatch one command to its handler.
+ *
+ * @return Command kind.
+ */
+CW_SimCommand CryptnoxCardSimulator::process(const uint8_t* apdu, uint16_t apduLength) {
+    CW_SimCommand command = CW_SimCommand::OTHER;
+    const uint8_t ins = apdu[1];
+
+    if (ins == 0xA4U) {
+        command = CW_SimCommand::SELECT;
+        closeChannel();
+        selected = (apduLength == sizeof(sim_selectCommand)) &&
+                   (memcmp(apdu, sim_selectCommand, sizeof(sim_selectCommand)) == 0);
+        if (selected) {
+            uint8_t selectData[SIM_SELECT_DATA_SIZE] = { 0U };
+            memcpy(responseBuffer, selectData, sizeof(selectData));
+            responseBuffer[SIM_SELECT_DATA_SIZE] = 0x90U;
+            responseBuffer[SIM_SELECT_DATA_SIZE + 1U] = 0x00U;
+            responseBufferLength = SIM_SELECT_DATA_SIZE + 2U;
+        } else {
+            setStatus(0x6AU, 0x82U); /* File not found */
+        }
+    }
+    else if (selected == false) {
+        setStatus(0x69U, 0x85U); /* Conditions of use not satisfied */
+    }
+    else if (ins == 0xF8U) {
+        command = CW_SimCommand::CARD_CERTIFICATE;
+        handleCardCertificate(apdu, apduLength);
+    }
+    else if (ins == 0x10U) {
+        command = CW_SimCommand::OPEN_SECURE_CHANNEL;
+        handleOpenSecureChannel(apdu, apduLength);
+    }
+    else {
+        uint8_t plain[CW_SIM_BUFFER_SIZE];
+        uint16_t plainLength = 0U;
+
+        if (ins == 0x11U) {
+            command = CW_SimCommand::MUTUALLY_AUTHENTICATE;
+        } else if (ins == 0x20U) {
+            command = CW_SimCommand::VERIFY_PIN;
+        } else {
+            /* Other secure command */
+        }
+
+        if ((channelOpen == false) || ((command != CW_SimCommand::MUTUALLY_AUTHENTICATE) && (authenticated == false))) {
+            setStatus(0x69U, 0x85U);
+        }
+        else if (unwrapCommand(apdu, apduLength, plain, plainLength) == false) {
+            closeChannel();
+            setStatus(0x69U, 0x82U); /* Security status not satisfied */
+        }
+        else if (command == CW_SimCommand::MUTUALLY_AUTHENTICATE) {
+            uint8_t challenge[SIM_CHALLENGE_SIZE];
+            (void)rng(challenge, sizeof(challenge));
+            authenticated = true;
+            wrapResponse(challenge, sizeof(challenge));
+        }
+        else if (command == CW_SimCommand::VERIFY_PIN) {
+            pinVerified = (plainLength == pinLength) && (memcmp(plain, pin, pinLength) == 0);
+            if (pinVerified) {
+                wrapResponse(NULL, 0U);
+            } else {
+                setStatus(0x63U, 0xC0U); /* Wrong PIN */
+            }
+        }
+        else {
+            setStatus(0x6DU, 0x00U); /* INS not supported */
+        }
+
+        memset(plain, 0U, sizeof(plain));
+    }
+
+    return command;
+}
+
+/**
+ * @brief GET CARD CERTIFICATE: 'C' || nonce || 0x04 || ephemeral key || signature placeholder.
+ */
+void CryptnoxCardSimulator::handleCardCertificate(const uint8_t* apdu, uint16_t apduLength) {
+    if ((apduLength != (SIM_HEADER_SIZE + SIM_NONCE_SIZE)) || (apdu[4] != SIM_NONCE_SIZE)) {
+        setStatus(0x67U, 0x00U); /* Wrong length */
+    }
+    else {
+        uECC_RNG_Function hostRng = uECC_get_rng();
+        uint16_t offset = 0U;
+        bool keyOk;
+
+        closeChannel();
+
+        /* New ephemeral key for every certificate, without disturbing the host RNG */
+        uECC_set_rng(&rng);
+        keyOk = (uECC_make_key(ephemeralPublicKey, ephemeralPrivateKey, uECC_secp256r1()) != 0);
+        uECC_set_rng(hostRng);
+
+        if (keyOk) {
+            responseBuffer[offset++] = 'C';
+            memcpy(responseBuffer + offset, apdu + SIM_HEADER_SIZE, SIM_NONCE_SIZE);
+            offset += SIM_NONCE_SIZE;
+            responseBuffer[offset++] = 0x04U;
+            memcpy(responseBuffer + offset, ephemeralPublicKey, sizeof(ephemeralPublicKey));
+            offset += sizeof(ephemeralPublicKey);
+
+            /* DER SEQUENCE header followed by zeros: not a real signature */
+            memset(responseBuffer + offset, 0U, SIM_CERT_SIGNATURE_SIZE);
+            responseBuffer[offset] = 0x30U;
+            responseBuffer[offset + 1U] = SIM_CERT_SIGNATURE_SIZE - 2U;
+            offset += SIM_CERT_SIGNATURE_SIZE;
+
+            responseBuffer[offset++] = 0x90U;
+            responseBuffer[offset++] = 0x00U;
+            responseBufferLength = (uint8_t)offset;
+        } else {
+            setStatus(0x6FU, 0x00U);
+        }
+    }
+}
+
+/**
+ * @brief OPEN SECURE CHANNEL: ECDH with the host key, salt, SHA-512 key derivation.
+ */
+void CryptnoxCardSimulator::handleOpenSecureChannel(const uint8_t* apdu, uint16_t apduLength) {
+    const uint8_t keyLength = sizeof(ephemeralPublicKey);
+    uint8_t sharedSecret[32U] = { 0U };
+
+    if ((apduLength != (SIM_HEADER_SIZE + 1U + keyLength)) || (apdu[4] != (1U + keyLength)) || (apdu[5] != 0x04U)) {
+        setStatus(0x67U, 0x00U);
+    }
+    else if (uECC_shared_secret(apdu + SIM_HEADER_SIZE + 1U, ephemeralPrivateKey, sharedSecret, uECC_secp256r1()) == 0) {
+        setStatus(0x6AU, 0x80U); /* Incorrect data */
+    }
+    else {
+        uint8_t salt[SIM_SALT_SIZE];
+        uint8_t keys[64U];
+        SHA512 kdf;
+
+        (void)rng(salt, sizeof(salt));
+
+        kdf.update(sharedSecret, sizeof(sharedSecret));
+        kdf.update(SIM_PAIRING_DATA, sizeof(SIM_PAIRING_DATA) - 1U);
+        kdf.update(salt, sizeof(salt));
+        kdf.finalize(keys, sizeof(keys));
+        kdf.clear();
+
+        (void)encCipher.set_key(keys, 32U);
+        (void)macCipher.set_key(keys + 32U, 32U);
+        memset(keys, 0U, sizeof(keys));
+
+        /* MUTUALLY AUTHENTICATE is encrypted with a fixed 0x01 IV */
+        memset(lastMac, 0x01U, sizeof(lastMac));
+        channelOpen = true;
+        authenticated = false;
+        pinVerified = false;
+
+        memcpy(responseBuffer, salt, sizeof(salt));
+        responseBuffer[SIM_SALT_SIZE] = 0x90U;
+        responseBuffer[SIM_SALT_SIZE + 1U] = 0x00U;
+        responseBufferLength = SIM_SALT_SIZE + 2U;
+    }
+
+    /* The ephemeral key is single use */
+    memset(ephemeralPrivateKey, 0U, sizeof(ephemeralPrivateKey));
+    memset(sharedSecret, 0U, sizeof(sharedSecret));
+}
+
+/**
+ * @brief Check the command MAC and decrypt the payload.
+ *
+ * @return true if the MAC is valid and the padding well formed.
+ */
+bool CryptnoxCardSimulator::unwrapCommand(const uint8_t* apdu, uint16_t apduLength, uint8_t* plain, uint16_t& plainLength) {
+    bool ret = false;
+    const uint16_t cipherLength = (uint16_t)(apduLength - SIM_HEADER_SIZE - SIM_BLOCK_SIZE);
+
+    if ((apduLength > (SIM_HEADER_SIZE + SIM_BLOCK_SIZE)) &&
+        (apdu[4] == (apduLength - SIM_HEADER_SIZE)) &&
+        ((cipherLength % SIM_BLOCK_SIZE) == 0U)) {
+        uint8_t macData[SIM_BLOCK_SIZE + CW_SIM_BUFFER_SIZE] = { 0U };
+        uint8_t mac[SIM_BLOCK_SIZE];
+        const uint8_t* commandMac = apdu + SIM_HEADER_SIZE;
+        const uint8_t* cipherText = commandMac + SIM_BLOCK_SIZE;
+
+        /* CLA INS P1 P2 Lc zero padded to one block || ciphertext */
+        memcpy(macData, apdu, SIM_HEADER_SIZE);
+        memcpy(macData + SIM_BLOCK_SIZE, cipherText, cipherLength);
+        cbcMac(macData, (uint16_t)(SIM_BLOCK_SIZE + cipherLength), mac);
+
+        if (memcmp(mac, commandMac, SIM_BLOCK_SIZE) == 0) {
+            uint8_t iv[SIM_BLOCK_SIZE];
+
+            memcpy(iv, lastMac, sizeof(iv));
+            memcpy(plain, cipherText, cipherLength);
+            (void)encCipher.cbc_decrypt(plain, plain, cipherLength / SIM_BLOCK_SIZE, iv);
+
+            /* Strip ISO/IEC 9797-1 Method 2 padding */
+            plainLength = cipherLength;
+            while ((plainLength > 0U) && (plain[plainLength - 1U] == 0x00U)) {
+                plainLength--;
+            }
+            if ((plainLength > 0U) && (plain[plainLength - 1U] == 0x80U)) {
+                plainLength--;
+                ret = true;
+            }
+
+            /* The response is encrypted with the command MAC as IV */
+            memcpy(lastMac, commandMac, sizeof(lastMac));
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Build MAC || ciphertext || 0x90 0x00 and roll the MAC chain.
+ */
+void CryptnoxCardSimulator::wrapResponse(const uint8_t* data, uint16_t dataLength) {
+    const uint16_t cipherLength = (uint16_t)((dataLength + SIM_BLOCK_SIZE) & ~(SIM_BLOCK_SIZE - 1U));
+    uint8_t* mac = responseBuffer;
+    uint8_t* cipherText = responseBuffer + SIM_BLOCK_SIZE;
+
+    if ((SIM_BLOCK_SIZE + cipherLength + 2U) > CW_SIM_BUFFER_SIZE) {
+        setStatus(0x6FU, 0x00U);
+    }
+    else {
+        uint8_t macData[SIM_BLOCK_SIZE + CW_SIM_BUFFER_SIZE] = { 0U };
+        uint8_t iv[SIM_BLOCK_SIZE];
+
+        /* Padding ISO/IEC 9797-1 Method 2 */
+        memset(cipherText, 0U, cipherLength);
+        if (dataLength > 0U) {
+            memcpy(cipherText, data, dataLength);
+        }
+        cipherText[dataLength] = 0x80U;
+
+        memcpy(iv, lastMac, sizeof(iv));
+        (void)encCipher.cbc_encrypt(cipherText, cipherText, cipherLength / SIM_BLOCK_SIZE, iv);
+
+        /* Response length (MAC and ciphertext) zero padded to one block || ciphertext */
+        macData[0] = (uint8_t)(SIM_BLOCK_SIZE + cipherLength);
+        memcpy(macData + SIM_BLOCK_SIZE, cipherText, cipherLength);
+        cbcMac(macData, (uint16_t)(SIM_BLOCK_SIZE + cipherLength), mac);
+
+        /* Next command is encrypted with the response MAC as IV */
+        memcpy(lastMac, mac, sizeof(lastMac));
+
+        responseBuffer[SIM_BLOCK_SIZE + cipherLength] = 0x90U;
+        responseBuffer[SIM_BLOCK_SIZE + cipherLength + 1U] = 0x00U;
+        responseBufferLength = (uint8_t)(SIM_BLOCK_SIZE + cipherLength + 2U);
+    }
+}
+
+/**
+ * @brief Set a status-word-only response.
+ */
+void CryptnoxCardSimulator::setStatus(uint8_t sw1, uint8_t sw2) {
+    responseBuffer[0] = sw1;
+    responseBuffer[1] = sw2;
+    responseBufferLength = 2U;
+}
+
+/**
+ * @brief AES CBC-MAC under Kmac, zero IV and zero padding.
+ */
+void CryptnoxCardSimulator::cbcMac(const uint8_t* data, uint16_t length, uint8_t* mac) {
+    memset(mac, 0U, SIM_BLOCK_SIZE);
+
+    for (uint16_t offset = 0U; offset < length; offset += SIM_BLOCK_SIZE) {
+        uint16_t chunk = (uint16_t)(length - offset);
+        if (chunk > SIM_BLOCK_SIZE) {
+            chunk = SIM_BLOCK_SIZE;
+        }
+        for (uint16_t i = 0U; i < chunk; i++) {
+            mac[i] ^= data[offset + i];
+        }
+        (void)macCipher.encrypt(mac, mac);
+    }
+}
+
+/**
+ * @brief Drop the secure channel and wipe its keys.
+ */
+void CryptnoxCardSimulator::closeChannel() {
+    channelOpen = false;
+    authenticated = false;
+    memset(lastMac, 0U, sizeof(lastMac));
+    encCipher.clean();
+    macCipher.clean();
+}
+
+/**
+ * @brief RNG for the card side, based on the Arduino PRNG.
+ *
+ * @return 1 on success.
+ */
+int CryptnoxCardSimulator::rng(uint8_t* dest, unsigned size) {
+    for (unsigned i = 0U; i < size; i++) {
+        dest[i] = (uint8_t)random(0L, 256L);
+    }
+    return 1;
+}
@@ -0,0 +1,339 @@
+#ifndef CRYPTNOXCARDSIMULATOR_H
+#define CRYPTNOXCARDSIMULATOR_H
+
+#include <Arduino.h>
+#include "AESLib.h"
+#include "NFCDriver.h"
+#include "SerialDriver.h"
+
+#define CW_SIM_MAX_PIN_SIZE  (8U)    /**< Longest PIN accepted by the simulator */
+#define CW_SIM_BUFFER_SIZE   (255U)  /**< Largest command or response handled by the simulator */
+
+/**
+ * @brief Card commands emulated by CryptnoxCardSimulator.
+ *
+ * Used to configure per-command card latency and to read back the host
+ * time spent before each command.
+ */
+enum class CW_SimCommand : uint8_t {
+    DETECT,                /* Card entering the field (passive target detection). */
+    SELECT,                /* SELECT of the Cryptnox application. */
+    CARD_CERTIFICATE,      /* GET CARD CERTIFICATE. */
+    OPEN_SECURE_CHANNEL,   /* OPEN SECURE CHANNEL. */
+    MUTUALLY_AUTHENTICATE, /* MUTUALLY AUTHENTICATE. */
+    VERIFY_PIN,            /* VERIFY PIN (secure messaging). */
+    OTHER,                 /* Any other command. */
+    COUNT                  /* Number of entries, not a command. */
+};
+
+/**
+ * @brief Software Cryptnox card behind an NFCDriver interface.
+ *
+ * CryptnoxCardSimulator emulates the applet side of SELECT, GET CARD CERTIFICATE,
+ * OPEN SECURE CHANNEL, MUTUALLY AUTHENTICATE and VERIFY PIN, including the
+ * ECDH key agreement (micro-ecc), the SHA-512 key derivation and AES-CBC /
+ * CBC-MAC secure messaging (AESLib). It lets CryptnoxWallet run end to end
+ * without a PN532 or a physical card, on the target or on the host build of
+ * tests/host, where it backs the tap tests and the handshake benchmark.
+ *
+ * Each command can be given a card latency. Blocking sendAPDU() waits for it;
+ * the split startAPDU() / isResponseReady() / finishAPDU() calls report the
+ * response as ready once it has elapsed, so poll-driven code sees a realistic
+ * card. The simulator also records the host time between the previous
+ * response and each command, i.e. the CPU cost of every handshake phase.
+ *
+ * The certificate signature is a fixed placeholder: CryptnoxWallet does not
+ * verify it.
+ */
+class CryptnoxCardSimulator : public NFCDriver {
+public:
+    /**
+     * @brief Constructs a simulator with a card in the field, PIN "1234" and no latency.
+     *
+     * @param serialDriver Reference to SerialDriver for debug output.
+     */
+    explicit CryptnoxCardSimulator(SerialDriver& serialDriver);
+
+    /**
+     * @brief Set the card latency of one command.
+     *
+     * @param command Command to configure.
+     * @param latencyMs Time in milliseconds before the response is available.
+     */
+    void setLatency(CW_SimCommand command, uint16_t latencyMs);
+
+    /**
+     * @brief Put the card in or out of the field.
+     *
+     * Removing the card drops the selected application and the secure channel.
+     *
+     * @param present true if the card is in the field.
+     */
+    void setCardPresent(bool present);
+
+    /**
+     * @brief Change the PIN accepted by VERIFY PIN.
+     *
+     * @param pin PIN digits (ASCII).
+     * @param pinLength Number of digits, at most CW_SIM_MAX_PIN_SIZE.
+     * @return true if the PIN was accepted, false if too long.
+     */
+    bool setPin(const uint8_t* pin, uint8_t pinLength);
+
+    /**
+     * @brief Host time spent before the last occurrence of a command.
+     *
+     * Measured from the previous response handed to the host (or from card
+     * detection) to the arrival of the command.
+     *
+     * @param command Command to query.
+     * @return Time in microseconds.
+     */
+    uint32_t hostTimeMicros(CW_SimCommand command) const;
+
+    /**
+     * @brief Time at which the last response was handed to the host.
+     *
+     * @return micros() value.
+     */
+    uint32_t lastResponseMicros() const {
+        return lastResponseAt;
+    }
+
+    /**
+     * @brief Number of APDUs received since construction.
+     *
+     * @return APDU count.
+     */
+    uint16_t apduCount() const {
+        return apdus;
+    }
+
+    /**
+     * @brief Number of full card detections since construction.
+     *
+     * Reselections of a held card are not counted.
+     *
+     * @return Detection count.
+     */
+    uint16_t detectionCount() const {
+        return detections;
+    }
+
+    /**
+     * @brief Number of pending operations aborted since construction.
+     *
+     * @return Abort count.
+     */
+    uint16_t abortCount() const {
+        return aborts;
+    }
+
+    /**
+     * @brief Tell whether the last VERIFY PIN succeeded.
+     *
+     * @return true if the PIN is verified.
+     */
+    bool isPinVerified() const {
+        return pinVerified;
+    }
+
+    /** @name NFCDriver Interface Overrides */
+    ///@{
+
+    /**
+     * @brief Initialize the simulator.
+     *
+     * @return Always true.
+     */
+    bool begin() override;
+
+    /**
+     * @brief Report whether the simulated card is in the field.
+     *
+     * Waits for the DETECT latency.
+     *
+     * @return true if the card is present.
+     */
+    bool inListPassiveTarget() override;
+
+    /**
+     * @brief Start target detection; completes after the DETECT latency.
+     *
+     * @return Always true.
+     */
+    bool startListPassiveTarget() override;
+
+    /**
+     * @brief Complete target detection.
+     *
+     * @return true if the card is present.
+     */
+    bool finishListPassiveTarget() override;
+
+    /**
+     * @brief Process an APDU and return the card's response after its latency.
+     *
+     * @param apdu Pointer to APDU command buffer.
+     * @param apduLength Length of APDU command in bytes.
+     * @param response Buffer to receive the card's response.
+     * @param responseLength Input: size of @p response; Output: length of the response.
+     * @return true if a response was returned.
+     */
+    bool sendAPDU(const uint8_t* apdu, uint16_t apduLength,
+                  uint8_t* response, uint16_t &responseLength) override;
+
+    /**
+     * @brief Process an APDU; the response becomes ready after the command latency.
+     *
+     * @param apdu Pointer to APDU command buffer.
+     * @param apduLength Length of APDU command in bytes.
+     * @return true if the card is present and the APDU fits.
+     */
+    bool startAPDU(const uint8_t* apdu, uint16_t apduLength) override;
+
+    /**
+     * @brief Wait for the latency of the pending APDU and return its response.
+     *
+     * @param response Buffer to receive the card's response.
+     * @param responseLength Input: size of @p response; Output: length of the response.
+     * @return true if a response was returned.
+     */
+    bool finishAPDU(uint8_t* response, uint16_t &responseLength) override;
+
+    /**
+     * @brief Check whether the latency of the pending operation has elapsed.
+     *
+     * @return true if the response can be read without waiting.
+     */
+    bool isResponseReady() override;
+
+    /**
+     * @brief Return a fixed 4-byte UID if the card is present.
+     *
+     * @param uidBuffer Buffer receiving the UID (at least 4 bytes).
+     * @param uidLength Receives the UID length.
+     * @return true if the card is present.
+     */
+    bool readUID(uint8_t* uidBuffer, uint8_t &uidLength) override;
+
+    /**
+     * @brief Drop the selected application and the secure channel.
+     */
+    void resetReader() override;
+
+    /**
+     * @brief Drop the pending operation; its response is never handed out.
+     */
+    void abortAPDU() override;
+
+    /**
+     * @brief Deselect the card: the application and the secure channel are dropped.
+     *
+     * @return true if the card is present.
+     */
+    bool holdTarget() override;
+
+    /**
+     * @brief Wake the card held by holdTarget(), without detection latency.
+     *
+     * @return true if a card is held and still present.
+     */
+    bool reselectTarget() override;
+
+    /**
+     * @brief Print the simulator identification.
+     *
+     * @return Always true.
+     */
+    bool printFirmwareVersion() override;
+
+    ///@}
+
+private:
+    SerialDriver* serial = nullptr; ///< Serial driver for debug output.
+
+    bool cardPresent = true;       ///< Card is in the field.
+    bool selected = false;         ///< Cryptnox application selected.
+    bool channelOpen = false;      ///< OPEN SECURE CHANNEL done, keys derived.
+    bool authenticated = false;    ///< MUTUALLY AUTHENTICATE done.
+    bool pinVerified = false;      ///< VERIFY PIN succeeded.
+    bool pending = false;          ///< A started operation awaits finish.
+    bool held = false;             ///< Card deselected by holdTarget().
+
+    uint16_t latency[(uint8_t)CW_SimCommand::COUNT] = { 0U };      ///< Card latency per command (ms).
+    uint32_t hostTime[(uint8_t)CW_SimCommand::COUNT] = { 0U };     ///< Host time before each command (us).
+    uint32_t lastResponseAt = 0U;  ///< micros() when the last response was handed out.
+    uint32_t readyAt = 0U;         ///< millis() when the pending response becomes ready.
+    uint16_t apdus = 0U;           ///< Number of APDUs processed.
+    uint16_t detections = 0U;      ///< Number of full detections.
+    uint16_t aborts = 0U;          ///< Number of pending operations aborted.
+
+    uint8_t pin[CW_SIM_MAX_PIN_SIZE];                ///< Accepted PIN.
+    uint8_t pinLength = 0U;        ///< Accepted PIN length.
+
+    uint8_t ephemeralPublicKey[64];  ///< Card ephemeral public key (X || Y).
+    uint8_t ephemeralPrivateKey[32]; ///< Card ephemeral private key.
+    AES encCipher;                 ///< Kenc key schedule.
+    AES macCipher;                 ///< Kmac key schedule.
+    uint8_t lastMac[16];           ///< Rolling MAC / IV of the secure channel.
+
+    uint8_t responseBuffer[CW_SIM_BUFFER_SIZE];   ///< Response of the pending APDU.
+    uint8_t responseBufferLength = 0U; ///< Length of @ref responseBuffer.
+
+    /**
+     * @brief Run one command and fill @ref responseBuffer.
+     *
+     * @param apdu Command APDU.
+     * @param apduLength Length of the command.
+     * @return Command kind, for latency and timing bookkeeping.
+     */
+    CW_SimCommand process(const uint8_t* apdu, uint16_t apduLength);
+
+    /** @brief Handle GET CARD CERTIFICATE. */
+    void handleCardCertificate(const uint8_t* apdu, uint16_t apduLength);
+
+    /** @brief Handle OPEN SECURE CHANNEL. */
+    void handleOpenSecureChannel(const uint8_t* apdu, uint16_t apduLength);
+
+    /**
+     * @brief Check the MAC of a secure command and decrypt its payload in place.
+     *
+     * @param apdu Command APDU (header, MAC, ciphertext).
+     * @param apduLength Length of the command.
+     * @param plain Buffer receiving the plaintext.
+     * @param plainLength Receives the plaintext length.
+     * @return true if the MAC is valid.
+     */
+    bool unwrapCommand(const uint8_t* apdu, uint16_t apduLength, uint8_t* plain, uint16_t& plainLength);
+
+    /**
+     * @brief Encrypt and MAC a response payload into @ref responseBuffer, followed by 0x90 0x00.
+     *
+     * @param data Plaintext response data.
+     * @param dataLength Plaintext length.
+     */
+    void wrapResponse(const uint8_t* data, uint16_t dataLength);
+
+    /**
+     * @brief Set a status-word-only response.
+     */
+    void setStatus(uint8_t sw1, uint8_t sw2);
+
+    /**
+     * @brief AES CBC-MAC (zero IV, zero padding) under Kmac.
+     */
+    void cbcMac(const uint8_t* data, uint16_t length, uint8_t* mac);
+
+    /**
+     * @brief Drop the secure channel state and wipe the session keys.
+     */
+    void closeChannel();
+
+    /**
+     * @brief RNG used for the card keys, salt and challenge.
+     */
+    static int rng(uint8_t* dest, unsigned size);
+};
+
+#endif // CRYPTNOXCARDSIMULATOR_H
@@ -0,0 +1,117 @@
+/**
+ * @file bench_handshake.cpp
+ * @brief Handshake time and host CPU cost of each phase, against the card simulator.
+ *
+ * Runs the handshake from card detection to VERIFY PIN with the card latencies
+ * of bench_latency, in the four ways the SDK offers: blocking processCard(),
+ * with and without the pipelined OPEN SECURE CHANNEL, with a keypair pool
+ * filled beforehand, and poll-driven through beginTap()/poll(). For each, the
+ * host time spent before every command (CryptnoxCardSimulator::hostTimeMicros())
+ * and the handshake time, up to the VERIFY PIN response, are averaged over
+ * BENCH_RUNS runs. Time is the virtual time of the host stubs: card latencies
+ * count in full, host work counts as the CPU time it took.
+ *
+ * Exits with an error when a handshake does not end with the PIN verified, or
+ * when one phase costs more than BENCH_PHASE_BUDGET_US of host time.
+ */
+#include <Arduino.h>
+#include "ArduinoSerialAdapter.h"
+#include "CryptnoxCardSimulator.h"
+#include "CryptnoxWallet.h"
+#include "host_test.h"
+
+#define BENCH_RUNS             (5U)       /**< Handshakes averaged per mode */
+#define BENCH_PHASE_BUDGET_US  (100000UL) /**< Host time allowed before any one command */
+#define BENCH_POLL_GAP_US      (100U)     /**< Other work of loop() between two poll() calls */
+
+/* Card latency of each command in ms, in CW_SimCommand order */
+static const uint16_t bench_latency[(uint8_t)CW_SimCommand::COUNT] = {
+    20U,  /* DETECT */
+    10U,  /* SELECT */
+    60U,  /* CARD_CERTIFICATE */
+    120U, /* OPEN_SECURE_CHANNEL */
+    80U,  /* MUTUALLY_AUTHENTICATE */
+    40U,  /* VERIFY_PIN */
+    10U   /* OTHER */
+};
+
+static const char* const bench_phaseNames[(uint8_t)CW_SimCommand::COUNT] = {
+    "detect", "select", "certificate", "open secure channel", "mutual auth", "verify pin", "other"
+};
+
+enum class BenchMode : uint8_t {
+    SEQUENTIAL,
+    PIPELINED,
+    PIPELINED_POOLED,
+    TAP_POOLED
+};
+
+static ArduinoSerialAdapter bench_serial;
+
+/**
+ * @brief Run BENCH_RUNS handshakes in one mode and print their averages.
+ *
+ * @param name Label of the mode.
+ * @param mode Way the handshake is driven.
+ */
+static void runMode(const char* name, BenchMode mode) {
+    uint32_t phaseTotal[(uint8_t)CW_SimCommand::COUNT] = { 0U };
+    uint32_t handshakeTotal = 0U;
+
+    for (uint8_t run = 0U; run < BENCH_RUNS; run++) {
+        CryptnoxCardSimulator card(bench_serial);
+        CryptnoxWallet wallet(card, bench_serial);
+        bool ok = false;
+
+        for (uint8_t c = 0U; c < (uint8_t)CW_SimCommand::COUNT; c++) {
+            card.setLatency((CW_SimCommand)c, bench_latency[c]);
+        }
+        CHECK(wallet.begin());
+        wallet.setPipelinedHandshake(mode != BenchMode::SEQUENTIAL);
+        if ((mode == BenchMode::PIPELINED_POOLED) || (mode == BenchMode::TAP_POOLED)) {
+            while (wallet.refillKeyPool()) {
+            }
+        }
+
+        uint32_t start = micros();
+        if (mode == BenchMode::TAP_POOLED) {
+            CW_TapContext tap;
+            wallet.beginTap(tap);
+            while (wallet.poll(tap) == CW_TapStatus::BUSY) {
+                delayMicroseconds(BENCH_POLL_GAP_US);
+            }
+            ok = (tap.result() == CW_TapStatus::DONE);
+        }
+        else {
+            ok = wallet.processCard();
+        }
+        /* Up to the VERIFY PIN response: processCard() then pauses to show the result */
+        handshakeTotal += card.lastResponseMicros() - start;
+
+        CHECK(ok);
+        CHECK(card.isPinVerified());
+        for (uint8_t c = 0U; c < (uint8_t)CW_SimCommand::COUNT; c++) {
+            phaseTotal[c] += card.hostTimeMicros((CW_SimCommand)c);
+        }
+    }
+
+    printf("%s: handshake %.1f ms\n", name, handshakeTotal / (1000.0 * BENCH_RUNS));
+    for (uint8_t c = (uint8_t)CW_SimCommand::SELECT; c <= (uint8_t)CW_SimCommand::VERIFY_PIN; c++) {
+        uint32_t average = phaseTotal[c] / BENCH_RUNS;
+        printf("  host time before %-20s %8lu us\n", bench_phaseNames[c], (unsigned long)average);
+        CHECK(average <= BENCH_PHASE_BUDGET_US);
+    }
+}
+
+int main() {
+    printf("card latency: detect %u, select %u, certificate %u, open secure channel %u, "
+           "mutual auth %u, verify pin %u ms\n",
+           bench_latency[0], bench_latency[1], bench_latency[2], bench_latency[3], bench_latency[4], bench_latency[5]);
+
+    runMode("processCard, sequential", BenchMode::SEQUENTIAL);
+    runMode("processCard, pipelined", BenchMode::PIPELINED);
+    runMode("processCard, pipelined, keypair pool", BenchMode::PIPELINED_POOLED);
+    runMode("poll() tap, keypair pool", BenchMode::TAP_POOLED);
+
+    return host_testResult("bench_handshake");
+}
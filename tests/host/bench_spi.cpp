@@ -0,0 +1,80 @@
+/**
+ * @file bench_spi.cpp
+ * @brief SPI transactions and SPI driver calls of one Adafruit_PN532 InDataExchange.
+ *
+ * Runs a 40-byte InDataExchange with a 65-byte answer against PN532SpiMock,
+ * BENCH_RUNS times, and prints per exchange the SPI transactions (CS low to
+ * CS high), status bytes and SPI driver calls (transfer() of a byte or of a
+ * buffer). Built twice: bench_spi with the default status polling and
+ * bench_spi_holdcs with PN532_SPI_HOLD_CS_STATUS defined.
+ *
+ * Exits with an error when an exchange fails or when the counts differ from
+ * the expected ones below: the ACK and the response each need a status wait
+ * and a data read, and the mock reports busy on the first ackDelay and
+ * respDelay status bytes.
+ */
+#include <Arduino.h>
+#include <SPI.h>
+#include <string.h>
+#include "Adafruit_PN532.h"
+#include "host_test.h"
+#include "pn532_spi_mock.h"
+
+#define BENCH_RUNS         (20U)  /**< Exchanges averaged */
+#define BENCH_CS_PIN       (10U)  /**< PN532 chip select */
+#define BENCH_APDU_SIZE    (40U)  /**< Bytes sent with each exchange */
+#define BENCH_ANSWER_SIZE  (65U)  /**< Bytes answered by the card */
+
+#ifdef PN532_SPI_HOLD_CS_STATUS
+/* Data write, then one status wait and one data read each for ACK and response */
+#define BENCH_TRANSACTIONS  (5UL)
+/* 1 write; per wait 1 command + 1 call per status byte (2 + 5); per read 1 command + 1 buffer */
+#define BENCH_DRIVER_CALLS  (16UL)
+#define BENCH_NAME          "bench_spi_holdcs"
+#else
+/* Data write, one transaction per status byte (2 + 5) and two data reads */
+#define BENCH_TRANSACTIONS  (10UL)
+/* 1 write; 2 calls per status transaction; per read 1 command + 1 buffer */
+#define BENCH_DRIVER_CALLS  (21UL)
+#define BENCH_NAME          "bench_spi"
+#endif
+
+int main() {
+    uint8_t answer[BENCH_ANSWER_SIZE + 1U];
+    uint8_t apdu[BENCH_APDU_SIZE];
+    uint8_t response[128];
+    uint16_t ok = 0U;
+
+    PN532SpiMock::install(BENCH_CS_PIN);
+    Adafruit_PN532 nfc(BENCH_CS_PIN, &SPI);
+    CHECK(nfc.begin());
+
+    answer[0] = 0x00U; /* InDataExchange status: success */
+    memset(&answer[1], 0x5AU, BENCH_ANSWER_SIZE);
+    PN532SpiMock::setResponse(answer, sizeof(answer));
+    memset(apdu, 0x11U, sizeof(apdu));
+    PN532SpiMock::resetCounters();
+
+    uint32_t start = micros();
+    for (uint16_t i = 0U; i < BENCH_RUNS; i++) {
+        uint16_t responseLength = sizeof(response);
+        if (nfc.inDataExchange(apdu, sizeof(apdu), response, &responseLength) &&
+            (responseLength == BENCH_ANSWER_SIZE) && (response[0] == 0x5AU)) {
+            ok++;
+        }
+    }
+    uint32_t elapsed = micros() - start;
+
+    unsigned long driverCalls = host_spiByteCalls + host_spiBufferCalls;
+    printf("%s: per exchange %lu transactions, %lu status bytes, %lu SPI driver calls "
+           "(%lu byte, %lu buffer), %.1f us\n",
+           BENCH_NAME, PN532SpiMock::transactions / BENCH_RUNS, PN532SpiMock::statusBytes / BENCH_RUNS,
+           driverCalls / BENCH_RUNS, host_spiByteCalls / BENCH_RUNS, host_spiBufferCalls / BENCH_RUNS,
+           (double)elapsed / BENCH_RUNS);
+
+    CHECK(ok == BENCH_RUNS);
+    CHECK(PN532SpiMock::transactions == (BENCH_TRANSACTIONS * BENCH_RUNS));
+    CHECK(driverCalls == (BENCH_DRIVER_CALLS * BENCH_RUNS));
+
+    return host_testResult(BENCH_NAME);
+}
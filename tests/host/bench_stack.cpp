@@ -0,0 +1,165 @@
+/**
+ * @file bench_stack.cpp
+ * @brief Static and peak stack RAM of each way to run the handshake.
+ *
+ * The wallet keeps its command and response buffers in a CW_ScratchArena
+ * member instead of on the stack, which moves RAM from the stack to the
+ * object: the two only make sense together. For the blocking processCard(),
+ * with and without the pipelined OPEN SECURE CHANNEL, and for a poll-driven
+ * tap, this prints the static RAM the caller holds (CryptnoxWallet, plus the
+ * CW_TapContext of a tap), the peak stack of the handshake, and their sum.
+ *
+ * Peak stack is measured by painting the stack below main() before each run
+ * and finding the deepest byte overwritten, after one unmeasured handshake
+ * so that one-time setup does not count. The simulated card does its own
+ * ECDH, which a real card does not do on the host: its commands run on a
+ * separate stack (ucontext), so the figures are those of the wallet and its
+ * libraries alone. Sizes are those of the host build (64-bit pointers);
+ * tests/avr/stack_report measures the same on an AVR.
+ *
+ * Exits with an error when a handshake does not end with the PIN verified.
+ */
+#include <Arduino.h>
+#include <ucontext.h>
+#include "ArduinoSerialAdapter.h"
+#include "CryptnoxCardSimulator.h"
+#include "CryptnoxWallet.h"
+#include "host_test.h"
+
+#define BENCH_PAINT_SIZE  (32768U) /**< Stack bytes painted below main() */
+#define BENCH_PAINT       (0xA5U)  /**< Paint value */
+#define BENCH_CARD_STACK  (65536U) /**< Stack of the simulated card */
+
+enum class BenchPath : uint8_t {
+    SEQUENTIAL,
+    PIPELINED,
+    TAP
+};
+
+/**
+ * @brief Card simulator whose command processing runs on its own stack.
+ */
+class SeparateStackCard : public CryptnoxCardSimulator {
+public:
+    explicit SeparateStackCard(SerialDriver& serialDriver) : CryptnoxCardSimulator(serialDriver) {
+        self = this;
+    }
+
+    bool startAPDU(const uint8_t* apdu, uint16_t apduLength) override {
+        pendingApdu = apdu;
+        pendingLength = apduLength;
+        getcontext(&cardContext);
+        cardContext.uc_stack.ss_sp = cardStack;
+        cardContext.uc_stack.ss_size = sizeof(cardStack);
+        cardContext.uc_link = &walletContext;
+        makecontext(&cardContext, runOnCardStack, 0);
+        swapcontext(&walletContext, &cardContext);
+        return started;
+    }
+
+private:
+    static void runOnCardStack();
+
+    static uint8_t cardStack[BENCH_CARD_STACK];
+    static ucontext_t walletContext;
+    static ucontext_t cardContext;
+    static SeparateStackCard* self;
+
+    const uint8_t* pendingApdu = NULL;
+    uint16_t pendingLength = 0U;
+    bool started = false;
+};
+
+uint8_t SeparateStackCard::cardStack[BENCH_CARD_STACK];
+ucontext_t SeparateStackCard::walletContext;
+ucontext_t SeparateStackCard::cardContext;
+SeparateStackCard* SeparateStackCard::self = NULL;
+
+void SeparateStackCard::runOnCardStack() {
+    self->started = self->CryptnoxCardSimulator::startAPDU(self->pendingApdu, self->pendingLength);
+}
+
+/* Static so that none of them sits on the measured stack */
+static ArduinoSerialAdapter bench_serial;
+static SeparateStackCard bench_card(bench_serial);
+static CryptnoxWallet bench_wallet(bench_card, bench_serial);
+static CW_TapContext bench_tap;
+
+/* Both read and write stack they do not own, on purpose */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-but-set-variable"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+/**
+ * @brief Paint BENCH_PAINT_SIZE bytes of stack below the caller.
+ */
+static __attribute__((noinline)) void paintStack() {
+    volatile uint8_t area[BENCH_PAINT_SIZE];
+    for (uint32_t i = 0U; i < BENCH_PAINT_SIZE; i++) {
+        area[i] = BENCH_PAINT;
+    }
+}
+
+/**
+ * @brief Deepest stack use below the caller since paintStack().
+ *
+ * @return Bytes of stack used.
+ */
+static __attribute__((noinline)) uint32_t measureStack() {
+    volatile uint8_t area[BENCH_PAINT_SIZE];
+    uint32_t untouched = 0U;
+    while ((untouched < BENCH_PAINT_SIZE) && (area[untouched] == BENCH_PAINT)) {
+        untouched++;
+    }
+    return BENCH_PAINT_SIZE - untouched;
+}
+
+#pragma GCC diagnostic pop
+
+/**
+ * @brief Run one handshake along @p path.
+ */
+static __attribute__((noinline)) void runPath(BenchPath path) {
+    bench_wallet.setPipelinedHandshake(path == BenchPath::PIPELINED);
+    if (path == BenchPath::TAP) {
+        bench_wallet.beginTap(bench_tap);
+        while (bench_wallet.poll(bench_tap) == CW_TapStatus::BUSY) {
+        }
+    } else {
+        (void)bench_wallet.processCard();
+    }
+}
+
+/**
+ * @brief Measure and print one path.
+ *
+ * @param name Label of the path.
+ * @param path Way the handshake is driven.
+ */
+static void reportPath(const char* name, BenchPath path) {
+    uint32_t staticBytes = sizeof(CryptnoxWallet) + ((path == BenchPath::TAP) ? sizeof(CW_TapContext) : 0U);
+
+    paintStack();
+    runPath(path);
+    uint32_t peak = measureStack();
+
+    CHECK(bench_card.isPinVerified());
+    printf("%-24s static %5u + peak stack %5u = %5u bytes\n", name, (unsigned)staticBytes, (unsigned)peak,
+           (unsigned)(staticBytes + peak));
+}
+
+int main() {
+    CHECK(bench_wallet.begin());
+
+    /* One handshake first, so one-time setup does not count against the first path */
+    runPath(BenchPath::PIPELINED);
+
+    printf("sizeof(CryptnoxWallet) %u, of which CW_ScratchArena %u; sizeof(CW_TapContext) %u\n",
+           (unsigned)sizeof(CryptnoxWallet), (unsigned)sizeof(CW_ScratchArena), (unsigned)sizeof(CW_TapContext));
+    reportPath("processCard, sequential", BenchPath::SEQUENTIAL);
+    reportPath("processCard, pipelined", BenchPath::PIPELINED);
+    reportPath("poll() tap", BenchPath::TAP);
+
+    return host_testResult("bench_stack");
+}
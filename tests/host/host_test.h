@@ -0,0 +1,34 @@
+/**
+ * @file host_test.h
+ * @brief Check macro and result reporting shared by the host tests.
+ */
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+
+static int host_failures = 0; /**< Failed checks in this test program */
+
+/**
+ * @brief Record a failed check, with its location, when @p condition is false.
+ */
+#define CHECK(condition)                                                      \
+    do {                                                                      \
+        if (!(condition)) {                                                   \
+            host_failures++;                                                  \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        }                                                                     \
+    } while (0)
+
+/**
+ * @brief Print the outcome of a test program.
+ *
+ * @param name Name of the test program.
+ * @return Exit status: 0 if every check passed, 1 otherwise.
+ */
+static inline int host_testResult(const char* name) {
+    printf("%s: %s (%d failed checks)\n", name, (host_failures == 0) ? "PASS" : "FAIL", host_failures);
+    return (host_failures == 0) ? 0 : 1;
+}
+
+#endif // HOST_TEST_H
@@ -0,0 +1,167 @@
+/**
+ * @file pn532_spi_mock.cpp
+ * @brief PN532 model on the host SPI bus.
+ */
+#include <SPI.h>
+#include <string.h>
+#include "pn532_spi_mock.h"
+
+#define MOCK_OP_NONE        (-1)
+#define MOCK_OP_DATAWRITE   (0x01)
+#define MOCK_OP_STATREAD    (0x02)
+#define MOCK_OP_DATAREAD    (0x03)
+#define MOCK_PHASE_IDLE     (0U)
+#define MOCK_PHASE_ACK      (1U)
+#define MOCK_PHASE_RESPONSE (2U)
+#define MOCK_CMD_OFFSET     (6U) /* Command code in a written frame: 00 00 FF LEN LCS D4 cmd */
+
+uint16_t PN532SpiMock::ackDelay = 2U;
+uint16_t PN532SpiMock::respDelay = 5U;
+unsigned long PN532SpiMock::transactions = 0UL;
+unsigned long PN532SpiMock::statusBytes = 0UL;
+uint8_t PN532SpiMock::written[PN532_MOCK_BUFFER_SIZE];
+uint16_t PN532SpiMock::writtenLength = 0U;
+void (*PN532SpiMock::onCommand)(const uint8_t* frame, uint16_t length) = NULL;
+uint8_t PN532SpiMock::cs = 0U;
+bool PN532SpiMock::selected = false;
+int16_t PN532SpiMock::op = MOCK_OP_NONE;
+uint8_t PN532SpiMock::phase = MOCK_PHASE_IDLE;
+int32_t PN532SpiMock::countdown = 0;
+uint8_t PN532SpiMock::responseCode = 0U;
+uint8_t PN532SpiMock::response[PN532_MOCK_BUFFER_SIZE];
+uint16_t PN532SpiMock::responseLength = 0U;
+uint8_t PN532SpiMock::out[PN532_MOCK_BUFFER_SIZE];
+uint16_t PN532SpiMock::outLength = 0U;
+uint16_t PN532SpiMock::outPosition = 0U;
+
+/**
+ * @brief Put the mock on the host SPI bus, selected by @p csPin.
+ */
+void PN532SpiMock::install(uint8_t csPin) {
+    cs = csPin;
+    selected = false;
+    phase = MOCK_PHASE_IDLE;
+    responseLength = 0U;
+    onCommand = NULL;
+    host_onDigitalWrite = onDigitalWrite;
+    host_spiOnByte = onSpiByte;
+    resetCounters();
+}
+
+/**
+ * @brief Set the data bytes of the following responses, after D5 and the response code.
+ */
+void PN532SpiMock::setResponse(const uint8_t* data, uint16_t length) {
+    if (length <= (PN532_MOCK_BUFFER_SIZE - 10U)) {
+        memcpy(response, data, length);
+        responseLength = length;
+    }
+}
+
+/**
+ * @brief Clear the transaction, status byte and SPI driver call counters.
+ */
+void PN532SpiMock::resetCounters() {
+    transactions = 0UL;
+    statusBytes = 0UL;
+    host_spiByteCalls = 0UL;
+    host_spiBufferCalls = 0UL;
+}
+
+/**
+ * @brief CS edges: start or end a transaction.
+ */
+void PN532SpiMock::onDigitalWrite(uint8_t pin, uint8_t value) {
+    if (pin != cs) {
+        return;
+    }
+    if (value == LOW) {
+        selected = true;
+        op = MOCK_OP_NONE;
+        transactions++;
+    } else if (selected) {
+        selected = false;
+        if (op == MOCK_OP_DATAWRITE) {
+            responseCode = (writtenLength > MOCK_CMD_OFFSET) ? (uint8_t)(written[MOCK_CMD_OFFSET] + 1U) : 0U;
+            phase = MOCK_PHASE_ACK;
+            countdown = ackDelay;
+            if (onCommand != NULL) {
+                onCommand(written, writtenLength);
+            }
+        } else if ((op == MOCK_OP_DATAREAD) && isReady()) {
+            if (phase == MOCK_PHASE_ACK) {
+                phase = MOCK_PHASE_RESPONSE;
+                countdown = respDelay;
+            } else {
+                phase = MOCK_PHASE_IDLE;
+            }
+        }
+    }
+}
+
+/**
+ * @brief One byte clocked while CS is low.
+ */
+uint8_t PN532SpiMock::onSpiByte(uint8_t mosi) {
+    uint8_t miso = 0U;
+
+    if (!selected) {
+        miso = 0xFFU;
+    } else if (op == MOCK_OP_NONE) {
+        op = mosi;
+        if (op == MOCK_OP_DATAWRITE) {
+            writtenLength = 0U;
+        } else if (op == MOCK_OP_DATAREAD) {
+            loadReadFrame();
+        }
+    } else if (op == MOCK_OP_DATAWRITE) {
+        if (writtenLength < PN532_MOCK_BUFFER_SIZE) {
+            written[writtenLength++] = mosi;
+        }
+    } else if (op == MOCK_OP_STATREAD) {
+        statusBytes++;
+        countdown--;
+        miso = isReady() ? 0x01U : 0x00U;
+    } else if (op == MOCK_OP_DATAREAD) {
+        miso = (outPosition < outLength) ? out[outPosition++] : 0x00U;
+    }
+
+    return miso;
+}
+
+/**
+ * @brief Whether the status byte reports an ACK or a response to read.
+ */
+bool PN532SpiMock::isReady() {
+    return (phase != MOCK_PHASE_IDLE) && (countdown <= 0);
+}
+
+/**
+ * @brief Load the ACK or the response frame for a data read.
+ */
+void PN532SpiMock::loadReadFrame() {
+    static const uint8_t ack[] = { 0x00U, 0x00U, 0xFFU, 0x00U, 0xFFU, 0x00U };
+
+    outPosition = 0U;
+    if (phase == MOCK_PHASE_ACK) {
+        memcpy(out, ack, sizeof(ack));
+        outLength = sizeof(ack);
+    } else {
+        uint8_t len = (uint8_t)(responseLength + 2U);
+        uint8_t sum = (uint8_t)(0xD5U + responseCode);
+        out[0] = 0x00U;
+        out[1] = 0x00U;
+        out[2] = 0xFFU;
+        out[3] = len;
+        out[4] = (uint8_t)(~len + 1U);
+        out[5] = 0xD5U;
+        out[6] = responseCode;
+        for (uint16_t i = 0U; i < responseLength; i++) {
+            out[7U + i] = response[i];
+            sum = (uint8_t)(sum + response[i]);
+        }
+        out[7U + responseLength] = (uint8_t)(~sum + 1U);
+        out[8U + responseLength] = 0x00U;
+        outLength = (uint16_t)(9U + responseLength);
+    }
+}
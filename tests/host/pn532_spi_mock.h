@@ -0,0 +1,61 @@
+/**
+ * @file pn532_spi_mock.h
+ * @brief PN532 model on the host SPI bus, for the Adafruit_PN532 SPI tests.
+ */
+#ifndef PN532_SPI_MOCK_H
+#define PN532_SPI_MOCK_H
+
+#include <Arduino.h>
+
+#define PN532_MOCK_BUFFER_SIZE (300U) /**< Largest frame written to or read from the mock */
+
+/**
+ * @brief PN532 seen from the SPI bus.
+ *
+ * Follows the SPI framing of the PN532: CS low starts a transaction whose
+ * first byte is the operation (0x01 data write, 0x02 status read, 0x03 data
+ * read), CS high ends it. A command frame is acknowledged after
+ * ackDelay status bytes and answered after respDelay further status bytes,
+ * once its ACK has been read. The answer is a D5 frame with the command
+ * code + 1 and the bytes given to setResponse(). onCommand, if set, sees
+ * each frame as it is written and may call setResponse() to answer it, so a
+ * test can script a sequence of different commands.
+ *
+ * The status byte is repeated for as long as CS stays low, so both the
+ * default status polling and PN532_SPI_HOLD_CS_STATUS can run against it.
+ * There is only one PN532 on the bus: the state is static.
+ */
+class PN532SpiMock {
+public:
+    static void install(uint8_t csPin);
+    static void setResponse(const uint8_t* data, uint16_t length);
+    static void resetCounters();
+
+    static uint16_t ackDelay;          /**< Status bytes reporting busy before the ACK */
+    static uint16_t respDelay;         /**< Status bytes reporting busy before the response */
+    static unsigned long transactions; /**< CS low to CS high sequences */
+    static unsigned long statusBytes;  /**< Status bytes clocked */
+    static uint8_t written[PN532_MOCK_BUFFER_SIZE]; /**< Last data write, without its 0x01 */
+    static uint16_t writtenLength;                  /**< Bytes in written */
+    static void (*onCommand)(const uint8_t* frame, uint16_t length); /**< Called after each data write, cleared by install() */
+
+private:
+    static void onDigitalWrite(uint8_t pin, uint8_t value);
+    static uint8_t onSpiByte(uint8_t mosi);
+    static bool isReady();
+    static void loadReadFrame();
+
+    static uint8_t cs;
+    static bool selected;
+    static int16_t op;
+    static uint8_t phase; /* 0 idle, 1 ACK pending, 2 response pending */
+    static int32_t countdown;
+    static uint8_t responseCode;
+    static uint8_t response[PN532_MOCK_BUFFER_SIZE];
+    static uint16_t responseLength;
+    static uint8_t out[PN532_MOCK_BUFFER_SIZE];
+    static uint16_t outLength;
+    static uint16_t outPosition;
+};
+
+#endif // PN532_SPI_MOCK_H
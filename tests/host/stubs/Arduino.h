@@ -0,0 +1,187 @@
+/**
+ * @file Arduino.h
+ * @brief Minimal Arduino core for host builds of the SDK and its libraries.
+ *
+ * Provides the subset of the Arduino API used by the SDK, Adafruit_PN532,
+ * Adafruit_BusIO, AESLib, Crypto and micro-ecc, so they build and run on
+ * Linux. Time is virtual: delay() and delayMicroseconds() advance the clock
+ * instead of sleeping, so timeouts and card latencies cost no real time,
+ * while millis() and micros() still include the CPU time actually spent.
+ *
+ * Tests observe and drive the "hardware" through the host_* hooks declared
+ * here and in SPI.h and Wire.h.
+ */
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef enum { LSBFIRST = 0, MSBFIRST = 1 } BitOrder;
+
+#define ARDUINO 10819
+#define F_CPU 16000000UL
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define FALLING 2
+#define RISING 3
+#define CHANGE 4
+#define NOT_AN_INTERRUPT -1
+
+#define HEX 16
+#define DEC 10
+#define BIN 2
+#define OCT 8
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+#define PROGMEM
+#define IRAM_ATTR
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+void noInterrupts();
+void interrupts();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+int digitalPinToInterrupt(int pin);
+void attachInterrupt(int interrupt, void (*handler)(void), int mode);
+void detachInterrupt(int interrupt);
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+#define HOST_PIN_TRACE_SIZE (2048U) /**< Pin accesses kept in host_pinTrace */
+
+/** One digitalWrite() or digitalRead(), as recorded in host_pinTrace. */
+struct HostPinEvent {
+    uint8_t pin;   /**< Arduino pin number */
+    uint8_t value; /**< Level written, or level read */
+    bool read;     /**< true for digitalRead(), false for digitalWrite() */
+};
+
+/** @name Host hooks */
+///@{
+extern HostPinEvent host_pinTrace[HOST_PIN_TRACE_SIZE]; /**< Pin accesses, oldest first */
+extern size_t host_pinTraceLength;                      /**< Entries in host_pinTrace */
+/** Called on every digitalWrite(), e.g. to model a chip select. */
+extern void (*host_onDigitalWrite)(uint8_t pin, uint8_t value);
+/** Answers digitalRead(); when NULL every pin reads HIGH (idle, pulled up). */
+extern int (*host_onDigitalRead)(uint8_t pin);
+/** Last handler given to attachInterrupt(), NULL after detachInterrupt(). */
+extern void (*host_irqHandler)(void);
+/** Virtual time added by delay() and delayMicroseconds(), in microseconds. */
+extern unsigned long long host_skewMicros;
+///@}
+
+class String : public std::string {
+public:
+    String(const char* s = "") : std::string(s) {}
+};
+
+class Print {
+public:
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t n = 0U;
+        while (size-- > 0U) {
+            n += write(*buffer++);
+        }
+        return n;
+    }
+    size_t write(const char* s) { return write(reinterpret_cast<const uint8_t*>(s), strlen(s)); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+    virtual ~Print() {}
+
+    size_t print(const __FlashStringHelper* s) { return print(reinterpret_cast<const char*>(s)); }
+    size_t print(const char* s) { return write(s); }
+    size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+    size_t print(unsigned char v, int base = DEC) { return print(static_cast<unsigned long>(v), base); }
+    size_t print(int v, int base = DEC) { return print(static_cast<long>(v), base); }
+    size_t print(unsigned int v, int base = DEC) { return print(static_cast<unsigned long>(v), base); }
+    size_t print(long v, int base = DEC) {
+        if ((base == DEC) && (v < 0)) {
+            return print('-') + print(static_cast<unsigned long>(-v), base);
+        }
+        return print(static_cast<unsigned long>(v), base);
+    }
+    size_t print(unsigned long v, int base = DEC) {
+        char buf[8U * sizeof(long) + 1U];
+        char* p = &buf[sizeof(buf) - 1U];
+        *p = '\0';
+        if (base < 2) {
+            base = 10;
+        }
+        do {
+            unsigned long digit = v % static_cast<unsigned long>(base);
+            v /= static_cast<unsigned long>(base);
+            *--p = static_cast<char>((digit < 10U) ? ('0' + digit) : ('A' + digit - 10U));
+        } while (v != 0U);
+        return print(p);
+    }
+    size_t print(double v, int digits = 2) {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%.*f", digits, v);
+        return print(buf);
+    }
+
+    size_t println() { return print("\r\n"); }
+    template <typename T> size_t println(T v) { return print(v) + println(); }
+    template <typename T> size_t println(T v, int base) { return print(v, base) + println(); }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    size_t readBytes(uint8_t* buffer, size_t length) {
+        size_t n = 0U;
+        while ((n < length) && (available() > 0)) {
+            buffer[n++] = static_cast<uint8_t>(read());
+        }
+        return n;
+    }
+    void setTimeout(unsigned long) {}
+};
+
+/**
+ * @brief Serial port writing to stdout when HOST_SERIAL_ECHO is set in the
+ *        environment, and discarding its output otherwise.
+ */
+class HardwareSerial : public Stream {
+public:
+    virtual void begin(unsigned long, int = 0) {}
+    void end() {}
+    size_t write(uint8_t c) override;
+    using Print::write;
+    int availableForWrite() override { return 63; }
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+#endif // HOST_ARDUINO_H
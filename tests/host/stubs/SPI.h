@@ -0,0 +1,62 @@
+/**
+ * @file SPI.h
+ * @brief Host SPI bus: MOSI bytes are logged and MISO bytes come from a
+ *        device model installed by the test.
+ */
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include <Arduino.h>
+
+#define SPI_MODE0 0
+#define SPI_MODE1 1
+#define SPI_MODE2 2
+#define SPI_MODE3 3
+
+#define HOST_SPI_LOG_SIZE (1024U) /**< MOSI bytes kept in host_spiLog */
+
+/** @name Host hooks */
+///@{
+/** Device model: returns the MISO byte clocked with @p mosi. NULL reads 0xFF. */
+extern uint8_t (*host_spiOnByte)(uint8_t mosi);
+extern uint8_t host_spiLog[HOST_SPI_LOG_SIZE]; /**< MOSI bytes, oldest first */
+extern size_t host_spiLogLength;               /**< Bytes in host_spiLog */
+extern unsigned long host_spiByteCalls;        /**< transfer(uint8_t) calls */
+extern unsigned long host_spiBufferCalls;      /**< transfer(buffer, length) calls */
+///@}
+
+class SPISettings {
+public:
+    SPISettings(uint32_t = 0U, int = 0, uint8_t = 0U) {}
+};
+
+class SPIClass {
+public:
+    void begin() {}
+    void end() {}
+    void beginTransaction(SPISettings) {}
+    void endTransaction() {}
+    uint8_t transfer(uint8_t data) {
+        host_spiByteCalls++;
+        return clock(data);
+    }
+    void transfer(void* buffer, size_t length) {
+        uint8_t* bytes = static_cast<uint8_t*>(buffer);
+        host_spiBufferCalls++;
+        for (size_t i = 0U; i < length; i++) {
+            bytes[i] = clock(bytes[i]);
+        }
+    }
+
+private:
+    static uint8_t clock(uint8_t mosi) {
+        if (host_spiLogLength < HOST_SPI_LOG_SIZE) {
+            host_spiLog[host_spiLogLength++] = mosi;
+        }
+        return (host_spiOnByte != NULL) ? host_spiOnByte(mosi) : 0xFFU;
+    }
+};
+
+extern SPIClass SPI;
+
+#endif // HOST_SPI_H
@@ -0,0 +1,68 @@
+/**
+ * @file Wire.h
+ * @brief Host I2C bus: written bytes are logged and reads are served from a
+ *        script. Like a PN532, every requestFrom() restarts at the start of
+ *        the script.
+ */
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <Arduino.h>
+
+#define HOST_WIRE_BUFFER_SIZE (512U) /**< Size of host_wireLog and host_wireScript */
+
+/** @name Host hooks */
+///@{
+extern uint8_t host_wireLog[HOST_WIRE_BUFFER_SIZE];    /**< Written bytes, oldest first */
+extern size_t host_wireLogLength;                      /**< Bytes in host_wireLog */
+extern uint8_t host_wireScript[HOST_WIRE_BUFFER_SIZE]; /**< Bytes served by reads */
+extern size_t host_wireScriptLength;                   /**< Bytes in host_wireScript, 0 reads as 0x00 */
+extern size_t host_wireBytesRead;                      /**< Bytes read since the test last cleared it */
+extern unsigned long host_wireRequests;                /**< requestFrom() calls */
+extern uint32_t host_wireClock;                        /**< Last setClock() value */
+/** Called at the start of every requestFrom(), e.g. to switch scripts. */
+extern void (*host_onWireRequest)(void);
+///@}
+
+class TwoWire : public Stream {
+public:
+    void begin() {}
+    void end() {}
+    void setClock(uint32_t clock) { host_wireClock = clock; }
+    void beginTransmission(uint8_t) {}
+    uint8_t endTransmission(uint8_t = 1U) { return 0U; }
+    uint8_t requestFrom(uint8_t, uint8_t quantity, uint8_t = 1U) {
+        host_wireRequests++;
+        if (host_onWireRequest != NULL) {
+            host_onWireRequest();
+        }
+        position = 0U;
+        return quantity;
+    }
+    size_t write(uint8_t data) override {
+        if (host_wireLogLength < HOST_WIRE_BUFFER_SIZE) {
+            host_wireLog[host_wireLogLength++] = data;
+        }
+        return 1U;
+    }
+    size_t write(const uint8_t* data, size_t length) override {
+        for (size_t i = 0U; i < length; i++) {
+            (void)write(data[i]);
+        }
+        return length;
+    }
+    using Print::write;
+    int available() override { return 1; }
+    int read() override {
+        host_wireBytesRead++;
+        return (position < host_wireScriptLength) ? host_wireScript[position++] : 0;
+    }
+    int peek() override { return 0; }
+
+private:
+    size_t position = 0U;
+};
+
+extern TwoWire Wire;
+
+#endif // HOST_WIRE_H
@@ -0,0 +1,99 @@
+/**
+ * @file host_arduino.cpp
+ * @brief Definitions behind the host Arduino, SPI and Wire stubs.
+ */
+#include <Arduino.h>
+#include <SPI.h>
+#include <Wire.h>
+#include <chrono>
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+SPIClass SPI;
+TwoWire Wire;
+
+HostPinEvent host_pinTrace[HOST_PIN_TRACE_SIZE];
+size_t host_pinTraceLength = 0U;
+void (*host_onDigitalWrite)(uint8_t pin, uint8_t value) = NULL;
+int (*host_onDigitalRead)(uint8_t pin) = NULL;
+void (*host_irqHandler)(void) = NULL;
+unsigned long long host_skewMicros = 0U;
+
+uint8_t (*host_spiOnByte)(uint8_t mosi) = NULL;
+uint8_t host_spiLog[HOST_SPI_LOG_SIZE];
+size_t host_spiLogLength = 0U;
+unsigned long host_spiByteCalls = 0U;
+unsigned long host_spiBufferCalls = 0U;
+
+uint8_t host_wireLog[HOST_WIRE_BUFFER_SIZE];
+size_t host_wireLogLength = 0U;
+uint8_t host_wireScript[HOST_WIRE_BUFFER_SIZE];
+size_t host_wireScriptLength = 0U;
+size_t host_wireBytesRead = 0U;
+unsigned long host_wireRequests = 0U;
+uint32_t host_wireClock = 100000U;
+void (*host_onWireRequest)(void) = NULL;
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+static const bool serialEcho = (getenv("HOST_SERIAL_ECHO") != NULL);
+
+/* Time: real elapsed time plus the virtual time of every delay */
+
+static unsigned long long nowMicros() {
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - startTime;
+    return static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()) +
+           host_skewMicros;
+}
+
+unsigned long millis() { return static_cast<unsigned long>(nowMicros() / 1000U); }
+unsigned long micros() { return static_cast<unsigned long>(nowMicros()); }
+void delay(unsigned long ms) { host_skewMicros += 1000ULL * ms; }
+void delayMicroseconds(unsigned int us) { host_skewMicros += us; }
+void yield() {}
+void noInterrupts() {}
+void interrupts() {}
+
+/* Pins */
+
+void pinMode(uint8_t, uint8_t) {}
+
+static void tracePin(uint8_t pin, uint8_t value, bool read) {
+    if (host_pinTraceLength < HOST_PIN_TRACE_SIZE) {
+        host_pinTrace[host_pinTraceLength].pin = pin;
+        host_pinTrace[host_pinTraceLength].value = value;
+        host_pinTrace[host_pinTraceLength].read = read;
+        host_pinTraceLength++;
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    tracePin(pin, (value != LOW) ? HIGH : LOW, false);
+    if (host_onDigitalWrite != NULL) {
+        host_onDigitalWrite(pin, value);
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    int value = (host_onDigitalRead != NULL) ? host_onDigitalRead(pin) : HIGH;
+    tracePin(pin, (value != LOW) ? HIGH : LOW, true);
+    return value;
+}
+int analogRead(uint8_t) { return 42; }
+int digitalPinToInterrupt(int pin) { return pin; }
+void attachInterrupt(int, void (*handler)(void), int) { host_irqHandler = handler; }
+void detachInterrupt(int) { host_irqHandler = NULL; }
+
+/* Random numbers: deterministic unless randomSeed() is called */
+
+long random(long howbig) { return (howbig > 0) ? (rand() % howbig) : 0; }
+long random(long howsmall, long howbig) { return (howbig > howsmall) ? (howsmall + random(howbig - howsmall)) : howsmall; }
+void randomSeed(unsigned long seed) { srand(static_cast<unsigned int>(seed)); }
+
+/* Serial */
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (serialEcho) {
+        (void)fputc(c, stdout);
+    }
+    return 1U;
+}
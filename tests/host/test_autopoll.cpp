@@ -0,0 +1,158 @@
+/**
+ * @file test_autopoll.cpp
+ * @brief InAutoPoll detection, byte for byte on the SPI mock.
+ *
+ * PN532Adapter::setAutoPoll() must round the period up to 150 ms units and
+ * refuse out of range settings, and detection must then send InAutoPoll
+ * (D4 60 FF period types), or InListPassiveTarget once auto poll is turned
+ * off. Adafruit_PN532::readAutoPoll() must take the first target of the
+ * answer: its type, its Tg, and for type A targets the ATS TA(1) byte, read
+ * only within the target data and the frame.
+ */
+#include <Arduino.h>
+#include <SPI.h>
+#include <string.h>
+#include "ArduinoSerialAdapter.h"
+#include "host_test.h"
+#include "pn532_spi_mock.h"
+
+#define private public
+#include "PN532Adapter.h"
+#undef private
+
+#define TEST_CS_PIN  (10U)  /**< PN532 chip select */
+
+/* Type A target data: Tg SENS_RES SEL_RES NFCIDLength NFCID, ATS TL T0 TA TB TC */
+static const uint8_t test_typeA[] = {
+    0x01U, 0x00U, 0x04U, 0x20U, 0x04U, 0x11U, 0x22U, 0x33U, 0x44U,
+    0x05U, 0x78U, 0x33U, 0x80U, 0x02U
+};
+
+/**
+ * @brief Answer InAutoPoll with one target of @p type, whose data length byte is @p dataLength.
+ */
+static void answerTarget(uint8_t type, const uint8_t* data, uint8_t length, uint8_t dataLength) {
+    uint8_t answer[40];
+
+    answer[0] = 0x01U; /* NbTg */
+    answer[1] = type;
+    answer[2] = dataLength;
+    memcpy(&answer[3], data, length);
+    PN532SpiMock::setResponse(answer, (uint16_t)(3U + length));
+}
+
+/* Period in 150 ms units rounded up, types in order; out of range settings refused */
+static void testStartFrame(PN532Adapter& adapter) {
+    static const uint8_t types[] = { PN532_AUTOPOLL_ISO14443_4A, PN532_AUTOPOLL_MIFARE };
+    static const uint8_t expected[] = {
+        0x00U, 0x00U, 0xFFU, 0x06U, 0xFAU, 0xD4U, PN532_COMMAND_INAUTOPOLL,
+        PN532_AUTOPOLL_ENDLESS, 0x02U, PN532_AUTOPOLL_ISO14443_4A, PN532_AUTOPOLL_MIFARE,
+        (uint8_t)(0U - (0xD4U + PN532_COMMAND_INAUTOPOLL + PN532_AUTOPOLL_ENDLESS + 0x02U +
+                        PN532_AUTOPOLL_ISO14443_4A + PN532_AUTOPOLL_MIFARE)),
+        0x00U
+    };
+
+    CHECK(adapter.setAutoPoll(151U, types, sizeof(types)));
+    CHECK(adapter.startListPassiveTarget());
+    CHECK(PN532SpiMock::writtenLength == sizeof(expected));
+    CHECK(memcmp(PN532SpiMock::written, expected, sizeof(expected)) == 0);
+
+    /* 16 units, no types, too many types: refused, the setting is kept */
+    CHECK(adapter.setAutoPoll(2251U, types, sizeof(types)) == false);
+    CHECK(adapter.setAutoPoll(150U, types, 0U) == false);
+    CHECK(adapter.setAutoPoll(150U, types, PN532_AUTOPOLL_MAX_TYPES + 1U) == false);
+    CHECK(adapter.startListPassiveTarget());
+    CHECK(memcmp(PN532SpiMock::written, expected, sizeof(expected)) == 0);
+
+    /* Period 0: back to InListPassiveTarget */
+    CHECK(adapter.setAutoPoll(0U, NULL, 0U));
+    CHECK(adapter.startListPassiveTarget());
+    CHECK(PN532SpiMock::written[6] == PN532_COMMAND_INLISTPASSIVETARGET);
+
+    CHECK(adapter.setAutoPoll(2250U, types, sizeof(types)));
+    CHECK(adapter.startListPassiveTarget());
+    CHECK(PN532SpiMock::written[8] == 15U);
+}
+
+/* ISO14443-4 type A: Tg and TA(1) taken, and the adapter completes detection */
+static void testTypeA(PN532Adapter& adapter) {
+    uint8_t type = 0xFFU;
+
+    answerTarget(PN532_AUTOPOLL_ISO14443_4A, test_typeA, sizeof(test_typeA), sizeof(test_typeA));
+    CHECK(adapter.startListPassiveTarget());
+    CHECK(adapter.nfc->readAutoPoll(&type, 100U));
+    CHECK(type == PN532_AUTOPOLL_ISO14443_4A);
+    CHECK(adapter.nfc->_inListedTag == 0x01U);
+    CHECK(adapter.nfc->targetBitRates() == 0x33U);
+
+    CHECK(adapter.startListPassiveTarget());
+    CHECK(adapter.finishListPassiveTarget());
+    CHECK(adapter.nfc->targetBitRates() == 0x33U);
+}
+
+/* TA(1) is only read for type A targets, and only inside the target data */
+static void testNoBitRates(PN532Adapter& adapter) {
+    /* FeliCa: the same bytes mean something else */
+    answerTarget(PN532_AUTOPOLL_FELICA_212, test_typeA, sizeof(test_typeA), sizeof(test_typeA));
+    CHECK(adapter.startListPassiveTarget());
+    CHECK(adapter.finishListPassiveTarget());
+    CHECK(adapter.nfc->targetBitRates() == 0U);
+
+    /* Mifare with no ATS */
+    answerTarget(PN532_AUTOPOLL_MIFARE, test_typeA, 9U, 9U);
+    CHECK(adapter.startListPassiveTarget());
+    CHECK(adapter.finishListPassiveTarget());
+    CHECK(adapter.nfc->targetBitRates() == 0U);
+
+    /* The data length ends the target before TA(1), though the bytes follow */
+    answerTarget(PN532_AUTOPOLL_ISO14443_4A, test_typeA, sizeof(test_typeA), 11U);
+    CHECK(adapter.startListPassiveTarget());
+    CHECK(adapter.finishListPassiveTarget());
+    CHECK(adapter.nfc->targetBitRates() == 0U);
+
+    /* A data length past the frame is cut at the frame end */
+    answerTarget(PN532_AUTOPOLL_ISO14443_4A, test_typeA, 11U, 40U);
+    CHECK(adapter.startListPassiveTarget());
+    CHECK(adapter.finishListPassiveTarget());
+    CHECK(adapter.nfc->targetBitRates() == 0U);
+}
+
+/* Two targets: the first one is taken. No target: detection fails */
+static void testTargetCount(PN532Adapter& adapter) {
+    uint8_t answer[3U + sizeof(test_typeA) + 2U + 9U];
+    uint8_t type = 0xFFU;
+
+    answer[0] = 0x02U;
+    answer[1] = PN532_AUTOPOLL_ISO14443_4A;
+    answer[2] = sizeof(test_typeA);
+    memcpy(&answer[3], test_typeA, sizeof(test_typeA));
+    answer[3U + sizeof(test_typeA)] = PN532_AUTOPOLL_MIFARE;
+    answer[4U + sizeof(test_typeA)] = 9U;
+    memcpy(&answer[5U + sizeof(test_typeA)], test_typeA, 9U);
+    PN532SpiMock::setResponse(answer, sizeof(answer));
+    CHECK(adapter.startListPassiveTarget());
+    CHECK(adapter.nfc->readAutoPoll(&type, 100U));
+    CHECK((type == PN532_AUTOPOLL_ISO14443_4A) && (adapter.nfc->targetBitRates() == 0x33U));
+
+    static const uint8_t none[] = { 0x00U };
+    PN532SpiMock::setResponse(none, sizeof(none));
+    CHECK(adapter.startListPassiveTarget());
+    CHECK(adapter.finishListPassiveTarget() == false);
+}
+
+int main() {
+    static const uint8_t types[] = { PN532_AUTOPOLL_ISO14443_4A };
+    ArduinoSerialAdapter serial;
+    PN532Adapter adapter(serial, TEST_CS_PIN, &SPI);
+
+    PN532SpiMock::install(TEST_CS_PIN);
+    CHECK(adapter.nfc->begin());
+
+    testStartFrame(adapter);
+    CHECK(adapter.setAutoPoll(150U, types, sizeof(types)));
+    testTypeA(adapter);
+    testNoBitRates(adapter);
+    testTargetCount(adapter);
+
+    return host_testResult("test_autopoll");
+}
@@ -0,0 +1,172 @@
+/**
+ * @file test_bitrate.cpp
+ * @brief Bit rate negotiation after activation, byte for byte on the SPI mock.
+ *
+ * The mock answers InListPassiveTarget with a type A target whose ATS
+ * carries a given TA(1) byte, and answers each InPSL with success or an
+ * error status depending on the rate requested. Adafruit_PN532 must read
+ * TA(1) from the target data. PN532Adapter must then send InPSL with equal
+ * BRit and BRti, starting from the fastest rate the card supports both ways
+ * up to setMaxBitRate(), step down on refusal and stay at 106 kbps, still
+ * detected, when every rate is refused or none is announced.
+ */
+#include <Arduino.h>
+#include <SPI.h>
+#include <string.h>
+#include "ArduinoSerialAdapter.h"
+#include "host_test.h"
+#include "pn532_spi_mock.h"
+
+#define private public
+#include "PN532Adapter.h"
+#undef private
+
+#define TEST_CS_PIN     (10U)  /**< PN532 chip select */
+#define TEST_MAX_PSL    (4U)   /**< InPSL commands logged */
+#define TEST_TG         (0x01U) /**< Target number of the inlisted card */
+
+/** @brief What the mock answers, and the InPSL commands it received. */
+static struct {
+    uint8_t target[24];             /**< InListPassiveTarget data, from NbTg on */
+    uint8_t targetLength;           /**< Bytes in target */
+    uint8_t acceptedRates;          /**< Bit n set: InPSL to rate n succeeds */
+    uint8_t psl[TEST_MAX_PSL][3];   /**< Tg, BRit, BRti of each InPSL */
+    uint8_t pslCount;               /**< InPSL commands received */
+} test_card;
+
+static void onCommand(const uint8_t* frame, uint16_t length) {
+    const uint8_t code = frame[6];
+
+    if (code == PN532_COMMAND_INLISTPASSIVETARGET) {
+        PN532SpiMock::setResponse(test_card.target, test_card.targetLength);
+    } else if ((code == PN532_COMMAND_INPSL) && (length >= 10U)) {
+        uint8_t status = ((test_card.acceptedRates & (1U << frame[8])) != 0U) ? 0x00U : 0x01U;
+        if (test_card.pslCount < TEST_MAX_PSL) {
+            memcpy(test_card.psl[test_card.pslCount], &frame[7], 3U);
+        }
+        test_card.pslCount++;
+        PN532SpiMock::setResponse(&status, 1U);
+    } else {
+        PN532SpiMock::setResponse(NULL, 0U);
+    }
+}
+
+/**
+ * @brief Script an ISO14443-4 type A target with @p ta as TA(1), or no TA(1) if @p withTa is false.
+ */
+static void setCard(bool withTa, uint8_t ta, uint8_t acceptedRates) {
+    /* NbTg Tg SENS_RES SEL_RES NFCIDLength NFCID, then ATS: TL T0 [TA] TB TC */
+    const uint8_t head[] = { 0x01U, TEST_TG, 0x00U, 0x04U, 0x20U, 0x04U, 0x11U, 0x22U, 0x33U, 0x44U };
+    uint8_t n = sizeof(head);
+
+    memset(&test_card, 0, sizeof(test_card));
+    memcpy(test_card.target, head, sizeof(head));
+    if (withTa) {
+        test_card.target[n++] = 0x05U;
+        test_card.target[n++] = 0x78U; /* TA, TB, TC present, FSCI 8 */
+        test_card.target[n++] = ta;
+    } else {
+        test_card.target[n++] = 0x04U;
+        test_card.target[n++] = 0x68U; /* TB, TC present */
+    }
+    test_card.target[n++] = 0x80U;
+    test_card.target[n++] = 0x02U;
+    test_card.targetLength = n;
+    test_card.acceptedRates = acceptedRates;
+}
+
+/** @brief Detect the scripted card with @p maxRate as the rate limit. */
+static bool detect(PN532Adapter& adapter, PN532BitRate maxRate) {
+    adapter.setMaxBitRate(maxRate);
+    return adapter.inListPassiveTarget();
+}
+
+static bool pslIs(uint8_t index, uint8_t rate) {
+    return (test_card.psl[index][0] == TEST_TG) && (test_card.psl[index][1] == rate) &&
+           (test_card.psl[index][2] == rate);
+}
+
+/* TA(1) read from the target data: 848 kbps both ways, accepted at once */
+static void testFastest(PN532Adapter& adapter) {
+    setCard(true, 0x77U, 0x0FU);
+    CHECK(detect(adapter, PN532BitRate::KBPS_848));
+    CHECK(adapter.nfc->targetBitRates() == 0x77U);
+    CHECK(test_card.pslCount == 1U);
+    CHECK(pslIs(0U, PN532_BITRATE_848));
+    CHECK(adapter.bitRate() == PN532BitRate::KBPS_848);
+
+    /* setMaxBitRate() caps the rate requested */
+    setCard(true, 0x77U, 0x0FU);
+    CHECK(detect(adapter, PN532BitRate::KBPS_212));
+    CHECK((test_card.pslCount == 1U) && pslIs(0U, PN532_BITRATE_212));
+    CHECK(adapter.bitRate() == PN532BitRate::KBPS_212);
+}
+
+/* 424 kbps refused: the next lower rate announced is tried */
+static void testStepDown(PN532Adapter& adapter) {
+    setCard(true, 0x33U, 0x03U);
+    CHECK(detect(adapter, PN532BitRate::KBPS_848));
+    CHECK(test_card.pslCount == 2U);
+    CHECK(pslIs(0U, PN532_BITRATE_424) && pslIs(1U, PN532_BITRATE_212));
+    CHECK(adapter.bitRate() == PN532BitRate::KBPS_212);
+}
+
+/* Only symmetric rates: 424 kbps to the card but not back is skipped */
+static void testAsymmetric(PN532Adapter& adapter) {
+    setCard(true, 0x13U, 0x0FU);
+    CHECK(detect(adapter, PN532BitRate::KBPS_848));
+    CHECK((test_card.pslCount == 1U) && pslIs(0U, PN532_BITRATE_212));
+    CHECK(adapter.bitRate() == PN532BitRate::KBPS_212);
+}
+
+/* Every rate refused, no TA(1), or no negotiation asked: 106 kbps, card still detected */
+static void testFallback(PN532Adapter& adapter) {
+    setCard(true, 0x77U, 0x01U);
+    CHECK(detect(adapter, PN532BitRate::KBPS_848));
+    CHECK(test_card.pslCount == 3U);
+    CHECK(pslIs(0U, PN532_BITRATE_848) && pslIs(1U, PN532_BITRATE_424) && pslIs(2U, PN532_BITRATE_212));
+    CHECK(adapter.bitRate() == PN532BitRate::KBPS_106);
+
+    setCard(false, 0x00U, 0x0FU);
+    CHECK(detect(adapter, PN532BitRate::KBPS_848));
+    CHECK(adapter.nfc->targetBitRates() == 0U);
+    CHECK(test_card.pslCount == 0U);
+    CHECK(adapter.bitRate() == PN532BitRate::KBPS_106);
+
+    setCard(true, 0x77U, 0x0FU);
+    CHECK(detect(adapter, PN532BitRate::KBPS_106));
+    CHECK(test_card.pslCount == 0U);
+    CHECK(adapter.bitRate() == PN532BitRate::KBPS_106);
+}
+
+/* InPSL frame: D4 4E Tg BRit BRti, and the status byte decides */
+static void testInPslFrame(PN532Adapter& adapter) {
+    static const uint8_t expected[] = {
+        0x00U, 0x00U, 0xFFU, 0x05U, 0xFBU, 0xD4U, PN532_COMMAND_INPSL, TEST_TG, 0x02U, 0x01U,
+        (uint8_t)(0U - (0xD4U + PN532_COMMAND_INPSL + TEST_TG + 0x02U + 0x01U)), 0x00U
+    };
+
+    setCard(true, 0x77U, 0x04U);
+    CHECK(detect(adapter, PN532BitRate::KBPS_106));
+    CHECK(adapter.nfc->inPSL(PN532_BITRATE_424, PN532_BITRATE_212));
+    CHECK(PN532SpiMock::writtenLength == sizeof(expected));
+    CHECK(memcmp(PN532SpiMock::written, expected, sizeof(expected)) == 0);
+    CHECK(adapter.nfc->inPSL(PN532_BITRATE_212, PN532_BITRATE_212) == false);
+}
+
+int main() {
+    ArduinoSerialAdapter serial;
+    PN532Adapter adapter(serial, TEST_CS_PIN, &SPI);
+
+    PN532SpiMock::install(TEST_CS_PIN);
+    PN532SpiMock::onCommand = onCommand;
+    CHECK(adapter.nfc->begin());
+
+    testFastest(adapter);
+    testStepDown(adapter);
+    testAsymmetric(adapter);
+    testFallback(adapter);
+    testInPslFrame(adapter);
+
+    return host_testResult("test_bitrate");
+}
@@ -0,0 +1,300 @@
+/**
+ * @file test_chaining.cpp
+ * @brief NFCDriver command chaining and extended APDUs, part by part.
+ *
+ * A fake driver logs every APDU or part handed to it and answers from a
+ * script of status words. sendChainedAPDU() must set CLA bit 0x10 on every
+ * APDU but the last, carry Lc and the data in order and add Le = 00 to the
+ * last one only, and stop at the first intermediate answer other than
+ * 90 00. sendExtendedAPDU() must encode Lc1 Lc2 after the 00 marker, split
+ * the APDU at the frame capacity with more set on all parts but the last,
+ * and send Le = 00 00 in a part of its own when the data fills the frame.
+ * The default sendAPDUFramePart() must refuse a part with more set.
+ *
+ * PN532Adapter::sendAPDUFramePart() is checked against the PN532 SPI mock:
+ * the InDataExchange target byte carries the MI bit on every part but the
+ * last.
+ */
+#include <Arduino.h>
+#include <SPI.h>
+#include <string.h>
+#include "ArduinoSerialAdapter.h"
+#include "NFCDriver.h"
+#include "host_test.h"
+#include "pn532_spi_mock.h"
+
+#define private public
+#include "PN532Adapter.h"
+#undef private
+
+#define TEST_CAPACITY   (64U)   /**< APDU capacity of the frames used */
+#define TEST_MAX_CALLS  (16U)   /**< APDUs or parts logged */
+#define TEST_MAX_APDU   (80U)   /**< Bytes logged per APDU or part */
+#define TEST_CS_PIN     (10U)   /**< PN532 chip select */
+
+static const uint8_t test_header[NFC_APDU_HEADER_SIZE] = { 0x80U, 0xD4U, 0x01U, 0x02U }; /**< CLA INS P1 P2 */
+
+/**
+ * @brief NFCDriver that logs what it is given and answers from a script.
+ *
+ * With logParts set, sendAPDUFramePart() is overridden and logs the parts;
+ * otherwise the default one runs and the APDUs reach sendAPDU().
+ */
+class ChainLogDriver : public NFCDriver {
+public:
+    bool begin() override { return true; }
+    bool inListPassiveTarget() override { return true; }
+    bool readUID(uint8_t*, uint8_t& uidLength) override { uidLength = 0U; return false; }
+    void resetReader() override {}
+    bool printFirmwareVersion() override { return true; }
+
+    bool sendAPDU(const uint8_t* apdu, uint16_t apduLen,
+                  uint8_t* response, uint16_t& responseLen) override {
+        return log(apdu, apduLen, false, response, responseLen);
+    }
+    bool sendAPDUFramePart(uint8_t* part, uint16_t partLen, bool more,
+                           uint8_t* response, uint16_t& responseLen) override {
+        bool ret = false;
+        if (logParts) {
+            ret = log(part, partLen, more, response, responseLen);
+        }
+        else {
+            ret = NFCDriver::sendAPDUFramePart(part, partLen, more, response, responseLen);
+        }
+        return ret;
+    }
+
+    /** @brief Clear the log; every call is answered 90 00 unless set otherwise. */
+    void reset(bool parts) {
+        logParts = parts;
+        calls = 0U;
+        for (uint8_t i = 0U; i < TEST_MAX_CALLS; i++) {
+            sw[i][0] = 0x90U;
+            sw[i][1] = 0x00U;
+        }
+    }
+
+    bool logParts = false;                 /**< Log parts instead of running the default */
+    uint8_t apdus[TEST_MAX_CALLS][TEST_MAX_APDU]; /**< Bytes of each call */
+    uint16_t lengths[TEST_MAX_CALLS];      /**< Length of each call */
+    bool mores[TEST_MAX_CALLS];            /**< more flag of each call */
+    uint8_t calls = 0U;                    /**< Calls logged */
+    uint8_t sw[TEST_MAX_CALLS][2];         /**< Status word answered to each call */
+
+private:
+    bool log(const uint8_t* apdu, uint16_t apduLen, bool more,
+             uint8_t* response, uint16_t& responseLen) {
+        bool ret = false;
+        if ((calls < TEST_MAX_CALLS) && (apduLen <= TEST_MAX_APDU) && (responseLen >= 2U)) {
+            memcpy(apdus[calls], apdu, apduLen);
+            lengths[calls] = apduLen;
+            mores[calls] = more;
+            response[0] = sw[calls][0];
+            response[1] = sw[calls][1];
+            responseLen = 2U;
+            calls++;
+            ret = true;
+        }
+        return ret;
+    }
+};
+
+static void fillData(uint8_t* data, uint16_t length) {
+    for (uint16_t i = 0U; i < length; i++) {
+        data[i] = (uint8_t)((i * 13U) + 1U);
+    }
+}
+
+/* 300 bytes in 58-byte chunks: five chained APDUs and a last one of 10 bytes with Le */
+static void testChained(ChainLogDriver& driver) {
+    const uint16_t chunkMax = TEST_CAPACITY - NFC_APDU_HEADER_SIZE - 2U;
+    NFCApduFrame<TEST_CAPACITY> frame;
+    uint8_t data[300];
+    uint8_t response[8];
+    uint16_t responseLen = sizeof(response);
+
+    fillData(data, sizeof(data));
+    driver.reset(false);
+    driver.sw[5][0] = 0x61U; /* the last answer is returned as is */
+    driver.sw[5][1] = 0x10U;
+    CHECK(driver.sendChainedAPDU(frame, test_header, data, sizeof(data), response, responseLen));
+    CHECK(driver.calls == 6U);
+    CHECK((responseLen == 2U) && (response[0] == 0x61U) && (response[1] == 0x10U));
+
+    uint16_t offset = 0U;
+    for (uint8_t i = 0U; i < driver.calls; i++) {
+        const uint8_t* apdu = driver.apdus[i];
+        bool last = (i == (driver.calls - 1U));
+        uint16_t chunk = last ? (uint16_t)(sizeof(data) - offset) : chunkMax;
+
+        CHECK(apdu[0] == (last ? test_header[0] : (uint8_t)(test_header[0] | NFC_CLA_CHAINING)));
+        CHECK(memcmp(&apdu[1], &test_header[1], NFC_APDU_HEADER_SIZE - 1U) == 0);
+        CHECK(apdu[NFC_APDU_HEADER_SIZE] == chunk);
+        CHECK(memcmp(&apdu[NFC_APDU_HEADER_SIZE + 1U], &data[offset], chunk) == 0);
+        /* Le = 00 on the last APDU only */
+        CHECK(driver.lengths[i] == (NFC_APDU_HEADER_SIZE + 1U + chunk + (last ? 1U : 0U)));
+        if (last) {
+            CHECK(apdu[driver.lengths[i] - 1U] == 0x00U);
+        }
+        offset = (uint16_t)(offset + chunk);
+    }
+    CHECK(offset == sizeof(data));
+
+    /* No data: one APDU, CLA INS P1 P2 Le */
+    driver.reset(false);
+    responseLen = sizeof(response);
+    CHECK(driver.sendChainedAPDU(frame, test_header, nullptr, 0U, response, responseLen));
+    CHECK((driver.calls == 1U) && (driver.lengths[0] == (NFC_APDU_HEADER_SIZE + 1U)));
+    CHECK((driver.apdus[0][0] == test_header[0]) && (driver.apdus[0][NFC_APDU_HEADER_SIZE] == 0x00U));
+}
+
+/* An intermediate answer other than 90 00 ends the chain there */
+static void testChainAbort(ChainLogDriver& driver) {
+    NFCApduFrame<TEST_CAPACITY> frame;
+    uint8_t data[300];
+    uint8_t response[8];
+    uint16_t responseLen = sizeof(response);
+
+    fillData(data, sizeof(data));
+    driver.reset(false);
+    driver.sw[2][0] = 0x6AU;
+    driver.sw[2][1] = 0x80U;
+    CHECK(driver.sendChainedAPDU(frame, test_header, data, sizeof(data), response, responseLen) == false);
+    CHECK(driver.calls == 3U);
+
+    /* 90 01 is not 90 00 either */
+    driver.reset(false);
+    driver.sw[0][1] = 0x01U;
+    responseLen = sizeof(response);
+    CHECK(driver.sendChainedAPDU(frame, test_header, data, sizeof(data), response, responseLen) == false);
+    CHECK(driver.calls == 1U);
+}
+
+/* 300 bytes: 00 01 2C after the header, then parts of 64 bytes, Le 00 00 at the end */
+static void testExtended(ChainLogDriver& driver) {
+    NFCApduFrame<TEST_CAPACITY> frame;
+    uint8_t data[300];
+    uint8_t apdu[NFC_APDU_HEADER_SIZE + 3U + sizeof(data) + 2U];
+    uint8_t joined[sizeof(apdu)];
+    uint8_t response[8];
+    uint16_t responseLen = sizeof(response);
+    uint16_t joinedLen = 0U;
+
+    fillData(data, sizeof(data));
+    memcpy(apdu, test_header, NFC_APDU_HEADER_SIZE);
+    apdu[4] = 0x00U;
+    apdu[5] = 0x01U;
+    apdu[6] = 0x2CU;
+    memcpy(&apdu[7], data, sizeof(data));
+    apdu[sizeof(apdu) - 2U] = 0x00U;
+    apdu[sizeof(apdu) - 1U] = 0x00U;
+
+    driver.reset(true);
+    CHECK(driver.sendExtendedAPDU(frame, test_header, data, sizeof(data), response, responseLen));
+    /* 309 bytes: four full parts and one of 53 */
+    CHECK(driver.calls == 5U);
+    for (uint8_t i = 0U; i < driver.calls; i++) {
+        bool last = (i == (driver.calls - 1U));
+
+        CHECK(driver.mores[i] == (last == false));
+        CHECK(driver.lengths[i] == (last ? (sizeof(apdu) - (4U * TEST_CAPACITY)) : TEST_CAPACITY));
+        if ((joinedLen + driver.lengths[i]) <= sizeof(joined)) {
+            memcpy(&joined[joinedLen], driver.apdus[i], driver.lengths[i]);
+        }
+        joinedLen = (uint16_t)(joinedLen + driver.lengths[i]);
+    }
+    CHECK(joinedLen == sizeof(apdu));
+    CHECK(memcmp(joined, apdu, sizeof(apdu)) == 0);
+}
+
+/* Data up to the end of the frame: Le alone in a last part; 2 bytes less: Le fits */
+static void testExtendedLeSplit(ChainLogDriver& driver) {
+    const uint16_t fill = TEST_CAPACITY - NFC_APDU_HEADER_SIZE - 3U;
+    NFCApduFrame<TEST_CAPACITY> frame;
+    uint8_t data[TEST_CAPACITY];
+    uint8_t response[8];
+    uint16_t responseLen = sizeof(response);
+
+    fillData(data, sizeof(data));
+    driver.reset(true);
+    CHECK(driver.sendExtendedAPDU(frame, test_header, data, fill, response, responseLen));
+    CHECK(driver.calls == 2U);
+    CHECK((driver.lengths[0] == TEST_CAPACITY) && driver.mores[0]);
+    CHECK((driver.apdus[0][5] == 0x00U) && (driver.apdus[0][6] == fill));
+    CHECK(memcmp(&driver.apdus[0][7], data, fill) == 0);
+    CHECK((driver.lengths[1] == 2U) && (driver.mores[1] == false));
+    CHECK((driver.apdus[1][0] == 0x00U) && (driver.apdus[1][1] == 0x00U));
+
+    driver.reset(true);
+    responseLen = sizeof(response);
+    CHECK(driver.sendExtendedAPDU(frame, test_header, data, (uint16_t)(fill - 2U), response, responseLen));
+    CHECK((driver.calls == 1U) && (driver.lengths[0] == TEST_CAPACITY) && (driver.mores[0] == false));
+    CHECK((driver.apdus[0][TEST_CAPACITY - 2U] == 0x00U) && (driver.apdus[0][TEST_CAPACITY - 1U] == 0x00U));
+}
+
+/* Default sendAPDUFramePart(): one part goes to sendAPDU(), a part with more is refused */
+static void testDefaultPart(ChainLogDriver& driver) {
+    NFCApduFrame<TEST_CAPACITY> frame;
+    uint8_t data[100];
+    uint8_t response[8];
+    uint16_t responseLen = sizeof(response);
+
+    fillData(data, sizeof(data));
+    driver.reset(false);
+    CHECK(driver.sendExtendedAPDU(frame, test_header, data, 20U, response, responseLen));
+    CHECK((driver.calls == 1U) && (driver.lengths[0] == (NFC_APDU_HEADER_SIZE + 3U + 20U + 2U)));
+
+    driver.reset(false);
+    responseLen = sizeof(response);
+    CHECK(driver.sendExtendedAPDU(frame, test_header, data, sizeof(data), response, responseLen) == false);
+    CHECK(driver.calls == 0U);
+
+    uint8_t part[4] = { 0x01U, 0x02U, 0x03U, 0x04U };
+    responseLen = sizeof(response);
+    CHECK(driver.NFCDriver::sendAPDUFramePart(part, sizeof(part), true, response, responseLen) == false);
+    CHECK(driver.calls == 0U);
+}
+
+/* PN532Adapter: InDataExchange with Tg | MI (0x40) on the first part, plain Tg on the last */
+static void testAdapterParts() {
+    static const uint8_t inListed[] = { 0x01U, 0x01U };
+    static const uint8_t partAck[] = { 0x00U };
+    static const uint8_t answer[] = { 0x00U, 0x90U, 0x00U };
+    ArduinoSerialAdapter serial;
+    PN532Adapter adapter(serial, TEST_CS_PIN, &SPI);
+    NFCApduFrame<TEST_CAPACITY> frame;
+    uint8_t* part = frame.apdu();
+    uint8_t response[8];
+    uint16_t responseLen = sizeof(response);
+
+    PN532SpiMock::install(TEST_CS_PIN);
+    CHECK(adapter.nfc->begin());
+    PN532SpiMock::setResponse(inListed, sizeof(inListed));
+    CHECK(adapter.nfc->inListPassiveTarget());
+
+    fillData(part, TEST_CAPACITY);
+    PN532SpiMock::setResponse(partAck, sizeof(partAck));
+    CHECK(adapter.sendAPDUFramePart(part, TEST_CAPACITY, true, response, responseLen));
+    /* 00 00 FF LEN LCS D4 40 Tg: the target byte follows the command code */
+    CHECK(PN532SpiMock::writtenLength == (TEST_CAPACITY + 10U));
+    CHECK((PN532SpiMock::written[6] == PN532_COMMAND_INDATAEXCHANGE) && (PN532SpiMock::written[7] == 0x41U));
+    CHECK(memcmp(&PN532SpiMock::written[8], part, TEST_CAPACITY) == 0);
+
+    PN532SpiMock::setResponse(answer, sizeof(answer));
+    CHECK(adapter.sendAPDUFramePart(part, 2U, false, response, responseLen));
+    CHECK(PN532SpiMock::written[7] == 0x01U);
+    CHECK((responseLen == 2U) && (response[0] == 0x90U) && (response[1] == 0x00U));
+}
+
+int main() {
+    ChainLogDriver driver;
+
+    testChained(driver);
+    testChainAbort(driver);
+    testExtended(driver);
+    testExtendedLeSplit(driver);
+    testDefaultPart(driver);
+    testAdapterParts();
+
+    return host_testResult("test_chaining");
+}
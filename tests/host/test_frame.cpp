@@ -0,0 +1,344 @@
+/**
+ * @file test_frame.cpp
+ * @brief Byte-for-byte PN532 frames, and the caller memory the frame code writes.
+ *
+ * writeframe() builds the frame header in the PN532_FRAME_HEADROOM bytes before
+ * a command (cmd[-7..-1]) and DCS and postamble in the PN532_FRAME_TAILROOM
+ * bytes after it (cmd[cmdlen..cmdlen+1]); on I2C, readdata() and readframe()
+ * put the RDY byte in buff[-1]. Each buffer here is surrounded by canary bytes
+ * placed with those macros, so a change to the room the driver uses that is
+ * not matched by the macros, or the reverse, fails the test.
+ *
+ * abortCommand() must send the ACK frame, on SPI after the data write byte,
+ * only while a command is pending, and leave the PN532 ready for the next one.
+ *
+ * writeframe(), readdata() and readframe() are private: this file opens the
+ * class to call them on its own buffers.
+ */
+#include <Arduino.h>
+#include <SPI.h>
+#include <Wire.h>
+#include <string.h>
+#include "host_test.h"
+#include "pn532_spi_mock.h"
+
+#define private public
+#include "Adafruit_PN532.h"
+#undef private
+
+#define TEST_CS_PIN     (10U)   /**< PN532 chip select on SPI */
+#define TEST_RESET_PIN  (3U)    /**< PN532 reset on I2C */
+#define TEST_CANARY     (0xA5U) /**< Value of the bytes nothing may write */
+#define TEST_GUARD      (8U)    /**< Canary bytes on each side of a buffer */
+#define TEST_SPI_APDU   (40U)   /**< APDU sent over SPI */
+#define TEST_I2C_APDU   (20U)   /**< APDU sent over I2C: the frame fits a 32-byte Wire buffer */
+#define TEST_FRAME_MAX  (300U)  /**< Largest frame built by the test */
+
+/**
+ * @brief Buffer with canaries on both sides of a room of @p Size bytes.
+ */
+template <size_t Size>
+struct GuardedBuffer {
+    uint8_t bytes[TEST_GUARD + Size + TEST_GUARD];
+
+    GuardedBuffer() { memset(bytes, TEST_CANARY, sizeof(bytes)); }
+    uint8_t* room() { return bytes + TEST_GUARD; }
+    bool intact() const {
+        bool ret = true;
+        for (size_t i = 0U; i < TEST_GUARD; i++) {
+            if ((bytes[i] != TEST_CANARY) || (bytes[TEST_GUARD + Size + i] != TEST_CANARY)) {
+                ret = false;
+            }
+        }
+        return ret;
+    }
+};
+
+/**
+ * @brief Build a host-to-PN532 frame: 00 00 FF LEN LCS D4 cmd DCS 00.
+ *
+ * @return Frame length.
+ */
+static uint16_t buildFrame(uint8_t* frame, const uint8_t* cmd, uint8_t cmdlen) {
+    uint8_t len = (uint8_t)(cmdlen + 1U);
+    uint8_t sum = PN532_HOSTTOPN532;
+    uint16_t n = 0U;
+
+    frame[n++] = PN532_PREAMBLE;
+    frame[n++] = PN532_STARTCODE1;
+    frame[n++] = PN532_STARTCODE2;
+    frame[n++] = len;
+    frame[n++] = (uint8_t)(~len + 1U);
+    frame[n++] = PN532_HOSTTOPN532;
+    for (uint8_t i = 0U; i < cmdlen; i++) {
+        frame[n++] = cmd[i];
+        sum = (uint8_t)(sum + cmd[i]);
+    }
+    frame[n++] = (uint8_t)(~sum + 1U);
+    frame[n++] = PN532_POSTAMBLE;
+
+    return n;
+}
+
+/**
+ * @brief Build a PN532-to-host frame answering @p code with @p data.
+ *
+ * @return Frame length.
+ */
+static uint16_t buildResponse(uint8_t* frame, uint8_t code, const uint8_t* data, uint8_t length) {
+    uint8_t len = (uint8_t)(length + 2U);
+    uint8_t sum = (uint8_t)(PN532_PN532TOHOST + code + 1U);
+    uint16_t n = 0U;
+
+    frame[n++] = PN532_PREAMBLE;
+    frame[n++] = PN532_STARTCODE1;
+    frame[n++] = PN532_STARTCODE2;
+    frame[n++] = len;
+    frame[n++] = (uint8_t)(~len + 1U);
+    frame[n++] = PN532_PN532TOHOST;
+    frame[n++] = (uint8_t)(code + 1U);
+    for (uint8_t i = 0U; i < length; i++) {
+        frame[n++] = data[i];
+        sum = (uint8_t)(sum + data[i]);
+    }
+    frame[n++] = (uint8_t)(~sum + 1U);
+    frame[n++] = PN532_POSTAMBLE;
+
+    return n;
+}
+
+/**
+ * @brief Command frame of an InDataExchange to target 1.
+ *
+ * @return Frame length.
+ */
+static uint16_t buildDataExchange(uint8_t* frame, const uint8_t* apdu, uint8_t length) {
+    uint8_t cmd[2U + TEST_SPI_APDU];
+
+    cmd[0] = PN532_COMMAND_INDATAEXCHANGE;
+    cmd[1] = 0x01U;
+    memcpy(&cmd[2], apdu, length);
+
+    return buildFrame(frame, cmd, (uint8_t)(length + 2U));
+}
+
+/** @name I2C script of one command: RDY and ACK, then RDY and response */
+///@{
+static uint8_t test_i2cResponse[1U + TEST_FRAME_MAX];
+static uint16_t test_i2cResponseLength = 0U;
+
+/* Requests 1 and 2 poll RDY and read the ACK, later ones poll RDY and read the response */
+static void serveI2cCommand() {
+    static const uint8_t ack[] = { PN532_I2C_READY, 0x00U, 0x00U, 0xFFU, 0x00U, 0xFFU, 0x00U };
+
+    if (host_wireRequests <= 2UL) {
+        memcpy(host_wireScript, ack, sizeof(ack));
+        host_wireScriptLength = sizeof(ack);
+    } else {
+        memcpy(host_wireScript, test_i2cResponse, test_i2cResponseLength);
+        host_wireScriptLength = test_i2cResponseLength;
+    }
+}
+
+static void scriptI2cCommand(uint8_t code, const uint8_t* data, uint8_t length) {
+    test_i2cResponse[0] = PN532_I2C_READY;
+    test_i2cResponseLength = (uint16_t)(1U + buildResponse(&test_i2cResponse[1], code, data, length));
+    host_wireRequests = 0UL;
+    host_wireLogLength = 0U;
+    host_onWireRequest = serveI2cCommand;
+}
+///@}
+
+static void fillApdu(uint8_t* apdu, uint8_t length) {
+    for (uint8_t i = 0U; i < length; i++) {
+        apdu[i] = (uint8_t)((i * 7U) + 3U);
+    }
+}
+
+/* SPI: SAMConfig from the packet buffer, InDataExchange in place and copied */
+static void testSpiFrames() {
+    static const uint8_t inListed[] = { 0x01U, 0x01U };
+    static const uint8_t answer[] = { 0x00U, 0x90U, 0x00U };
+    static const uint8_t sam[] = { PN532_COMMAND_SAMCONFIGURATION, 0x01U, 0x14U, 0x01U };
+    uint8_t apdu[TEST_SPI_APDU];
+    uint8_t expected[TEST_FRAME_MAX];
+    uint16_t expectedLength;
+
+    PN532SpiMock::install(TEST_CS_PIN);
+    Adafruit_PN532 nfc(TEST_CS_PIN, &SPI);
+    CHECK(nfc.begin());
+
+    CHECK(nfc.SAMConfig());
+    expectedLength = buildFrame(expected, sam, sizeof(sam));
+    CHECK(PN532SpiMock::writtenLength == expectedLength);
+    CHECK(memcmp(PN532SpiMock::written, expected, expectedLength) == 0);
+
+    PN532SpiMock::setResponse(inListed, sizeof(inListed));
+    CHECK(nfc.inListPassiveTarget());
+    PN532SpiMock::setResponse(answer, sizeof(answer));
+    fillApdu(apdu, sizeof(apdu));
+    expectedLength = buildDataExchange(expected, apdu, sizeof(apdu));
+
+    /* In place: the whole room is the SPI data write and the frame, the APDU is unchanged */
+    GuardedBuffer<PN532_DATAEXCHANGE_HEADROOM + TEST_SPI_APDU + PN532_FRAME_TAILROOM> frame;
+    uint8_t* send = frame.room() + PN532_DATAEXCHANGE_HEADROOM;
+    memcpy(send, apdu, sizeof(apdu));
+    CHECK(nfc.startDataExchangeInPlace(send, sizeof(apdu)));
+    CHECK(PN532SpiMock::writtenLength == expectedLength);
+    CHECK(memcmp(PN532SpiMock::written, expected, expectedLength) == 0);
+    CHECK(frame.room()[0] == PN532_SPI_DATAWRITE);
+    CHECK(memcmp(frame.room() + 1, expected, expectedLength) == 0);
+    CHECK(frame.intact());
+
+    uint8_t response[8];
+    uint16_t responseLength = sizeof(response);
+    CHECK(nfc.readDataExchangeResponse(response, &responseLength));
+    CHECK((responseLength == 2U) && (response[0] == 0x90U) && (response[1] == 0x00U));
+
+    /* Copied: the caller's buffer is only read */
+    GuardedBuffer<TEST_SPI_APDU> copied;
+    memcpy(copied.room(), apdu, sizeof(apdu));
+    CHECK(nfc.startDataExchange(copied.room(), sizeof(apdu)));
+    CHECK(PN532SpiMock::writtenLength == expectedLength);
+    CHECK(memcmp(PN532SpiMock::written, expected, expectedLength) == 0);
+    CHECK(memcmp(copied.room(), apdu, sizeof(apdu)) == 0);
+    CHECK(copied.intact());
+    responseLength = sizeof(response);
+    CHECK(nfc.readDataExchangeResponse(response, &responseLength));
+}
+
+/* writeframe() writes cmd[-7..-1] and cmd[cmdlen..cmdlen+1], nothing else */
+static void testWriteFrameRoom() {
+    static const uint8_t cmd[] = { PN532_COMMAND_GETFIRMWAREVERSION, 0x11U, 0x22U };
+    uint8_t expected[TEST_FRAME_MAX];
+    uint16_t expectedLength = buildFrame(expected, cmd, sizeof(cmd));
+
+    PN532SpiMock::install(TEST_CS_PIN);
+    Adafruit_PN532 nfc(TEST_CS_PIN, &SPI);
+    CHECK(nfc.begin());
+
+    GuardedBuffer<PN532_FRAME_HEADROOM + sizeof(cmd) + PN532_FRAME_TAILROOM> frame;
+    uint8_t* room = frame.room();
+    memcpy(room + PN532_FRAME_HEADROOM, cmd, sizeof(cmd));
+    nfc.writeframe(room + PN532_FRAME_HEADROOM, sizeof(cmd));
+
+    CHECK(room[0] == PN532_SPI_DATAWRITE);
+    CHECK(memcmp(room + 1, expected, expectedLength) == 0);
+    CHECK((1U + expectedLength) == (PN532_FRAME_HEADROOM + sizeof(cmd) + PN532_FRAME_TAILROOM));
+    CHECK(frame.intact());
+}
+
+/* I2C: the same frames without the SPI data write byte */
+static void testI2cFrames() {
+    static const uint8_t inListed[] = { 0x01U, 0x01U };
+    static const uint8_t answer[] = { 0x00U, 0x90U, 0x00U };
+    uint8_t apdu[TEST_I2C_APDU];
+    uint8_t expected[TEST_FRAME_MAX];
+    uint16_t expectedLength;
+
+    Adafruit_PN532 nfc(PN532_IRQ_NONE, TEST_RESET_PIN, &Wire);
+
+    scriptI2cCommand(PN532_COMMAND_INLISTPASSIVETARGET, inListed, sizeof(inListed));
+    CHECK(nfc.inListPassiveTarget());
+
+    fillApdu(apdu, sizeof(apdu));
+    expectedLength = buildDataExchange(expected, apdu, sizeof(apdu));
+    GuardedBuffer<PN532_DATAEXCHANGE_HEADROOM + TEST_I2C_APDU + PN532_FRAME_TAILROOM> frame;
+    uint8_t* send = frame.room() + PN532_DATAEXCHANGE_HEADROOM;
+    memcpy(send, apdu, sizeof(apdu));
+
+    scriptI2cCommand(PN532_COMMAND_INDATAEXCHANGE, answer, sizeof(answer));
+    CHECK(nfc.startDataExchangeInPlace(send, sizeof(apdu)));
+    CHECK(host_wireLogLength == expectedLength);
+    CHECK(memcmp(host_wireLog, expected, expectedLength) == 0);
+    CHECK(memcmp(frame.room() + 1, expected, expectedLength) == 0);
+    CHECK(frame.intact());
+
+    uint8_t response[8];
+    uint16_t responseLength = sizeof(response);
+    CHECK(nfc.readDataExchangeResponse(response, &responseLength));
+    CHECK((responseLength == 2U) && (response[0] == 0x90U) && (response[1] == 0x00U));
+
+    host_onWireRequest = NULL;
+}
+
+/* I2C readdata() and readframe() write buff[-1] (RDY) and at most n bytes from buff */
+static void testI2cReadRoom() {
+    static const uint8_t data[] = { 0x00U, 0x90U, 0x00U };
+    uint8_t response[1U + TEST_FRAME_MAX];
+    uint16_t responseLength;
+
+    Adafruit_PN532 nfc(PN532_IRQ_NONE, TEST_RESET_PIN, &Wire);
+    host_onWireRequest = NULL;
+    response[0] = PN532_I2C_READY;
+    responseLength = (uint16_t)(1U + buildResponse(&response[1], PN532_COMMAND_INDATAEXCHANGE, data, sizeof(data)));
+    memcpy(host_wireScript, response, responseLength);
+    host_wireScriptLength = responseLength;
+
+    /* readframe(): the frame is shorter than buff, which is read up to n bytes */
+    GuardedBuffer<1U + 20U> frame;
+    uint8_t* buff = frame.room() + 1;
+    CHECK(nfc.readframe(buff, 20U));
+    CHECK(buff[-1] == PN532_I2C_READY);
+    CHECK(memcmp(buff, &response[1], responseLength - 1U) == 0);
+    CHECK(frame.intact());
+
+    /* readframe(): a frame longer than n is rejected without writing past buff[n - 1] */
+    GuardedBuffer<1U + 8U> shortFrame;
+    buff = shortFrame.room() + 1;
+    CHECK(nfc.readframe(buff, 8U) == false);
+    CHECK(shortFrame.intact());
+
+    /* readdata() */
+    GuardedBuffer<1U + 6U> ack;
+    buff = ack.room() + 1;
+    nfc.readdata(buff, 6U);
+    CHECK(buff[-1] == PN532_I2C_READY);
+    CHECK(memcmp(buff, &response[1], 6U) == 0);
+    CHECK(ack.intact());
+}
+
+/* abortCommand(): the ACK frame while a command is pending, nothing otherwise */
+static void testAbortFrames() {
+    static const uint8_t ack[] = { 0x00U, 0x00U, 0xFFU, 0x00U, 0xFFU, 0x00U };
+
+    PN532SpiMock::install(TEST_CS_PIN);
+    Adafruit_PN532 spiNfc(TEST_CS_PIN, &SPI);
+    CHECK(spiNfc.begin());
+
+    CHECK(spiNfc.startSAMConfig());
+    CHECK(spiNfc.abortCommand());
+    CHECK(PN532SpiMock::writtenLength == sizeof(ack));
+    CHECK(memcmp(PN532SpiMock::written, ack, sizeof(ack)) == 0);
+    CHECK(spiNfc.isCommandDone() == false);
+
+    unsigned long transactions = PN532SpiMock::transactions;
+    CHECK(spiNfc.abortCommand() == false);
+    CHECK(PN532SpiMock::transactions == transactions);
+
+    /* The next command goes through */
+    CHECK(spiNfc.startSAMConfig());
+    CHECK(spiNfc.finishSAMConfig());
+
+    Adafruit_PN532 i2cNfc(PN532_IRQ_NONE, TEST_RESET_PIN, &Wire);
+    scriptI2cCommand(PN532_COMMAND_SAMCONFIGURATION, NULL, 0U);
+    CHECK(i2cNfc.startSAMConfig());
+    host_wireLogLength = 0U;
+    CHECK(i2cNfc.abortCommand());
+    CHECK(host_wireLogLength == sizeof(ack));
+    CHECK(memcmp(host_wireLog, ack, sizeof(ack)) == 0);
+    CHECK(i2cNfc.abortCommand() == false);
+    CHECK(host_wireLogLength == sizeof(ack));
+
+    host_onWireRequest = NULL;
+}
+
+int main() {
+    testSpiFrames();
+    testWriteFrameRoom();
+    testI2cFrames();
+    testI2cReadRoom();
+    testAbortFrames();
+
+    return host_testResult("test_frame");
+}
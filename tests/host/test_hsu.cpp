@@ -0,0 +1,253 @@
+/**
+ * @file test_hsu.cpp
+ * @brief Adafruit_PN532 over HSU, against a model of the PN532 UART.
+ *
+ * The model answers SAMConfiguration, Diagnose line tests, SetSerialBaudRate
+ * and TgGetData, switches its rate once the host acknowledges
+ * SetSerialBaudRate, and goes back to 115200 baud on a reset. Bytes only get
+ * through while both sides use the same rate, and not at all above the
+ * fastest rate the line carries.
+ *
+ * setSerialSpeed() must keep the fastest rate that works, falling back
+ * through begin() after each failed rate, and must not try rates above its
+ * cap. A frame shorter than the buffer it is read into must be read without
+ * waiting for bytes that never come.
+ */
+#include <Arduino.h>
+#include <string.h>
+#include "Adafruit_PN532.h"
+#include "host_test.h"
+
+#define TEST_RESET_PIN    (4U)    /**< RSTPD_N */
+#define TEST_MODEL_BUFFER (256U)  /**< Bytes buffered each way */
+#define TEST_MAX_SWITCHES (9U)    /**< SetSerialBaudRate codes logged */
+
+static const uint32_t test_baudrates[] = {
+    9600UL,   19200UL,  38400UL,  57600UL,  115200UL,
+    230400UL, 460800UL, 921600UL, 1288000UL
+}; /**< Rate of each SetSerialBaudRate code */
+
+/**
+ * @brief PN532 HSU as seen from the host UART.
+ */
+class PN532HsuModel : public HardwareSerial {
+public:
+    void begin(unsigned long baud, int = 0) override {
+        hostBaud = baud;
+    }
+    size_t write(uint8_t c) override {
+        if ((hostBaud == pn532Baud) && (hostBaud <= lineMaxBaud)) {
+            receive(c);
+        }
+        return 1U;
+    }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        for (size_t i = 0U; i < size; i++) {
+            (void)write(buffer[i]);
+        }
+        return size;
+    }
+    using Print::write;
+    int available() override { return (int)(outLength - outRead); }
+    int read() override {
+        if (outRead < outLength) {
+            return out[outRead++];
+        }
+        emptyReads++;
+        return -1;
+    }
+    int peek() override { return (outRead < outLength) ? out[outRead] : -1; }
+
+    /** @brief Hardware reset: back to the default rate, buffers dropped. */
+    void reset() {
+        pn532Baud = 115200UL;
+        pendingBaud = 0UL;
+        inLength = 0U;
+        outLength = 0U;
+        outRead = 0U;
+        resets++;
+    }
+
+    unsigned long hostBaud = 115200UL;      /**< Rate of the host UART */
+    unsigned long pn532Baud = 115200UL;     /**< Rate of the PN532 */
+    unsigned long lineMaxBaud = 1288000UL;  /**< Fastest rate the line carries */
+    uint8_t switchCodes[TEST_MAX_SWITCHES]; /**< SetSerialBaudRate codes received */
+    uint8_t switches = 0U;                  /**< Entries in switchCodes */
+    unsigned long resets = 0UL;             /**< Hardware resets */
+    unsigned long emptyReads = 0UL;         /**< read() calls with nothing to read */
+
+private:
+    /* PN532 side: frames from the host, byte by byte */
+    void receive(uint8_t c) {
+        if (inLength >= TEST_MODEL_BUFFER) {
+            inLength = 0U;
+        }
+        in[inLength++] = c;
+
+        /* Start code 00 FF, then LEN and LCS */
+        for (uint16_t k = 0U; (k + 3U) < inLength; k++) {
+            if ((in[k] != 0x00U) || (in[k + 1U] != 0xFFU)) {
+                continue;
+            }
+            uint8_t len = in[k + 2U];
+            if ((len == 0x00U) && (in[k + 3U] == 0xFFU)) {
+                /* ACK frame: a pending rate change takes effect */
+                if (pendingBaud != 0UL) {
+                    pn532Baud = pendingBaud;
+                    pendingBaud = 0UL;
+                }
+                inLength = 0U;
+            } else if ((uint16_t)(k + 4U + len + 1U) <= inLength) {
+                command(&in[k + 4U], len);
+                inLength = 0U;
+            }
+            break;
+        }
+    }
+
+    void command(const uint8_t* data, uint8_t len) {
+        uint8_t payload[64];
+        uint8_t n = 0U;
+
+        if ((len < 2U) || (data[0] != PN532_HOSTTOPN532)) {
+            return;
+        }
+        payload[n++] = PN532_PN532TOHOST;
+        payload[n++] = (uint8_t)(data[1] + 1U);
+        switch (data[1]) {
+            case PN532_COMMAND_DIAGNOSE:
+                /* Test number and data, echoed */
+                memcpy(&payload[n], &data[2], len - 2U);
+                n = (uint8_t)(n + len - 2U);
+                break;
+            case PN532_COMMAND_SETSERIALBAUDRATE:
+                if (switches < TEST_MAX_SWITCHES) {
+                    switchCodes[switches++] = data[2];
+                }
+                pendingBaud = test_baudrates[data[2]];
+                break;
+            case PN532_COMMAND_TGGETDATA:
+                payload[n++] = 0x00U; /* status */
+                payload[n++] = 'h';
+                payload[n++] = 'i';
+                break;
+            default:
+                break;
+        }
+
+        static const uint8_t ack[] = { 0x00U, 0x00U, 0xFFU, 0x00U, 0xFFU, 0x00U };
+        send(ack, sizeof(ack));
+        uint8_t header[] = { 0x00U, 0x00U, 0xFFU, n, (uint8_t)(0U - n) };
+        send(header, sizeof(header));
+        send(payload, n);
+        uint8_t dcs = 0U;
+        for (uint8_t i = 0U; i < n; i++) {
+            dcs = (uint8_t)(dcs + payload[i]);
+        }
+        uint8_t trailer[] = { (uint8_t)(0U - dcs), 0x00U };
+        send(trailer, sizeof(trailer));
+    }
+
+    void send(const uint8_t* data, uint8_t length) {
+        for (uint8_t i = 0U; (i < length) && (outLength < TEST_MODEL_BUFFER); i++) {
+            out[outLength++] = data[i];
+        }
+    }
+
+    unsigned long pendingBaud = 0UL; /**< Rate taken on the next ACK frame */
+    uint8_t in[TEST_MODEL_BUFFER];   /**< Bytes received by the PN532 */
+    uint16_t inLength = 0U;
+    uint8_t out[TEST_MODEL_BUFFER];  /**< Bytes sent by the PN532 */
+    uint16_t outLength = 0U;
+    uint16_t outRead = 0U;
+};
+
+static PN532HsuModel test_uart;
+
+static void onPin(uint8_t pin, uint8_t value) {
+    if ((pin == TEST_RESET_PIN) && (value == LOW)) {
+        test_uart.reset();
+    }
+}
+
+static void resetModel(unsigned long lineMaxBaud) {
+    test_uart.reset();
+    test_uart.lineMaxBaud = lineMaxBaud;
+    test_uart.switches = 0U;
+    test_uart.resets = 0UL;
+}
+
+/* Every rate works: the fastest one is kept at once, with no reset */
+static void testFastest(Adafruit_PN532& nfc) {
+    resetModel(1288000UL);
+    CHECK(nfc.begin());
+    test_uart.resets = 0UL;
+
+    CHECK(nfc.setSerialSpeed() == 1288000UL);
+    CHECK((test_uart.switches == 1U) && (test_uart.switchCodes[0] == 8U));
+    CHECK(test_uart.resets == 0UL);
+    CHECK((test_uart.hostBaud == 1288000UL) && (test_uart.pn532Baud == 1288000UL));
+}
+
+/* The line carries 460800 at most: 1288000 and 921600 fail, each undone by begin() */
+static void testFallback(Adafruit_PN532& nfc) {
+    resetModel(460800UL);
+    CHECK(nfc.begin());
+    test_uart.resets = 0UL;
+
+    CHECK(nfc.setSerialSpeed() == 460800UL);
+    CHECK(test_uart.switches == 3U);
+    CHECK((test_uart.switchCodes[0] == 8U) && (test_uart.switchCodes[1] == 7U) &&
+          (test_uart.switchCodes[2] == 6U));
+    CHECK(test_uart.resets == 2UL);
+    CHECK((test_uart.hostBaud == 460800UL) && (test_uart.pn532Baud == 460800UL));
+
+    /* The link works at the rate kept */
+    CHECK(nfc.SAMConfig());
+}
+
+/* maxBaud caps the rates tried; at the default rate no switch is needed */
+static void testCap(Adafruit_PN532& nfc) {
+    resetModel(1288000UL);
+    CHECK(nfc.begin());
+
+    CHECK(nfc.setSerialSpeed(460800UL) == 460800UL);
+    CHECK((test_uart.switches == 1U) && (test_uart.switchCodes[0] == 6U));
+    CHECK(test_uart.hostBaud == 460800UL);
+
+    resetModel(1288000UL);
+    CHECK(nfc.begin());
+    CHECK(nfc.setSerialSpeed(200000UL) == 115200UL);
+    CHECK(test_uart.switches == 0U);
+    CHECK((test_uart.hostBaud == 115200UL) && (test_uart.pn532Baud == 115200UL));
+}
+
+/* A 12-byte TgGetData frame read into a 64-byte buffer: no read past its end */
+static void testShortFrame(Adafruit_PN532& nfc) {
+    uint8_t data[8];
+    uint8_t length = 0U;
+
+    resetModel(1288000UL);
+    CHECK(nfc.begin());
+    test_uart.emptyReads = 0UL;
+
+    unsigned long start = millis();
+    CHECK(nfc.getDataTarget(data, &length) != 0U);
+    CHECK(millis() - start < PN532_HSU_READ_MARGIN);
+    CHECK(test_uart.emptyReads == 0UL);
+    CHECK(test_uart.available() == 0);
+    CHECK((length == 2U) && (data[0] == 'h') && (data[1] == 'i'));
+}
+
+int main() {
+    Adafruit_PN532 nfc(TEST_RESET_PIN, &test_uart);
+
+    host_onDigitalWrite = onPin;
+
+    testFastest(nfc);
+    testFallback(nfc);
+    testCap(nfc);
+    testShortFrame(nfc);
+
+    return host_testResult("test_hsu");
+}
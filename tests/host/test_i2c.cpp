@@ -0,0 +1,216 @@
+/**
+ * @file test_i2c.cpp
+ * @brief Adafruit_PN532 I2C frame reads and clock negotiation, against a
+ *        model of the PN532 on the host Wire bus.
+ *
+ * The model acknowledges each command written, answers Diagnose line tests
+ * with their echo and any other command with a scripted payload, and
+ * serves every read from the frame start with the RDY byte first, as the
+ * PN532 does. Above the fastest clock the line carries, it corrupts the
+ * echo.
+ *
+ * A response frame that fits in PN532_I2C_FIRST_READ bytes must take one
+ * read. A longer one must be read again in full, in a second read, when
+ * the Wire buffer holds it. It must be rejected after the first read when
+ * the Wire buffer does not hold it. setI2CSpeed() must keep the fastest
+ * clock, up to its cap, at which the line tests pass.
+ */
+#include <Arduino.h>
+#include <Wire.h>
+#include <string.h>
+#include "host_test.h"
+
+#define private public
+#include "Adafruit_PN532.h"
+#undef private
+
+#define TEST_RESET_PIN   (3U)    /**< PN532 reset */
+#define TEST_MAX_PAYLOAD (64U)   /**< Longest scripted payload */
+
+/** @brief PN532 model state. */
+static struct {
+    size_t logSeen;                    /**< host_wireLog bytes already handled */
+    size_t readAtRequest;              /**< host_wireBytesRead at the last request */
+    bool ackPending;                   /**< The ACK is served until it is read */
+    uint8_t frame[HOST_WIRE_BUFFER_SIZE]; /**< RDY and the response frame */
+    uint16_t frameLength;              /**< Bytes in frame */
+    uint8_t payload[TEST_MAX_PAYLOAD]; /**< Data answered after D5 (cmd + 1) */
+    uint8_t payloadLength;             /**< Bytes in payload */
+    uint32_t lineMaxClock;             /**< Fastest clock the line carries */
+    unsigned long responseRequests;    /**< Reads served from the response */
+} test_pn532;
+
+/** @brief Build RDY and the response frame D5 @p code @p data into test_pn532.frame. */
+static void buildResponse(uint8_t code, const uint8_t* data, uint8_t length) {
+    uint8_t* f = test_pn532.frame;
+    uint8_t len = (uint8_t)(length + 2U);
+    uint8_t sum = (uint8_t)(PN532_PN532TOHOST + code);
+
+    f[0] = PN532_I2C_READY;
+    f[1] = 0x00U;
+    f[2] = 0x00U;
+    f[3] = 0xFFU;
+    f[4] = len;
+    f[5] = (uint8_t)(0U - len);
+    f[6] = PN532_PN532TOHOST;
+    f[7] = code;
+    for (uint8_t i = 0U; i < length; i++) {
+        f[8U + i] = data[i];
+        sum = (uint8_t)(sum + data[i]);
+    }
+    f[8U + length] = (uint8_t)(0U - sum);
+    f[9U + length] = 0x00U;
+    test_pn532.frameLength = (uint16_t)(10U + length);
+}
+
+/* The frame just written: 00 00 FF LEN LCS D4 cmd data DCS 00 */
+static void command(const uint8_t* frame, size_t length) {
+    if ((length < 7U) || (frame[5] != PN532_HOSTTOPN532)) {
+        return;
+    }
+    const uint8_t code = frame[6];
+    const uint8_t dataLength = (uint8_t)(frame[3] - 2U);
+
+    if (code == PN532_COMMAND_DIAGNOSE) {
+        uint8_t echo[TEST_MAX_PAYLOAD];
+        memcpy(echo, &frame[7], dataLength);
+        if (host_wireClock > test_pn532.lineMaxClock) {
+            echo[dataLength - 1U] ^= 0x01U;
+        }
+        buildResponse((uint8_t)(code + 1U), echo, dataLength);
+    } else {
+        buildResponse((uint8_t)(code + 1U), test_pn532.payload, test_pn532.payloadLength);
+    }
+    test_pn532.ackPending = true;
+}
+
+static void onRequest() {
+    static const uint8_t ack[] = { PN532_I2C_READY, 0x00U, 0x00U, 0xFFU, 0x00U, 0xFFU, 0x00U };
+    size_t readInLast = host_wireBytesRead - test_pn532.readAtRequest;
+
+    if (host_wireLogLength > test_pn532.logSeen) {
+        command(&host_wireLog[test_pn532.logSeen], host_wireLogLength - test_pn532.logSeen);
+        test_pn532.logSeen = host_wireLogLength;
+    } else if (test_pn532.ackPending && (readInLast >= sizeof(ack))) {
+        test_pn532.ackPending = false;
+    } else {
+        /* Same frame as the last read */
+    }
+
+    if (test_pn532.ackPending) {
+        memcpy(host_wireScript, ack, sizeof(ack));
+        host_wireScriptLength = sizeof(ack);
+    } else {
+        memcpy(host_wireScript, test_pn532.frame, test_pn532.frameLength);
+        host_wireScriptLength = test_pn532.frameLength;
+        test_pn532.responseRequests++;
+    }
+    test_pn532.readAtRequest = host_wireBytesRead;
+}
+
+static void resetModel(uint32_t lineMaxClock) {
+    memset(&test_pn532, 0, sizeof(test_pn532));
+    test_pn532.logSeen = host_wireLogLength;
+    test_pn532.readAtRequest = host_wireBytesRead;
+    test_pn532.lineMaxClock = lineMaxClock;
+}
+
+/** @brief Exchange an APDU whose answer has @p payloadLength bytes after the status. */
+static bool exchange(Adafruit_PN532& nfc, uint8_t payloadLength, uint16_t& responseLength,
+                     uint8_t* response) {
+    uint8_t apdu[] = { 0x00U, 0xB0U, 0x00U, 0x00U };
+
+    test_pn532.payload[0] = 0x00U; /* status */
+    for (uint8_t i = 1U; i <= payloadLength; i++) {
+        test_pn532.payload[i] = (uint8_t)(i * 3U);
+    }
+    test_pn532.payloadLength = (uint8_t)(payloadLength + 1U);
+
+    bool ret = nfc.startDataExchange(apdu, sizeof(apdu));
+    test_pn532.responseRequests = 0UL;
+    return ret && nfc.readDataExchangeResponse(response, &responseLength);
+}
+
+static bool payloadIntact(const uint8_t* response, uint16_t length) {
+    bool ret = true;
+    for (uint16_t i = 0U; i < length; i++) {
+        if (response[i] != (uint8_t)((i + 1U) * 3U)) {
+            ret = false;
+        }
+    }
+    return ret;
+}
+
+/* Frames of up to PN532_I2C_FIRST_READ bytes: one read each */
+static void testShortFrame(Adafruit_PN532& nfc) {
+    /* 9 frame bytes around the status and the data */
+    const uint8_t dataLength = (uint8_t)(PN532_I2C_FIRST_READ - 10U);
+    uint8_t response[TEST_MAX_PAYLOAD];
+    uint16_t responseLength = sizeof(response);
+
+    resetModel(PN532_I2C_FASTPLUS_HZ);
+    CHECK(exchange(nfc, dataLength, responseLength, response));
+    CHECK(test_pn532.frameLength == (1U + PN532_I2C_FIRST_READ));
+    CHECK(responseLength == dataLength);
+    CHECK(payloadIntact(response, responseLength));
+    /* One RDY poll, then the frame in one read */
+    CHECK(test_pn532.responseRequests == 2UL);
+}
+
+/* A 40-byte frame: read again in full when the Wire buffer holds it, rejected when not */
+static void testLongFrame(Adafruit_PN532& nfc) {
+    const uint8_t dataLength = 30U;
+    uint8_t response[TEST_MAX_PAYLOAD];
+    uint16_t responseLength = sizeof(response);
+    size_t wireBuffer = nfc.i2c_dev->_maxBufferSize;
+
+    nfc.i2c_dev->_maxBufferSize = 64U;
+    resetModel(PN532_I2C_FASTPLUS_HZ);
+    CHECK(exchange(nfc, dataLength, responseLength, response));
+    CHECK(test_pn532.frameLength == 41U);
+    CHECK(responseLength == dataLength);
+    CHECK(payloadIntact(response, responseLength));
+    /* RDY poll, first read, full read */
+    CHECK(test_pn532.responseRequests == 3UL);
+
+    nfc.i2c_dev->_maxBufferSize = wireBuffer;
+    resetModel(PN532_I2C_FASTPLUS_HZ);
+    responseLength = sizeof(response);
+    CHECK(exchange(nfc, dataLength, responseLength, response) == false);
+    CHECK(test_pn532.responseRequests == 2UL);
+}
+
+/* setI2CSpeed(): the fastest clock the line carries, within the cap */
+static void testSpeed(Adafruit_PN532& nfc) {
+    resetModel(PN532_I2C_FASTPLUS_HZ);
+    CHECK(nfc.setI2CSpeed() == PN532_I2C_FASTPLUS_HZ);
+    CHECK(host_wireClock == PN532_I2C_FASTPLUS_HZ);
+
+    resetModel(PN532_I2C_FAST_HZ);
+    CHECK(nfc.setI2CSpeed() == PN532_I2C_FAST_HZ);
+    CHECK(host_wireClock == PN532_I2C_FAST_HZ);
+
+    resetModel(PN532_I2C_FASTPLUS_HZ);
+    CHECK(nfc.setI2CSpeed(PN532_I2C_FAST_HZ + 1UL) == PN532_I2C_FAST_HZ);
+
+    /* Nothing works: 0, and the last clock tried is the slowest */
+    resetModel(PN532_I2C_STANDARD_HZ - 1UL);
+    CHECK(nfc.setI2CSpeed() == 0UL);
+    CHECK(host_wireClock == PN532_I2C_STANDARD_HZ);
+}
+
+int main() {
+    Adafruit_PN532 nfc(PN532_IRQ_NONE, TEST_RESET_PIN, &Wire);
+
+    resetModel(PN532_I2C_FASTPLUS_HZ);
+    host_onWireRequest = onRequest;
+    CHECK(nfc.begin());
+
+    testShortFrame(nfc);
+    testLongFrame(nfc);
+    testSpeed(nfc);
+
+    host_onWireRequest = NULL;
+
+    return host_testResult("test_i2c");
+}
@@ -0,0 +1,154 @@
+/**
+ * @file test_irq.cpp
+ * @brief Adafruit_PN532 on I2C with the IRQ pin not wired, declared or not.
+ *
+ * PN532_IRQ_NONE polls the RDY byte from the start and attaches no interrupt.
+ * A declared IRQ pin that never goes low is demoted to RDY polling once the
+ * RDY byte reports ready while the pin is still high; a pin seen low is
+ * trusted and no RDY byte is polled.
+ *
+ * A falling edge whose interrupt lands after the flag check, at the pin read
+ * or during the read of the frame it announces, must not leave the flag set
+ * for the next frame.
+ */
+#include <Arduino.h>
+#include <Wire.h>
+#include <string.h>
+#include "Adafruit_PN532.h"
+#include "host_test.h"
+
+#define TEST_IRQ_PIN    (2U) /**< PN532 IRQ, as declared to the driver */
+#define TEST_RESET_PIN  (3U) /**< PN532 reset */
+
+/** LOW reads left on the IRQ pin before it reads HIGH; negative reads LOW forever */
+static int32_t test_irqLowReads = 0;
+
+/** IRQ pin reads on which the interrupt of the falling edge runs, just before the read */
+static int32_t test_irqEdgeReads = 0;
+
+static void fireIrq() {
+    if (host_irqHandler != NULL) {
+        host_irqHandler();
+    }
+}
+
+static int readIrqPin(uint8_t pin) {
+    int ret = HIGH;
+    if (pin == TEST_IRQ_PIN) {
+        if (test_irqEdgeReads > 0) {
+            test_irqEdgeReads--;
+            fireIrq();
+            ret = LOW;
+        } else if (test_irqLowReads < 0) {
+            ret = LOW;
+        } else if (test_irqLowReads > 0) {
+            test_irqLowReads--;
+            ret = LOW;
+        }
+    }
+    return ret;
+}
+
+/* Every read returns RDY and an ACK frame */
+static void scriptAck() {
+    static const uint8_t ack[] = { PN532_I2C_READY, 0x00U, 0x00U, 0xFFU, 0x00U, 0xFFU, 0x00U };
+    memcpy(host_wireScript, ack, sizeof(ack));
+    host_wireScriptLength = sizeof(ack);
+}
+
+/* A declared pin left unconnected reads high forever: RDY polling takes over */
+static void testUnwiredPin() {
+    uint8_t apdu[] = { 0x00U, 0xA4U, 0x04U, 0x00U };
+    Adafruit_PN532 nfc(TEST_IRQ_PIN, TEST_RESET_PIN, &Wire);
+
+    test_irqLowReads = 0;
+    scriptAck();
+    (void)nfc.begin();
+
+    uint32_t start = millis();
+    CHECK(nfc.startDataExchange(apdu, sizeof(apdu)));
+    CHECK((millis() - start) <= 20UL);
+
+    uint32_t polls = nfc.statusPolls();
+    (void)nfc.isResponseReady();
+    (void)nfc.isResponseReady();
+    CHECK(nfc.statusPolls() == (polls + 2U));
+}
+
+/* PN532_IRQ_NONE attaches nothing and polls RDY */
+static void testIrqNone() {
+    uint8_t apdu[] = { 0x00U, 0xA4U, 0x04U, 0x00U };
+    Adafruit_PN532 nfc(PN532_IRQ_NONE, TEST_RESET_PIN, &Wire);
+
+    host_irqHandler = NULL;
+    scriptAck();
+    (void)nfc.begin();
+    CHECK(host_irqHandler == NULL);
+    CHECK(nfc.startDataExchange(apdu, sizeof(apdu)));
+}
+
+/* A pin seen low is wired: no RDY byte is polled while it stays high */
+static void testWiredPin() {
+    uint8_t apdu[] = { 0x00U, 0xA4U, 0x04U, 0x00U };
+    Adafruit_PN532 nfc(TEST_IRQ_PIN, TEST_RESET_PIN, &Wire);
+
+    /* On a real PN532 the pin is low whenever RDY is set */
+    test_irqLowReads = -1;
+    scriptAck();
+    (void)nfc.begin();
+
+    test_irqLowReads = 1;
+    CHECK(nfc.startDataExchange(apdu, sizeof(apdu)));
+
+    uint32_t polls = nfc.statusPolls();
+    delay(5U);
+    (void)nfc.isResponseReady();
+    delay(5U);
+    (void)nfc.isResponseReady();
+    CHECK(nfc.statusPolls() == polls);
+}
+
+/* The edge of the ACK sets the flag between the flag check and the pin read:
+   once the ACK is read, the response is not ready */
+static void testEdgeAtPinRead() {
+    uint8_t apdu[] = { 0x00U, 0xA4U, 0x04U, 0x00U };
+    Adafruit_PN532 nfc(TEST_IRQ_PIN, TEST_RESET_PIN, &Wire);
+
+    test_irqLowReads = -1;
+    scriptAck();
+    (void)nfc.begin();
+
+    test_irqLowReads = 0;
+    test_irqEdgeReads = 1;
+    CHECK(nfc.startDataExchange(apdu, sizeof(apdu)));
+    CHECK(test_irqEdgeReads == 0);
+    CHECK(nfc.isResponseReady() == false);
+}
+
+/* The interrupt of the ACK edge runs late, while the ACK is read */
+static void testEdgeDuringRead() {
+    uint8_t apdu[] = { 0x00U, 0xA4U, 0x04U, 0x00U };
+    Adafruit_PN532 nfc(TEST_IRQ_PIN, TEST_RESET_PIN, &Wire);
+
+    test_irqLowReads = -1;
+    scriptAck();
+    (void)nfc.begin();
+
+    test_irqLowReads = 1;
+    host_onWireRequest = fireIrq;
+    CHECK(nfc.startDataExchange(apdu, sizeof(apdu)));
+    host_onWireRequest = NULL;
+    CHECK(nfc.isResponseReady() == false);
+}
+
+int main() {
+    host_onDigitalRead = readIrqPin;
+
+    testUnwiredPin();
+    testIrqNone();
+    testWiredPin();
+    testEdgeAtPinRead();
+    testEdgeDuringRead();
+
+    return host_testResult("test_irq");
+}
@@ -0,0 +1,184 @@
+/**
+ * @file test_register.cpp
+ * @brief Adafruit_BusIO_Register shadow copy on the host I2C bus.
+ *
+ * With the shadow copy enabled, read() must be served without a bus
+ * transaction only while the copy is the register content: after a
+ * full-width write or a read. Partial-width writes, raw buffer writes,
+ * address and width changes and setVolatile() must drop it, so the next
+ * read() goes to the device again. busReads() and busWrites() must match the
+ * transactions seen on the bus.
+ */
+#include <Arduino.h>
+#include <Wire.h>
+#include "Adafruit_BusIO_Register.h"
+#include "Adafruit_I2CDevice.h"
+#include "host_test.h"
+
+#define TEST_I2C_ADDRESS  (0x60U)  /**< Device address */
+#define TEST_REG_CONFIG   (0x01U)  /**< 8-bit register split in bit fields */
+#define TEST_REG_WIDE     (0x02U)  /**< 16-bit register, LSB first */
+
+/** @brief Serve @p value, LSB first, to the next reads. */
+static void setDeviceValue(uint32_t value, uint8_t width) {
+    for (uint8_t i = 0U; i < width; i++) {
+        host_wireScript[i] = (uint8_t)(value >> (8U * i));
+    }
+    host_wireScriptLength = width;
+}
+
+static void resetBus(Adafruit_BusIO_Register& reg) {
+    host_wireLogLength = 0U;
+    host_wireRequests = 0UL;
+    reg.resetCounters();
+}
+
+/* Three bit field updates: 3 reads and 3 writes, 1 read and 3 writes with the shadow */
+static void testBitFieldCounters(Adafruit_I2CDevice& dev) {
+    Adafruit_BusIO_Register reg(&dev, TEST_REG_CONFIG);
+    Adafruit_BusIO_RegisterBits mode(&reg, 2U, 0U);
+    Adafruit_BusIO_RegisterBits gain(&reg, 3U, 2U);
+    Adafruit_BusIO_RegisterBits enable(&reg, 1U, 7U);
+
+    /* Without shadow, every update reads the register first */
+    setDeviceValue(0x40U, 1U);
+    resetBus(reg);
+    CHECK(mode.write(1U));
+    CHECK(gain.write(5U));
+    CHECK(enable.write(1U));
+    CHECK(reg.busReads() == 3UL);
+    CHECK(reg.busWrites() == 3UL);
+    CHECK(host_wireRequests == 3UL);
+    /* Each read writes the address, each write the address and one byte */
+    CHECK(host_wireLogLength == ((3U * 1U) + (3U * 2U)));
+
+    /* With shadow, only the first update reads it */
+    reg.enableShadow();
+    setDeviceValue(0x40U, 1U);
+    resetBus(reg);
+    CHECK(mode.write(2U));
+    CHECK(gain.write(3U));
+    CHECK(enable.write(1U));
+    CHECK(reg.busReads() == 1UL);
+    CHECK(reg.busWrites() == 3UL);
+    CHECK(host_wireRequests == 1UL);
+    CHECK(host_wireLogLength == ((1U * 1U) + (3U * 2U)));
+
+    /* The last byte written is 0x40 with the three fields set, and read() returns it from the copy */
+    const uint8_t expected = (uint8_t)(0x40U | 0x80U | (3U << 2U) | 2U);
+    CHECK(host_wireLog[host_wireLogLength - 2U] == TEST_REG_CONFIG);
+    CHECK(host_wireLog[host_wireLogLength - 1U] == expected);
+    CHECK(reg.read() == expected);
+    CHECK(host_wireRequests == 1UL);
+
+    /* invalidateShadow(): the next read goes to the device */
+    reg.invalidateShadow();
+    setDeviceValue(0x11U, 1U);
+    CHECK(reg.read() == 0x11U);
+    CHECK(host_wireRequests == 2UL);
+}
+
+/* Full-width writes set the copy, partial-width writes drop it */
+static void testPartialWidth(Adafruit_I2CDevice& dev) {
+    Adafruit_BusIO_Register reg(&dev, TEST_REG_WIDE, 2U, LSBFIRST);
+
+    reg.enableShadow();
+    resetBus(reg);
+    CHECK(reg.write(0x1234UL));
+    CHECK(reg.read() == 0x1234UL);
+    CHECK(host_wireRequests == 0UL);
+
+    /* Bits above the register width are not part of the copy */
+    CHECK(reg.write(0xABCD5678UL));
+    CHECK(reg.read() == 0x5678UL);
+    CHECK(host_wireRequests == 0UL);
+
+    /* One byte of two: the copy no longer matches the device */
+    CHECK(reg.write(0x99UL, 1U));
+    setDeviceValue(0x5699UL, 2U);
+    CHECK(reg.read() == 0x5699UL);
+    CHECK(host_wireRequests == 1UL);
+
+    /* The read made the copy valid again */
+    CHECK(reg.read() == 0x5699UL);
+    CHECK(host_wireRequests == 1UL);
+    CHECK(reg.busReads() == 1UL);
+    CHECK(reg.busWrites() == 3UL);
+}
+
+/* Raw buffer writes drop the copy */
+static void testRawWrite(Adafruit_I2CDevice& dev) {
+    Adafruit_BusIO_Register reg(&dev, TEST_REG_WIDE, 2U, LSBFIRST);
+    uint8_t raw[2] = { 0x22U, 0x11U };
+
+    reg.enableShadow();
+    resetBus(reg);
+    CHECK(reg.write(0x0001UL));
+    CHECK(reg.write(raw, sizeof(raw)));
+    CHECK(reg.busWrites() == 2UL);
+    CHECK(host_wireLog[host_wireLogLength - 2U] == 0x22U);
+    CHECK(host_wireLog[host_wireLogLength - 1U] == 0x11U);
+
+    setDeviceValue(0x1122UL, 2U);
+    CHECK(reg.read() == 0x1122UL);
+    CHECK(host_wireRequests == 1UL);
+}
+
+/* setAddress() and setWidth() drop the copy */
+static void testAddressAndWidth(Adafruit_I2CDevice& dev) {
+    Adafruit_BusIO_Register reg(&dev, TEST_REG_CONFIG);
+
+    reg.enableShadow();
+    resetBus(reg);
+    CHECK(reg.write(0x55UL));
+    CHECK(reg.read() == 0x55UL);
+    CHECK(host_wireRequests == 0UL);
+
+    reg.setAddress(TEST_REG_WIDE);
+    setDeviceValue(0x66U, 1U);
+    CHECK(reg.read() == 0x66UL);
+    CHECK(host_wireRequests == 1UL);
+    /* The read went to the new address */
+    CHECK(host_wireLog[host_wireLogLength - 1U] == TEST_REG_WIDE);
+
+    reg.setWidth(2U);
+    setDeviceValue(0x7766UL, 2U);
+    CHECK(reg.read() == 0x7766UL);
+    CHECK(host_wireRequests == 2UL);
+}
+
+/* setVolatile(): always read from the device, even right after a write */
+static void testVolatile(Adafruit_I2CDevice& dev) {
+    Adafruit_BusIO_Register reg(&dev, TEST_REG_CONFIG);
+
+    reg.enableShadow();
+    reg.setVolatile();
+    resetBus(reg);
+    CHECK(reg.write(0x01UL));
+    setDeviceValue(0x81U, 1U); /* the device set a flag by itself */
+    CHECK(reg.read() == 0x81UL);
+    CHECK(reg.read() == 0x81UL);
+    CHECK(host_wireRequests == 2UL);
+
+    /* Back to non-volatile: served from the copy once read */
+    reg.setVolatile(false);
+    CHECK(reg.read() == 0x81UL);
+    CHECK(reg.read() == 0x81UL);
+    CHECK(host_wireRequests == 3UL);
+    CHECK(reg.busReads() == 3UL);
+    CHECK(reg.busWrites() == 1UL);
+}
+
+int main() {
+    Adafruit_I2CDevice dev(TEST_I2C_ADDRESS, &Wire);
+
+    CHECK(dev.begin());
+
+    testBitFieldCounters(dev);
+    testPartialWidth(dev);
+    testRawWrite(dev);
+    testAddressAndWidth(dev);
+    testVolatile(dev);
+
+    return host_testResult("test_register");
+}
@@ -0,0 +1,127 @@
+/**
+ * @file test_reselect.cpp
+ * @brief Keeping the card between operations, byte for byte on the SPI mock.
+ *
+ * PN532Adapter::holdTarget() must send InDeselect and reselectTarget() must
+ * send InSelect, each framed as D4 code Tg with the target number of the
+ * inlisted card, and succeed only on a status byte without error.
+ * reselectTarget() must negotiate the bit rate again with InPSL once the
+ * card answers, and send nothing more when it does not.
+ */
+#include <Arduino.h>
+#include <SPI.h>
+#include <string.h>
+#include "ArduinoSerialAdapter.h"
+#include "host_test.h"
+#include "pn532_spi_mock.h"
+
+#define private public
+#include "PN532Adapter.h"
+#undef private
+
+#define TEST_CS_PIN          (10U)   /**< PN532 chip select */
+#define TEST_TG              (0x02U) /**< Target number given to the card */
+#define TEST_MAX_COMMANDS    (8U)    /**< Command codes logged */
+#define TEST_STATUS_OK       (0x00U) /**< Status byte: success */
+#define TEST_STATUS_TIMEOUT  (0x01U) /**< Status byte: the target did not answer */
+
+/** @brief Command codes received by the mock, and the status it answers. */
+static struct {
+    uint8_t codes[TEST_MAX_COMMANDS]; /**< Code of each command */
+    uint8_t count;                    /**< Commands received */
+    uint8_t status;                   /**< Status answered to InSelect, InDeselect and InPSL */
+} test_reader;
+
+static void onCommand(const uint8_t* frame, uint16_t length) {
+    /* Type A card with TA(1) = 0x11: 212 kbps both ways */
+    static const uint8_t target[] = {
+        0x01U, TEST_TG, 0x00U, 0x04U, 0x20U, 0x04U, 0x11U, 0x22U, 0x33U, 0x44U,
+        0x05U, 0x78U, 0x11U, 0x80U, 0x02U
+    };
+    const uint8_t code = frame[6];
+
+    if (test_reader.count < TEST_MAX_COMMANDS) {
+        test_reader.codes[test_reader.count] = code;
+    }
+    test_reader.count++;
+
+    if (code == PN532_COMMAND_INLISTPASSIVETARGET) {
+        PN532SpiMock::setResponse(target, sizeof(target));
+    } else {
+        PN532SpiMock::setResponse(&test_reader.status, 1U);
+    }
+}
+
+/** @brief Expected frame of a command whose only parameter is Tg. */
+static void targetFrame(uint8_t* frame, uint8_t code) {
+    const uint8_t head[] = { 0x00U, 0x00U, 0xFFU, 0x03U, 0xFDU, 0xD4U };
+
+    memcpy(frame, head, sizeof(head));
+    frame[6] = code;
+    frame[7] = TEST_TG;
+    frame[8] = (uint8_t)(0U - (0xD4U + code + TEST_TG));
+    frame[9] = 0x00U;
+}
+
+static void clearLog(uint8_t status) {
+    memset(&test_reader, 0, sizeof(test_reader));
+    test_reader.status = status;
+}
+
+/* InDeselect D4 44 Tg, success on status 00 only */
+static void testHold(PN532Adapter& adapter) {
+    uint8_t expected[10];
+
+    targetFrame(expected, PN532_COMMAND_INDESELECT);
+    clearLog(TEST_STATUS_OK);
+    CHECK(adapter.holdTarget());
+    CHECK((test_reader.count == 1U) && (test_reader.codes[0] == PN532_COMMAND_INDESELECT));
+    CHECK(PN532SpiMock::writtenLength == sizeof(expected));
+    CHECK(memcmp(PN532SpiMock::written, expected, sizeof(expected)) == 0);
+
+    clearLog(TEST_STATUS_TIMEOUT);
+    CHECK(adapter.holdTarget() == false);
+}
+
+/* InSelect D4 54 Tg, then InPSL for the bit rate; a card gone gets no InPSL */
+static void testReselect(PN532Adapter& adapter) {
+    uint8_t expected[10];
+
+    targetFrame(expected, PN532_COMMAND_INSELECT);
+    clearLog(TEST_STATUS_OK);
+    CHECK(adapter.reselectTarget());
+    CHECK(test_reader.count == 2U);
+    CHECK((test_reader.codes[0] == PN532_COMMAND_INSELECT) && (test_reader.codes[1] == PN532_COMMAND_INPSL));
+    CHECK(adapter.bitRate() == PN532BitRate::KBPS_212);
+
+    clearLog(TEST_STATUS_OK);
+    adapter.setMaxBitRate(PN532BitRate::KBPS_106);
+    CHECK(adapter.reselectTarget());
+    CHECK((test_reader.count == 1U) && (test_reader.codes[0] == PN532_COMMAND_INSELECT));
+    CHECK(PN532SpiMock::writtenLength == sizeof(expected));
+    CHECK(memcmp(PN532SpiMock::written, expected, sizeof(expected)) == 0);
+
+    clearLog(TEST_STATUS_TIMEOUT);
+    adapter.setMaxBitRate(PN532BitRate::KBPS_848);
+    CHECK(adapter.reselectTarget() == false);
+    CHECK((test_reader.count == 1U) && (test_reader.codes[0] == PN532_COMMAND_INSELECT));
+}
+
+int main() {
+    ArduinoSerialAdapter serial;
+    PN532Adapter adapter(serial, TEST_CS_PIN, &SPI);
+
+    PN532SpiMock::install(TEST_CS_PIN);
+    PN532SpiMock::onCommand = onCommand;
+    CHECK(adapter.nfc->begin());
+
+    clearLog(TEST_STATUS_OK);
+    adapter.setMaxBitRate(PN532BitRate::KBPS_848);
+    CHECK(adapter.inListPassiveTarget());
+    CHECK(adapter.bitRate() == PN532BitRate::KBPS_212);
+
+    testHold(adapter);
+    testReselect(adapter);
+
+    return host_testResult("test_reselect");
+}
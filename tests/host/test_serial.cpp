@@ -0,0 +1,172 @@
+/**
+ * @file test_serial.cpp
+ * @brief ArduinoSerialAdapter transmit ring against a UART with limited room.
+ *
+ * Output goes out in order whatever room the UART reports, nothing blocks
+ * while room was reported, a full ring forces its oldest bytes out, a core
+ * that never reports room gets direct writes, and flush() empties the ring.
+ */
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+#include "ArduinoSerialAdapter.h"
+#include "host_test.h"
+
+#define TEST_OUT_SIZE (2048U) /**< Bytes kept by TestUart */
+
+/**
+ * @brief UART reporting @ref room free bytes, keeping what is written.
+ */
+class TestUart : public HardwareSerial {
+public:
+    size_t write(uint8_t c) override {
+        if (length < (TEST_OUT_SIZE - 1U)) {
+            out[length++] = (char)c;
+            out[length] = '\0';
+        }
+        if (room > 0) {
+            room--;
+        }
+        return 1U;
+    }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        writeCalls++;
+        for (size_t i = 0U; i < size; i++) {
+            (void)write(buffer[i]);
+        }
+        return size;
+    }
+    using Print::write;
+    int availableForWrite() override { return room; }
+
+    void clear() {
+        length = 0U;
+        out[0] = '\0';
+    }
+
+    char out[TEST_OUT_SIZE] = { '\0' }; /**< Bytes written, NUL terminated */
+    size_t length = 0U;                 /**< Bytes in out */
+    int room = 0;                       /**< Free bytes reported */
+    unsigned long writeCalls = 0UL;     /**< Block writes */
+};
+
+/**
+ * @brief printHexDump() output as the Arduino core prints it.
+ */
+static void expectedHexDump(char* expected, const uint8_t* data, uint16_t length) {
+    size_t n = 0U;
+
+    expected[0] = '\0';
+    for (uint16_t i = 0U; i < length; i++) {
+        n += (size_t)sprintf(&expected[n], "0x%02X ", data[i]);
+        if ((((i + 1U) % 16U) == 0U) && ((i + 1U) != length)) {
+            n += (size_t)sprintf(&expected[n], "\r\n");
+        }
+    }
+    (void)sprintf(&expected[n], "\r\n");
+}
+
+/* With room to spare, a hex dump comes out whole, a line per UART write at most */
+static void testHexDump(const uint8_t* data) {
+    static const uint16_t lengths[] = { 0U, 1U, 15U, 16U, 17U, 32U, 65U, 100U };
+    char expected[TEST_OUT_SIZE];
+
+    for (uint8_t i = 0U; i < (sizeof(lengths) / sizeof(lengths[0])); i++) {
+        TestUart uart;
+        uart.room = 100000;
+        ArduinoSerialAdapter adapter(&uart);
+
+        adapter.printHexDump(data, lengths[i]);
+        expectedHexDump(expected, data, lengths[i]);
+        CHECK(strcmp(uart.out, expected) == 0);
+        CHECK(adapter.pending() == 0U);
+        /* A line wrapping around the ring takes two writes */
+        CHECK(uart.writeCalls <= (2UL * ((lengths[i] / 16U) + 1U)));
+    }
+}
+
+/* With little room, nothing blocks and poll() sends the rest in order */
+static void testLimitedRoom(const uint8_t* data) {
+    char expected[TEST_OUT_SIZE];
+    TestUart uart;
+    uart.room = 10;
+    ArduinoSerialAdapter adapter(&uart);
+
+    adapter.print(F("Hello "));
+    adapter.print((uint16_t)0xBEEFU, HEX);
+    adapter.println();
+    adapter.printHexDump(data, 20U);
+    CHECK(uart.length == 10U);
+    CHECK(adapter.pending() > 0U);
+
+    while (adapter.pending() > 0U) {
+        uart.room = 7;
+        adapter.poll();
+    }
+    (void)strcpy(expected, "Hello BEEF\r\n");
+    expectedHexDump(&expected[strlen(expected)], data, 20U);
+    CHECK(strcmp(uart.out, expected) == 0);
+}
+
+/* A full ring forces its oldest bytes out, in order */
+static void testOverflow() {
+    char text[301];
+    TestUart uart;
+    uart.room = 1;
+    ArduinoSerialAdapter adapter(&uart);
+
+    adapter.print('a'); /* The UART reported room once */
+    uart.clear();
+    uart.room = 0;
+    for (uint16_t i = 0U; i < 300U; i++) {
+        text[i] = (char)('a' + ((i + 1U) % 26U));
+    }
+    text[300] = '\0';
+
+    adapter.print(text);
+    CHECK(adapter.pending() == ARDUINOSERIALADAPTER_TX_BUFFER_SIZE);
+    adapter.flush();
+    CHECK(adapter.pending() == 0U);
+    CHECK(strcmp(uart.out, text) == 0);
+}
+
+/* A core that never reports room gets its output straight away */
+static void testNoRoomReported() {
+    TestUart uart;
+    uart.room = 0;
+    ArduinoSerialAdapter adapter(&uart);
+
+    adapter.print(F("hi"));
+    CHECK(strcmp(uart.out, "hi") == 0);
+    CHECK(adapter.pending() == 0U);
+}
+
+/* Once room was reported, a full UART buffers instead of blocking */
+static void testRoomReportedThenFull() {
+    TestUart uart;
+    uart.room = 2;
+    ArduinoSerialAdapter adapter(&uart);
+
+    adapter.print(F("abcd"));
+    CHECK(strcmp(uart.out, "ab") == 0);
+    CHECK(adapter.pending() == 2U);
+    adapter.print(F("ef"));
+    CHECK(adapter.pending() == 4U);
+    adapter.flush();
+    CHECK(strcmp(uart.out, "abcdef") == 0);
+}
+
+int main() {
+    uint8_t data[100];
+    for (uint8_t i = 0U; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 37U);
+    }
+
+    testHexDump(data);
+    testLimitedRoom(data);
+    testOverflow();
+    testNoRoomReported();
+    testRoomReportedThenFull();
+
+    return host_testResult("test_serial");
+}
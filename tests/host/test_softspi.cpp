@@ -0,0 +1,194 @@
+/**
+ * @file test_softspi.cpp
+ * @brief Adafruit_SPIDevice software SPI, checked pin by pin.
+ *
+ * A model SPI slave follows the digitalWrite() calls of the device and
+ * answers its digitalRead() calls: it samples MOSI and shifts MISO on the
+ * clock edges of the SPI mode (CPOL, CPHA) and bit order under test. For
+ * modes 0 to 3 and both bit orders, every loop selected by begin()
+ * (softTransfer<> and softBit<>) must exchange the expected bytes with that
+ * slave, with 16 clock edges and 8 MISO reads per byte in the pin trace.
+ * calibrateSoftTransfer() must leave no pause per clock phase from 500 kHz
+ * up, and a pause at slow clocks.
+ */
+#include <Arduino.h>
+#include <SPI.h>
+#include <string.h>
+#define private public
+#include "Adafruit_SPIDevice.h"
+#undef private
+#include "host_test.h"
+
+#define TEST_CS_PIN    (10U)  /**< Chip select */
+#define TEST_MOSI_PIN  (11U)  /**< Master out */
+#define TEST_MISO_PIN  (12U)  /**< Master in */
+#define TEST_SCK_PIN   (13U)  /**< Clock */
+#define TEST_BYTES     (4U)   /**< Bytes per exchange */
+
+/** @brief Model SPI slave on the host pins. */
+static struct {
+    bool cpol;                      /**< Clock idle level */
+    bool cpha;                      /**< false: sample on the leading edge, true: on the trailing edge */
+    bool lsbFirst;                  /**< Bit order */
+    bool selected;                  /**< CS is low */
+    uint8_t sck;                    /**< Clock level */
+    uint8_t mosi;                   /**< MOSI level */
+    uint8_t miso;                   /**< MISO level driven by the slave */
+    uint8_t tx[TEST_BYTES];         /**< Bytes the slave sends */
+    uint8_t rx[TEST_BYTES];         /**< Bytes the slave received */
+    uint16_t txBits;                /**< Bits driven on MISO */
+    uint16_t rxBits;                /**< Bits sampled from MOSI */
+} slave;
+
+/** @brief Mask of bit @p index of a byte, in the slave's bit order. */
+static uint8_t bitMask(uint16_t index) {
+    uint8_t shift = (uint8_t)(index % 8U);
+    return slave.lsbFirst ? (uint8_t)(1U << shift) : (uint8_t)(0x80U >> shift);
+}
+
+static void slaveDrive() {
+    if (slave.txBits < (TEST_BYTES * 8U)) {
+        slave.miso = ((slave.tx[slave.txBits / 8U] & bitMask(slave.txBits)) != 0U) ? HIGH : LOW;
+    }
+    slave.txBits++;
+}
+
+static void slaveSample() {
+    if ((slave.rxBits < (TEST_BYTES * 8U)) && (slave.mosi != LOW)) {
+        slave.rx[slave.rxBits / 8U] |= bitMask(slave.rxBits);
+    }
+    slave.rxBits++;
+}
+
+static void slaveOnWrite(uint8_t pin, uint8_t value) {
+    uint8_t level = (value != LOW) ? HIGH : LOW;
+
+    if (pin == TEST_CS_PIN) {
+        slave.selected = (level == LOW);
+        if (slave.selected && (slave.cpha == false)) {
+            slaveDrive(); /* first bit valid before the first edge */
+        }
+    } else if (pin == TEST_MOSI_PIN) {
+        slave.mosi = level;
+    } else if ((pin == TEST_SCK_PIN) && (level != slave.sck)) {
+        bool leading = (level != (slave.cpol ? HIGH : LOW));
+
+        slave.sck = level;
+        if (slave.selected) {
+            if (leading == slave.cpha) {
+                slaveDrive();
+            } else {
+                slaveSample();
+            }
+        }
+    } else {
+        /* other pins, or no clock change */
+    }
+}
+
+static int slaveOnRead(uint8_t pin) {
+    return (pin == TEST_MISO_PIN) ? slave.miso : HIGH;
+}
+
+/** @brief Count clock level changes and MISO reads in the trace since @p from. */
+static void countTrace(size_t from, uint8_t idle, uint16_t& edges, uint16_t& reads, uint8_t& lastSck) {
+    uint8_t level = idle;
+
+    edges = 0U;
+    reads = 0U;
+    for (size_t i = from; i < host_pinTraceLength; i++) {
+        const HostPinEvent& event = host_pinTrace[i];
+        if ((event.read == false) && (event.pin == TEST_SCK_PIN) && (event.value != level)) {
+            level = event.value;
+            edges++;
+        }
+        if (event.read && (event.pin == TEST_MISO_PIN)) {
+            reads++;
+        }
+    }
+    lastSck = level;
+}
+
+/* One exchange in @p mode and @p order: both sides receive what the other sent */
+static void testMode(uint8_t mode, BusIOBitOrder order) {
+    const uint8_t sent[TEST_BYTES] = { 0xA5U, 0x01U, 0x80U, 0x3CU };
+    const uint8_t answer[TEST_BYTES] = { 0x5AU, 0xFEU, 0x12U, 0xC3U };
+    uint8_t buffer[TEST_BYTES];
+    Adafruit_SPIDevice dev(TEST_CS_PIN, TEST_SCK_PIN, TEST_MISO_PIN, TEST_MOSI_PIN,
+                           1000000UL, order, mode);
+
+    memset(&slave, 0, sizeof(slave));
+    slave.cpol = (mode == SPI_MODE2) || (mode == SPI_MODE3);
+    slave.cpha = (mode == SPI_MODE1) || (mode == SPI_MODE3);
+    slave.lsbFirst = (order == SPI_BITORDER_LSBFIRST);
+    slave.sck = slave.cpol ? HIGH : LOW;
+    memcpy(slave.tx, answer, sizeof(answer));
+
+    CHECK(dev.begin());
+    CHECK(dev._bitDelayUs == 0U);
+    /* begin() left the clock idle; its calibration ran with CS high */
+    CHECK(slave.sck == (slave.cpol ? HIGH : LOW));
+    CHECK((slave.rxBits == 0U) && (slave.txBits == 0U));
+
+    memcpy(buffer, sent, sizeof(sent));
+    size_t from = host_pinTraceLength;
+    dev.beginTransactionWithAssertingCS();
+    dev.transfer(buffer, sizeof(buffer));
+    dev.endTransactionWithDeassertingCS();
+
+    CHECK(memcmp(slave.rx, sent, sizeof(sent)) == 0);
+    CHECK(memcmp(buffer, answer, sizeof(answer)) == 0);
+
+    uint16_t edges = 0U;
+    uint16_t reads = 0U;
+    uint8_t lastSck = LOW;
+    countTrace(from, slave.cpol ? HIGH : LOW, edges, reads, lastSck);
+    CHECK(reads == (TEST_BYTES * 8U));
+    if (mode == SPI_MODE2) {
+        /* Mode 2 shares the mode 0 loop: the first clock write is no change,
+           and the clock rests low between bytes, one edge short of idle */
+        CHECK(edges == ((TEST_BYTES * 16U) - 1U));
+        CHECK(lastSck == LOW);
+    } else {
+        CHECK(edges == (TEST_BYTES * 16U));
+        CHECK(lastSck == (slave.cpol ? HIGH : LOW));
+    }
+
+    if ((memcmp(slave.rx, sent, sizeof(sent)) != 0) || (memcmp(buffer, answer, sizeof(answer)) != 0)) {
+        printf("  mode %u, %s first\n", mode, slave.lsbFirst ? "LSB" : "MSB");
+    }
+}
+
+/* calibrateSoftTransfer(): no pause from 500 kHz up, a pause for slow clocks */
+static void testCalibration() {
+    const uint32_t fast[] = { 500000UL, 1000000UL, 4000000UL };
+
+    for (uint8_t i = 0U; i < (sizeof(fast) / sizeof(fast[0])); i++) {
+        Adafruit_SPIDevice dev(TEST_CS_PIN, TEST_SCK_PIN, TEST_MISO_PIN, TEST_MOSI_PIN,
+                               fast[i], SPI_BITORDER_MSBFIRST, SPI_MODE0);
+        CHECK(dev.begin());
+        CHECK(dev._bitDelayUs == 0U);
+    }
+
+    /* 10 us per bit: the host loop costs far less, so most of it is pause */
+    Adafruit_SPIDevice slow(TEST_CS_PIN, TEST_SCK_PIN, TEST_MISO_PIN, TEST_MOSI_PIN,
+                            100000UL, SPI_BITORDER_MSBFIRST, SPI_MODE0);
+    CHECK(slow.begin());
+    CHECK((slow._bitDelayUs > 0U) && (slow._bitDelayUs <= 5U));
+}
+
+int main() {
+    const uint8_t modes[] = { SPI_MODE0, SPI_MODE1, SPI_MODE2, SPI_MODE3 };
+
+    host_onDigitalWrite = slaveOnWrite;
+    host_onDigitalRead = slaveOnRead;
+
+    for (uint8_t i = 0U; i < sizeof(modes); i++) {
+        testMode(modes[i], SPI_BITORDER_MSBFIRST);
+        testMode(modes[i], SPI_BITORDER_LSBFIRST);
+        host_pinTraceLength = 0U;
+    }
+    testCalibration();
+
+    return host_testResult("test_softspi");
+}
@@ -0,0 +1,114 @@
+/**
+ * @file test_spidevice.cpp
+ * @brief Adafruit_SPIDevice hardware SPI reads and writes on the host SPI bus.
+ *
+ * Every read must return the bytes clocked in from MISO, and every write must
+ * send its bytes in order and leave the caller's buffer unchanged. Built twice:
+ * test_spidevice with the buffer-level transfer() of most cores, and
+ * test_spidevice_stm32 with STM32 defined, for the byte-by-byte transfer of
+ * STM32 cores before 2.0.
+ */
+#include <Arduino.h>
+#include <SPI.h>
+#include <string.h>
+#include "Adafruit_SPIDevice.h"
+#include "host_test.h"
+
+#define TEST_CS_PIN  (10U)  /**< Device chip select */
+#define TEST_LONG    (70U)  /**< Write longer than two BUSIO_SPI_CHUNK_SIZE chunks */
+
+#ifdef STM32
+#define TEST_NAME    "test_spidevice_stm32"
+#else
+#define TEST_NAME    "test_spidevice"
+#endif
+
+/** Bytes clocked since the last reset; the device answers 0x80 + that count */
+static uint8_t test_clocked = 0U;
+
+static uint8_t answerCount(uint8_t mosi) {
+    (void)mosi;
+    return (uint8_t)(0x80U + test_clocked++);
+}
+
+static void resetBus() {
+    test_clocked = 0U;
+    host_spiLogLength = 0U;
+    host_spiByteCalls = 0UL;
+    host_spiBufferCalls = 0UL;
+}
+
+/* write_then_read(): the read buffer gets the bytes clocked after the write */
+static void testWriteThenRead(Adafruit_SPIDevice& dev) {
+    const uint8_t cmd[] = { 0x03U, 0x42U };
+    uint8_t read[8];
+
+    resetBus();
+    memset(read, 0x00U, sizeof(read));
+    CHECK(dev.write_then_read(cmd, sizeof(cmd), read, sizeof(read), 0xFFU));
+    for (uint8_t i = 0U; i < sizeof(read); i++) {
+        CHECK(read[i] == (uint8_t)(0x80U + sizeof(cmd) + i));
+    }
+    CHECK(host_spiLogLength == (sizeof(cmd) + sizeof(read)));
+    CHECK(memcmp(host_spiLog, cmd, sizeof(cmd)) == 0);
+    for (uint8_t i = 0U; i < sizeof(read); i++) {
+        CHECK(host_spiLog[sizeof(cmd) + i] == 0xFFU); /* sendvalue */
+    }
+#ifdef STM32
+    CHECK(host_spiBufferCalls == 0UL);
+#else
+    CHECK(host_spiByteCalls == 0UL);
+#endif
+}
+
+/* read() and transfer(): received bytes replace the sent ones */
+static void testReadAndTransfer(Adafruit_SPIDevice& dev) {
+    uint8_t buffer[5] = { 0x10U, 0x11U, 0x12U, 0x13U, 0x14U };
+
+    resetBus();
+    CHECK(dev.read(buffer, sizeof(buffer), 0x00U));
+    for (uint8_t i = 0U; i < sizeof(buffer); i++) {
+        CHECK(buffer[i] == (uint8_t)(0x80U + i));
+    }
+
+    resetBus();
+    dev.beginTransactionWithAssertingCS();
+    CHECK(dev.transfer(0x5AU) == 0x80U);
+    uint8_t data[3] = { 0x01U, 0x02U, 0x03U };
+    dev.transfer(data, sizeof(data));
+    dev.endTransactionWithDeassertingCS();
+    CHECK((data[0] == 0x81U) && (data[1] == 0x82U) && (data[2] == 0x83U));
+    CHECK((host_spiLog[0] == 0x5AU) && (host_spiLog[1] == 0x01U) && (host_spiLog[3] == 0x03U));
+}
+
+/* write(): prefix then data, in order, across several chunks, buffer unchanged */
+static void testWrite(Adafruit_SPIDevice& dev) {
+    const uint8_t prefix[] = { 0x01U };
+    uint8_t data[TEST_LONG];
+    uint8_t copy[TEST_LONG];
+
+    for (uint8_t i = 0U; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 3U);
+    }
+    memcpy(copy, data, sizeof(data));
+
+    resetBus();
+    CHECK(dev.write(data, sizeof(data), prefix, sizeof(prefix)));
+    CHECK(host_spiLogLength == (sizeof(prefix) + sizeof(data)));
+    CHECK(host_spiLog[0] == prefix[0]);
+    CHECK(memcmp(&host_spiLog[1], data, sizeof(data)) == 0);
+    CHECK(memcmp(data, copy, sizeof(data)) == 0);
+}
+
+int main() {
+    Adafruit_SPIDevice dev(TEST_CS_PIN, 1000000UL, SPI_BITORDER_MSBFIRST, SPI_MODE0, &SPI);
+
+    host_spiOnByte = answerCount;
+    CHECK(dev.begin());
+
+    testWriteThenRead(dev);
+    testReadAndTransfer(dev);
+    testWrite(dev);
+
+    return host_testResult(TEST_NAME);
+}
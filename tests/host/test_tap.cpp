@@ -0,0 +1,225 @@
+/**
+ * @file test_tap.cpp
+ * @brief Poll-driven tap (CryptnoxWallet::beginTap() / poll()) against the card simulator.
+ *
+ * Covers a full tap to PIN verified, the bounded work of each poll() slice,
+ * the per-command CW_TAP_RESPONSE_TIMEOUT_MS timeout, a failing status word
+ * (wrong PIN) and a secure response with a bad MAC. A command left
+ * unanswered must be aborted before the reader is reset, so the next tap
+ * works.
+ */
+#include <Arduino.h>
+#include "ArduinoSerialAdapter.h"
+#include "CryptnoxCardSimulator.h"
+#include "CryptnoxWallet.h"
+#include "host_test.h"
+
+#define TEST_POLL_GAP_US     (100U)    /**< Other work of loop() between two poll() calls */
+#define TEST_MAX_POLLS       (100000U) /**< Give up on a tap after this many poll() calls */
+#define TEST_INS_VERIFY_PIN  (0x20U)   /**< INS of VERIFY PIN */
+#define TEST_INS_OPEN_SECURE_CHANNEL (0x10U) /**< INS of OPEN SECURE CHANNEL */
+
+static ArduinoSerialAdapter test_serial;
+
+/**
+ * @brief Simulator whose VERIFY PIN response carries a corrupted MAC.
+ */
+class BadMacCard : public CryptnoxCardSimulator {
+public:
+    explicit BadMacCard(SerialDriver& serialDriver) : CryptnoxCardSimulator(serialDriver) {}
+
+    bool startAPDU(const uint8_t* apdu, uint16_t apduLength) override {
+        pendingIns = (apduLength > 1U) ? apdu[1] : 0U;
+        return CryptnoxCardSimulator::startAPDU(apdu, apduLength);
+    }
+
+    bool finishAPDU(uint8_t* response, uint16_t &responseLength) override {
+        bool ret = CryptnoxCardSimulator::finishAPDU(response, responseLength);
+        if (ret && (pendingIns == TEST_INS_VERIFY_PIN) && (responseLength > 2U)) {
+            response[0] ^= 0x01U; /* First byte of the response MAC */
+        }
+        return ret;
+    }
+
+private:
+    uint8_t pendingIns = 0U;
+};
+
+/**
+ * @brief Simulator that never answers OPEN SECURE CHANNEL while silent, behind
+ *        a reader that stays busy with an unanswered command until it is aborted.
+ *
+ * Like the PN532, the reader loses a reset sent while it is busy, and the
+ * detection that follows fails.
+ */
+class SilentCard : public CryptnoxCardSimulator {
+public:
+    explicit SilentCard(SerialDriver& serialDriver) : CryptnoxCardSimulator(serialDriver) {}
+
+    bool startAPDU(const uint8_t* apdu, uint16_t apduLength) override {
+        busy = silent && (apduLength > 1U) && (apdu[1] == TEST_INS_OPEN_SECURE_CHANNEL);
+        return CryptnoxCardSimulator::startAPDU(apdu, apduLength);
+    }
+
+    bool isResponseReady() override {
+        return (busy == false) && CryptnoxCardSimulator::isResponseReady();
+    }
+
+    void abortAPDU() override {
+        busy = false;
+        CryptnoxCardSimulator::abortAPDU();
+    }
+
+    bool startResetReader() override {
+        resetLost = busy;
+        return (busy == false) && CryptnoxCardSimulator::startResetReader();
+    }
+
+    bool finishResetReader() override {
+        bool ret = (resetLost == false);
+        resetLost = false;
+        return ret;
+    }
+
+    bool silent = true; /**< OPEN SECURE CHANNEL gets no answer */
+
+private:
+    bool busy = false;      /**< The reader still runs a command nobody collected */
+    bool resetLost = false; /**< The last reset reached a busy reader */
+};
+
+/**
+ * @brief Drive one tap until poll() stops returning BUSY.
+ *
+ * @param wallet Wallet to drive.
+ * @param[out] longestPollUs Longest time spent in one poll() call.
+ * @return Result of the tap.
+ */
+static CW_TapStatus runTap(CryptnoxWallet& wallet, uint32_t& longestPollUs) {
+    CW_TapContext tap;
+    uint32_t polls = 0U;
+
+    longestPollUs = 0U;
+    wallet.beginTap(tap);
+    CHECK(tap.result() == CW_TapStatus::BUSY);
+
+    CW_TapStatus status = CW_TapStatus::BUSY;
+    while ((status == CW_TapStatus::BUSY) && (polls < TEST_MAX_POLLS)) {
+        uint32_t start = micros();
+        status = wallet.poll(tap);
+        uint32_t spent = micros() - start;
+        if (spent > longestPollUs) {
+            longestPollUs = spent;
+        }
+        delayMicroseconds(TEST_POLL_GAP_US);
+        polls++;
+    }
+    CHECK(status == tap.result());
+
+    return status;
+}
+
+/**
+ * @brief Set the same latency on every command.
+ */
+static void setAllLatencies(CryptnoxCardSimulator& card, uint16_t latencyMs) {
+    for (uint8_t c = 0U; c < (uint8_t)CW_SimCommand::COUNT; c++) {
+        card.setLatency((CW_SimCommand)c, latencyMs);
+    }
+}
+
+/* A tap with card latency on every command ends with the PIN verified, and
+   no poll() call waits for the card */
+static void testTapVerifiesPin() {
+    CryptnoxCardSimulator card(test_serial);
+    CryptnoxWallet wallet(card, test_serial);
+    uint32_t longestPollUs = 0U;
+
+    setAllLatencies(card, 50U);
+    CHECK(wallet.begin());
+    while (wallet.refillKeyPool()) {
+    }
+
+    CHECK(runTap(wallet, longestPollUs) == CW_TapStatus::DONE);
+    CHECK(card.isPinVerified());
+    CHECK(card.apduCount() == 5U);
+    CHECK(longestPollUs < 50000UL);
+
+    /* A second tap on the same wallet works as well */
+    CHECK(runTap(wallet, longestPollUs) == CW_TapStatus::DONE);
+    CHECK(card.isPinVerified());
+}
+
+/* A card that does not answer in CW_TAP_RESPONSE_TIMEOUT_MS fails the tap */
+static void testTapTimeout() {
+    CryptnoxCardSimulator card(test_serial);
+    CryptnoxWallet wallet(card, test_serial);
+    uint32_t longestPollUs = 0U;
+
+    card.setLatency(CW_SimCommand::VERIFY_PIN, CW_TAP_RESPONSE_TIMEOUT_MS + 500U);
+    CHECK(wallet.begin());
+
+    uint32_t start = millis();
+    CHECK(runTap(wallet, longestPollUs) == CW_TapStatus::FAILED);
+    uint32_t elapsed = millis() - start;
+
+    CHECK(card.apduCount() == 5U); /* VERIFY PIN was sent, its answer never collected */
+    CHECK(elapsed >= CW_TAP_RESPONSE_TIMEOUT_MS);
+    CHECK(elapsed < (CW_TAP_RESPONSE_TIMEOUT_MS + 500U));
+}
+
+/* A card that never answers OPEN SECURE CHANNEL times out; its command is
+   aborted before the reader reset, and the next tap succeeds */
+static void testTapSilentCard() {
+    SilentCard card(test_serial);
+    CryptnoxWallet wallet(card, test_serial);
+    uint32_t longestPollUs = 0U;
+
+    CHECK(wallet.begin());
+
+    CHECK(runTap(wallet, longestPollUs) == CW_TapStatus::FAILED);
+    CHECK(card.apduCount() == 3U); /* SELECT, GET CARD CERTIFICATE, OPEN SECURE CHANNEL */
+    CHECK(card.abortCount() == 1U);
+
+    card.silent = false;
+    CHECK(runTap(wallet, longestPollUs) == CW_TapStatus::DONE);
+    CHECK(card.isPinVerified());
+    CHECK(card.abortCount() == 1U);
+}
+
+/* A failing status word (63 C0, wrong PIN) fails the tap */
+static void testTapWrongPin() {
+    const uint8_t otherPin[] = { '9', '9', '9', '9' };
+    CryptnoxCardSimulator card(test_serial);
+    CryptnoxWallet wallet(card, test_serial);
+    uint32_t longestPollUs = 0U;
+
+    CHECK(card.setPin(otherPin, sizeof(otherPin)));
+    CHECK(wallet.begin());
+
+    CHECK(runTap(wallet, longestPollUs) == CW_TapStatus::FAILED);
+    CHECK(card.isPinVerified() == false);
+    CHECK(card.apduCount() == 5U);
+}
+
+/* A secure response whose MAC does not verify fails the tap */
+static void testTapBadMac() {
+    BadMacCard card(test_serial);
+    CryptnoxWallet wallet(card, test_serial);
+    uint32_t longestPollUs = 0U;
+
+    CHECK(wallet.begin());
+
+    CHECK(runTap(wallet, longestPollUs) == CW_TapStatus::FAILED);
+    CHECK(card.isPinVerified()); /* The card accepted the PIN, the host rejects its answer */
+}
+
+int main() {
+    testTapVerifiesPin();
+    testTapTimeout();
+    testTapSilentCard();
+    testTapWrongPin();
+    testTapBadMac();
+
+    return host_testResult("test_tap");
+}